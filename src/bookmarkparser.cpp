@@ -0,0 +1,194 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "bookmarkparser.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSet>
+#include <QVariantMap>
+
+static QVariantMap bookmark(const QString &url, const QString &title, const QString &favicon)
+{
+    QVariantMap bookmark;
+    bookmark.insert("url", url);
+    bookmark.insert("title", title);
+    bookmark.insert("favicon", favicon);
+    return bookmark;
+}
+
+/**
+ * @brief BookmarkParser::parse
+ * Reads and parses the file, format is detected from the content.
+ */
+QVariantList BookmarkParser::parse(const QString &path, bool *ok)
+{
+    if (ok) {
+        *ok = false;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Unable to open bookmarks " + path;
+        return QVariantList();
+    }
+
+    QByteArray data = file.readAll();
+    QByteArray start = data.left(512).trimmed();
+    if (start.startsWith('[') || start.startsWith('{')) {
+        return parseJson(data, ok);
+    }
+    return parseHtml(data, ok);
+}
+
+QVariantList BookmarkParser::parseJson(const QByteArray &data, bool *ok)
+{
+    QVariantList bookmarks;
+    QJsonDocument doc = QJsonDocument::fromJson(data);
+    if (!doc.isArray()) {
+        qWarning() << "Bookmarks.json should be an array of items";
+        if (ok) {
+            *ok = false;
+        }
+        return bookmarks;
+    }
+
+    QJsonArray array = doc.array();
+    bookmarks.reserve(array.count());
+    QJsonArray::const_iterator i;
+    for (i = array.constBegin(); i != array.constEnd(); ++i) {
+        if ((*i).isObject()) {
+            QJsonObject item = (*i).toObject();
+            QString url = item.value("url").toString();
+            if (!url.isEmpty()) {
+                bookmarks.append(bookmark(url, item.value("title").toString(),
+                                          item.value("favicon").toString()));
+            }
+        }
+    }
+
+    if (ok) {
+        *ok = true;
+    }
+    return bookmarks;
+}
+
+/**
+ * @brief BookmarkParser::parseHtml
+ * Scans anchors of a Netscape bookmark file. Folders are flattened and duplicate
+ * urls are dropped, the first occurrence wins.
+ */
+QVariantList BookmarkParser::parseHtml(const QByteArray &data, bool *ok)
+{
+    QVariantList bookmarks;
+    QString html = QString::fromUtf8(data);
+    if (!html.contains(QLatin1String("NETSCAPE-Bookmark-file"), Qt::CaseInsensitive)
+            && !html.contains(QLatin1String("<a "), Qt::CaseInsensitive)) {
+        qWarning() << "Bookmarks html does not contain any links";
+        if (ok) {
+            *ok = false;
+        }
+        return bookmarks;
+    }
+
+    QSet<QString> urls;
+    int pos = 0;
+    while ((pos = html.indexOf(QLatin1String("<a "), pos, Qt::CaseInsensitive)) >= 0) {
+        int tagEnd = html.indexOf(QLatin1Char('>'), pos);
+        if (tagEnd < 0) {
+            break;
+        }
+        int close = html.indexOf(QLatin1String("</a>"), tagEnd, Qt::CaseInsensitive);
+        if (close < 0) {
+            break;
+        }
+
+        QString tag = html.mid(pos, tagEnd - pos);
+        QString url = unescape(attribute(tag, QLatin1String("href")));
+        if (!url.isEmpty() && !url.startsWith(QLatin1String("javascript:"), Qt::CaseInsensitive)
+                && !urls.contains(url)) {
+            urls.insert(url);
+            QString title = unescape(html.mid(tagEnd + 1, close - tagEnd - 1).trimmed());
+            bookmarks.append(bookmark(url, title.isEmpty() ? url : title,
+                                      attribute(tag, QLatin1String("icon_uri"))));
+        }
+        pos = close + 4;
+    }
+
+    if (ok) {
+        *ok = true;
+    }
+    return bookmarks;
+}
+
+// Value of a double quoted attribute of the tag.
+QString BookmarkParser::attribute(const QString &tag, const QString &name)
+{
+    QString key = name + QLatin1String("=\"");
+    int start = tag.indexOf(key, 0, Qt::CaseInsensitive);
+    // Attribute name must not be a suffix of another attribute.
+    while (start > 0 && !tag.at(start - 1).isSpace()) {
+        start = tag.indexOf(key, start + 1, Qt::CaseInsensitive);
+    }
+    if (start < 0) {
+        return QString();
+    }
+    start += key.length();
+    int end = tag.indexOf(QLatin1Char('"'), start);
+    return end < 0 ? QString() : tag.mid(start, end - start);
+}
+
+QString BookmarkParser::unescape(const QString &text)
+{
+    if (!text.contains(QLatin1Char('&'))) {
+        return text;
+    }
+
+    QString result;
+    result.reserve(text.length());
+    int i = 0;
+    while (i < text.length()) {
+        int end = text.at(i) == QLatin1Char('&') ? text.indexOf(QLatin1Char(';'), i) : -1;
+        if (end < 0 || end - i > 8) {
+            result.append(text.at(i++));
+            continue;
+        }
+
+        QString entity = text.mid(i + 1, end - i - 1);
+        if (entity == QLatin1String("amp")) {
+            result.append(QLatin1Char('&'));
+        } else if (entity == QLatin1String("lt")) {
+            result.append(QLatin1Char('<'));
+        } else if (entity == QLatin1String("gt")) {
+            result.append(QLatin1Char('>'));
+        } else if (entity == QLatin1String("quot")) {
+            result.append(QLatin1Char('"'));
+        } else if (entity == QLatin1String("apos")) {
+            result.append(QLatin1Char('\''));
+        } else if (entity.startsWith(QLatin1Char('#'))) {
+            bool ok = false;
+            uint code = entity.startsWith(QLatin1String("#x"), Qt::CaseInsensitive)
+                    ? entity.mid(2).toUInt(&ok, 16) : entity.mid(1).toUInt(&ok);
+            if (!ok) {
+                result.append(text.mid(i, end - i + 1));
+            } else {
+                result.append(QString::fromUcs4(&code, 1));
+            }
+        } else {
+            result.append(text.mid(i, end - i + 1));
+        }
+        i = end + 1;
+    }
+    return result;
+}
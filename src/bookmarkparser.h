@@ -0,0 +1,36 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BOOKMARKPARSER_H
+#define BOOKMARKPARSER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVariantList>
+
+/**
+ * Parses bookmark files to lists of maps with url, title, and favicon keys.
+ * Supports the bookmarks.json array format and the Netscape bookmark HTML
+ * format exported by desktop browsers. Not thread bound, used from the DBWorker.
+ */
+class BookmarkParser
+{
+public:
+    static QVariantList parse(const QString &path, bool *ok = 0);
+    static QVariantList parseJson(const QByteArray &data, bool *ok = 0);
+    static QVariantList parseHtml(const QByteArray &data, bool *ok = 0);
+
+private:
+    static QString attribute(const QString &tag, const QString &name);
+    static QString unescape(const QString &text);
+};
+
+#endif // BOOKMARKPARSER_H
@@ -11,6 +11,7 @@
 
 #include "browserservice.h"
 #include "dbusadaptor.h"
+#include "browsertrace.h"
 #include <QDBusConnection>
 
 #define SAILFISH_BROWSER_SERVICE QLatin1String("org.sailfishos.browser")
@@ -39,6 +40,7 @@ QString BrowserService::serviceName() const
 
 void BrowserService::openUrl(QStringList args)
 {
+    TRACE_INSTANT("openUrl");
     if(args.count() > 0) {
         emit openUrlRequested(args.first());
     } else {
@@ -55,3 +57,8 @@ void BrowserService::restartTransfer(int transferId)
 {
     emit restartTransferRequested(transferId);
 }
+
+void BrowserService::importBookmarks(QString path)
+{
+    emit importBookmarksRequested(path);
+}
@@ -27,11 +27,16 @@ public slots:
     void openUrl(QStringList args);
     void cancelTransfer(int transferId);
     void restartTransfer(int transferId);
+    void importBookmarks(QString path);
 
 signals:
     void openUrlRequested(QString url);
     void cancelTransferRequested(int transferId);
     void restartTransferRequested(int transferId);
+    void importBookmarksRequested(QString path);
+    // Relayed to D-Bus by the adaptor.
+    void bookmarkImportProgress(int imported, int total);
+    void bookmarkImportFinished(int imported);
 
 private:
     bool m_registered;
@@ -0,0 +1,206 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "browsertrace.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QMutexLocker>
+#include <QThread>
+#include <QTimer>
+
+Q_GLOBAL_STATIC(BrowserTrace, gBrowserTrace)
+
+static QBasicAtomicInt gEnabled = Q_BASIC_ATOMIC_INITIALIZER(0);
+// The trace is written once the first page has had time to load.
+static const int gSaveDelay = 10000;
+
+BrowserTrace::BrowserTrace(int capacity, QObject *parent)
+    : QObject(parent)
+    , m_events(qMax(1, capacity))
+    , m_next(0)
+    , m_wrapped(false)
+    , m_embeddingStart(-1)
+{
+    m_clock.start();
+}
+
+BrowserTrace *BrowserTrace::instance()
+{
+    return gBrowserTrace();
+}
+
+bool BrowserTrace::enabled()
+{
+    return gEnabled.load();
+}
+
+void BrowserTrace::setEnabled(bool enabled)
+{
+    gEnabled.store(enabled ? 1 : 0);
+}
+
+qint64 BrowserTrace::now() const
+{
+    return m_clock.nsecsElapsed() / 1000;
+}
+
+void BrowserTrace::span(const char *name, qint64 start, qint64 duration)
+{
+    Event event;
+    event.name = name;
+    event.start = start;
+    event.duration = duration;
+    event.thread = quint64(quintptr(QThread::currentThreadId()));
+    append(event);
+}
+
+void BrowserTrace::instant(const char *name)
+{
+    span(name, now(), -1);
+}
+
+/**
+ * @brief BrowserTrace::events
+ * @return recorded events, oldest first.
+ */
+QVector<BrowserTrace::Event> BrowserTrace::events() const
+{
+    QMutexLocker lock(&m_mutex);
+    if (!m_wrapped) {
+        return m_events.mid(0, m_next);
+    }
+    return m_events.mid(m_next) + m_events.mid(0, m_next);
+}
+
+int BrowserTrace::capacity() const
+{
+    return m_events.count();
+}
+
+void BrowserTrace::clear()
+{
+    QMutexLocker lock(&m_mutex);
+    m_next = 0;
+    m_wrapped = false;
+}
+
+QByteArray BrowserTrace::toChromeTrace() const
+{
+    QVector<Event> events = this->events();
+    QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+
+    // Threads are numbered in order of appearance, the first one is the main thread.
+    QList<quint64> threads;
+    QByteArray json("{\"traceEvents\":[");
+    for (int i = 0; i < events.count(); ++i) {
+        const Event &event = events.at(i);
+        int tid = threads.indexOf(event.thread);
+        if (tid < 0) {
+            tid = threads.count();
+            threads.append(event.thread);
+        }
+
+        if (i > 0) {
+            json += ',';
+        }
+        json += "\n{\"name\":\"";
+        json += event.name;
+        json += "\",\"cat\":\"startup\",\"ph\":\"";
+        json += event.duration < 0 ? "i\",\"s\":\"p" : "X";
+        json += "\",\"ts\":";
+        json += QByteArray::number(event.start);
+        if (event.duration >= 0) {
+            json += ",\"dur\":";
+            json += QByteArray::number(event.duration);
+        }
+        json += ",\"pid\":" + pid + ",\"tid\":" + QByteArray::number(tid) + "}";
+    }
+    json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return json;
+}
+
+QString BrowserTrace::outputPath() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_outputPath;
+}
+
+void BrowserTrace::setOutputPath(const QString &path)
+{
+    QMutexLocker lock(&m_mutex);
+    m_outputPath = path;
+}
+
+bool BrowserTrace::save()
+{
+    QString path = outputPath();
+    if (path.isEmpty()) {
+        return false;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << Q_FUNC_INFO << "failed to write trace" << path << file.errorString();
+        return false;
+    }
+    file.write(toChromeTrace());
+    return true;
+}
+
+void BrowserTrace::markFirstFrame()
+{
+    if (sender()) {
+        disconnect(sender(), 0, this, SLOT(markFirstFrame()));
+    }
+    instant("firstFrame");
+    QTimer::singleShot(gSaveDelay, this, SLOT(save()));
+}
+
+void BrowserTrace::markEmbeddingStarted()
+{
+    qint64 start = now();
+    {
+        QMutexLocker lock(&m_mutex);
+        m_embeddingStart = start;
+    }
+    instant("runEmbedding");
+}
+
+void BrowserTrace::markEngineInitialized()
+{
+    if (sender()) {
+        disconnect(sender(), 0, this, SLOT(markEngineInitialized()));
+    }
+
+    qint64 start;
+    {
+        QMutexLocker lock(&m_mutex);
+        start = m_embeddingStart;
+        m_embeddingStart = -1;
+    }
+    if (start >= 0) {
+        span("engineInitialization", start, now() - start);
+    } else {
+        instant("engineInitialized");
+    }
+}
+
+void BrowserTrace::append(const Event &event)
+{
+    QMutexLocker lock(&m_mutex);
+    m_events[m_next] = event;
+    if (++m_next == m_events.count()) {
+        m_next = 0;
+        m_wrapped = true;
+    }
+}
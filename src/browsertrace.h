@@ -0,0 +1,123 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BROWSERTRACE_H
+#define BROWSERTRACE_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+/**
+ * Records timed spans of startup phases to a fixed size ring buffer. Timestamps
+ * come from a monotonic clock, in microseconds since the trace was created.
+ * Recording is off by default. When the BROWSER_TRACE environment variable
+ * names a file, the trace is written there in Chrome trace event format
+ * (chrome://tracing) a while after the first frame and again when the
+ * browser quits.
+ *
+ * Event names must be string literals, they are stored as pointers.
+ * Thread safe.
+ */
+class BrowserTrace : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Event {
+        const char *name;
+        // Microseconds from the start of the trace.
+        qint64 start;
+        // -1 for instant events.
+        qint64 duration;
+        quint64 thread;
+    };
+
+    explicit BrowserTrace(int capacity = 4096, QObject *parent = 0);
+
+    static BrowserTrace *instance();
+    static bool enabled();
+    static void setEnabled(bool enabled);
+
+    qint64 now() const;
+    void span(const char *name, qint64 start, qint64 duration);
+    void instant(const char *name);
+
+    QVector<Event> events() const;
+    int capacity() const;
+    void clear();
+
+    QByteArray toChromeTrace() const;
+
+    QString outputPath() const;
+    void setOutputPath(const QString &path);
+
+public slots:
+    bool save();
+    // Connect to QQuickWindow::frameSwapped(), records only the first frame.
+    void markFirstFrame();
+    // Call right before QMozContext::runEmbedding().
+    void markEmbeddingStarted();
+    // Connect to QMozContext::onInitialized(), records the engine start as a span.
+    void markEngineInitialized();
+
+private:
+    void append(const Event &event);
+
+    mutable QMutex m_mutex;
+    QElapsedTimer m_clock;
+    QVector<Event> m_events;
+    // Index where the next event is written, events before it are the newest.
+    int m_next;
+    bool m_wrapped;
+    QString m_outputPath;
+    // When embedding was started, -1 until then.
+    qint64 m_embeddingStart;
+};
+
+/**
+ * Records the lifetime of the object as a span.
+ */
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char *name)
+        : m_name(name)
+        , m_start(BrowserTrace::enabled() ? BrowserTrace::instance()->now() : -1)
+    {
+    }
+
+    ~TraceSpan()
+    {
+        if (m_start >= 0) {
+            BrowserTrace *trace = BrowserTrace::instance();
+            trace->span(m_name, m_start, trace->now() - m_start);
+        }
+    }
+
+private:
+    const char *m_name;
+    qint64 m_start;
+};
+
+#define BROWSER_TRACE_CONCAT_(a, b) a##b
+#define BROWSER_TRACE_CONCAT(a, b) BROWSER_TRACE_CONCAT_(a, b)
+
+// Traces the rest of the enclosing scope.
+#define TRACE_SPAN(name) TraceSpan BROWSER_TRACE_CONCAT(traceSpan, __LINE__)(name)
+// Marks a point in time.
+#define TRACE_INSTANT(name) \
+    do { if (BrowserTrace::enabled()) BrowserTrace::instance()->instant(name); } while (0)
+
+#endif // BROWSERTRACE_H
@@ -0,0 +1,203 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "componentloader.h"
+#include "browsertrace.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QQmlComponent>
+#include <QQmlEngine>
+#include <QQuickWindow>
+#include <QTimerEvent>
+
+// One queued component is compiled per interval so that the event loop
+// keeps serving the page that is loading.
+static const int gPreloadInterval = 50;
+
+ComponentLoader::ComponentLoader(QQmlEngine *engine, QObject *parent)
+    : QObject(parent)
+    , m_engine(engine)
+    , m_firstFrameShown(false)
+    , m_pageLoaded(false)
+    , m_preloadTimer(0)
+{
+}
+
+void ComponentLoader::setWindow(QQuickWindow *window)
+{
+    connect(window, SIGNAL(frameSwapped()), this, SLOT(firstFrameSwapped()));
+}
+
+/**
+ * @brief ComponentLoader::component
+ * Returns the component of the url. A component that has not been compiled
+ * yet is compiled right away. A component that is still being compiled in the
+ * background is returned while loading, use whenReady() for those.
+ */
+QQmlComponent *ComponentLoader::component(const QUrl &url)
+{
+    QQmlComponent *component = m_components.value(url);
+    if (component) {
+        return component;
+    }
+
+    TRACE_SPAN("ComponentLoader::component");
+#ifdef DEBUG_LOGS
+    QElapsedTimer timer;
+    timer.start();
+#endif
+
+    component = new QQmlComponent(m_engine, url, QQmlComponent::PreferSynchronous, this);
+    QQmlEngine::setObjectOwnership(component, QQmlEngine::CppOwnership);
+    m_components.insert(url, component);
+    m_preloadQueue.removeAll(url);
+
+    if (component->isError()) {
+        qWarning() << Q_FUNC_INFO << component->errorString();
+    }
+
+    if (!m_firstFrameShown) {
+        m_loadedBeforeFirstFrame.append(url.fileName());
+        // Compile time is in the span above, names of the components in loadedBeforeFirstFrame.
+        TRACE_INSTANT("ComponentLoader::compiledBeforeFirstFrame");
+#ifdef DEBUG_LOGS
+        qDebug() << "Compiled before first frame:" << url.fileName() << timer.elapsed() << "ms";
+#endif
+    }
+    return component;
+}
+
+/**
+ * @brief ComponentLoader::whenReady
+ * Calls callback with the component of the url once it is ready. Callback is
+ * called right away unless the component is still being compiled in the
+ * background, and never for a component that failed to compile.
+ */
+void ComponentLoader::whenReady(const QUrl &url, QJSValue callback)
+{
+    QQmlComponent *component = this->component(url);
+    if (component->isLoading()) {
+        if (!m_waiting.contains(component)) {
+            connect(component, SIGNAL(statusChanged(QQmlComponent::Status)), this, SLOT(componentStatusChanged()));
+        }
+        m_waiting[component].append(callback);
+    } else {
+        call(callback, component);
+    }
+}
+
+/**
+ * @brief ComponentLoader::preload
+ * Queues the url to be compiled in the background after the first frame
+ * and the first page load.
+ */
+void ComponentLoader::preload(const QUrl &url)
+{
+    if (m_components.contains(url) || m_preloadQueue.contains(url)) {
+        return;
+    }
+
+    m_preloadQueue.append(url);
+    startPreloading();
+}
+
+bool ComponentLoader::firstFrameShown() const
+{
+    return m_firstFrameShown;
+}
+
+QStringList ComponentLoader::loadedBeforeFirstFrame() const
+{
+    return m_loadedBeforeFirstFrame;
+}
+
+void ComponentLoader::firstFrameSwapped()
+{
+    if (sender()) {
+        disconnect(sender(), 0, this, SLOT(firstFrameSwapped()));
+    }
+    if (m_firstFrameShown) {
+        return;
+    }
+
+    m_firstFrameShown = true;
+#ifdef DEBUG_LOGS
+    qDebug() << "Components compiled before first frame:" << m_loadedBeforeFirstFrame;
+#endif
+
+    startPreloading();
+}
+
+/**
+ * @brief ComponentLoader::pageLoaded
+ * Preloading waits for the first page to finish loading so that compiling does
+ * not compete with it.
+ */
+void ComponentLoader::pageLoaded()
+{
+    if (!m_pageLoaded) {
+        m_pageLoaded = true;
+        startPreloading();
+    }
+}
+
+void ComponentLoader::componentStatusChanged()
+{
+    QQmlComponent *component = qobject_cast<QQmlComponent *>(sender());
+    if (!component || component->isLoading()) {
+        return;
+    }
+
+    disconnect(component, SIGNAL(statusChanged(QQmlComponent::Status)), this, SLOT(componentStatusChanged()));
+    foreach (QJSValue callback, m_waiting.take(component)) {
+        call(callback, component);
+    }
+}
+
+void ComponentLoader::startPreloading()
+{
+    if (m_firstFrameShown && m_pageLoaded && !m_preloadQueue.isEmpty() && !m_preloadTimer) {
+        m_preloadTimer = startTimer(gPreloadInterval);
+    }
+}
+
+void ComponentLoader::call(QJSValue callback, QQmlComponent *component)
+{
+    if (component->isError()) {
+        qWarning() << Q_FUNC_INFO << component->errorString();
+        return;
+    }
+
+    QJSValue result = callback.call(QJSValueList() << m_engine->newQObject(component));
+    if (result.isError()) {
+        qWarning() << Q_FUNC_INFO << result.toString();
+    }
+}
+
+void ComponentLoader::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() != m_preloadTimer) {
+        QObject::timerEvent(event);
+        return;
+    }
+
+    if (m_preloadQueue.isEmpty()) {
+        killTimer(m_preloadTimer);
+        m_preloadTimer = 0;
+        return;
+    }
+
+    QUrl url = m_preloadQueue.takeFirst();
+    QQmlComponent *component = new QQmlComponent(m_engine, url, QQmlComponent::Asynchronous, this);
+    QQmlEngine::setObjectOwnership(component, QQmlEngine::CppOwnership);
+    m_components.insert(url, component);
+}
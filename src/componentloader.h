@@ -0,0 +1,74 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef COMPONENTLOADER_H
+#define COMPONENTLOADER_H
+
+#include <QObject>
+#include <QHash>
+#include <QJSValue>
+#include <QList>
+#include <QStringList>
+#include <QUrl>
+
+class QQmlComponent;
+class QQmlEngine;
+class QQuickWindow;
+
+/**
+ * Registry of QML components that are not needed for the first frame.
+ * Components are compiled on first use, or in the background once the
+ * window has shown its first frame and the first page has been loaded if
+ * they were asked to be preloaded. Keeps track of the components that were
+ * compiled before the first frame.
+ */
+class ComponentLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ComponentLoader(QQmlEngine *engine, QObject *parent = 0);
+
+    void setWindow(QQuickWindow *window);
+
+    Q_INVOKABLE QQmlComponent *component(const QUrl &url);
+    Q_INVOKABLE void whenReady(const QUrl &url, QJSValue callback);
+    Q_INVOKABLE void preload(const QUrl &url);
+
+    bool firstFrameShown() const;
+    QStringList loadedBeforeFirstFrame() const;
+
+public slots:
+    void firstFrameSwapped();
+    void pageLoaded();
+
+protected:
+    void timerEvent(QTimerEvent *event);
+
+private slots:
+    void componentStatusChanged();
+
+private:
+    void startPreloading();
+    void call(QJSValue callback, QQmlComponent *component);
+
+    QQmlEngine *m_engine;
+    QHash<QUrl, QQmlComponent *> m_components;
+    // Callbacks waiting for a component that is compiled in the background.
+    QHash<QQmlComponent *, QList<QJSValue> > m_waiting;
+    QList<QUrl> m_preloadQueue;
+    QStringList m_loadedBeforeFirstFrame;
+    bool m_firstFrameShown;
+    bool m_pageLoaded;
+    int m_preloadTimer;
+};
+
+#endif // COMPONENTLOADER_H
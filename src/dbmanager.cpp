@@ -14,6 +14,7 @@
 #include <QMetaObject>
 
 #include "dbworker.h"
+#include "browsertrace.h"
 
 DBManager *DBManager::instance()
 {
@@ -37,13 +38,22 @@ DBManager::DBManager(QObject *parent)
     connect(&workerThread, SIGNAL(finished()), worker, SLOT(deleteLater()));
     connect(worker, SIGNAL(tabsAvailable(QList<Tab>)), this, SLOT(tabListAvailable(QList<Tab>)));
     connect(worker, SIGNAL(historyAvailable(QList<Link>)), this, SIGNAL(historyAvailable(QList<Link>)));
+    connect(worker, SIGNAL(historyIndexAvailable(QVariantList)), this, SIGNAL(historyIndexAvailable(QVariantList)));
+    connect(worker, SIGNAL(historyCleared()), this, SIGNAL(historyCleared()));
+    connect(worker, SIGNAL(linkVisited(QString,QString)), this, SIGNAL(linkVisited(QString,QString)));
     connect(worker, SIGNAL(tabHistoryAvailable(int,QList<Link>)), this, SIGNAL(tabHistoryAvailable(int,QList<Link>)));
     connect(worker, SIGNAL(tabChanged(Tab)), this, SIGNAL(tabChanged(Tab)));
     connect(worker, SIGNAL(tabAvailable(Tab)), this, SIGNAL(tabAvailable(Tab)));
     connect(worker, SIGNAL(titleChanged(QString,QString)), this, SIGNAL(titleChanged(QString,QString)));
-    connect(worker, SIGNAL(thumbPathChanged(QString,QString,int)), this, SIGNAL(thumbPathChanged(QString,QString,int)));
+    connect(worker, SIGNAL(bookmarksAvailable(QVariantList)), this, SIGNAL(bookmarksAvailable(QVariantList)));
+    connect(worker, SIGNAL(bookmarksImported(QVariantList)), this, SIGNAL(bookmarksImported(QVariantList)));
+    connect(worker, SIGNAL(bookmarkImportProgress(int,int)), this, SIGNAL(bookmarkImportProgress(int,int)));
+    connect(worker, SIGNAL(bookmarkImportFinished(int)), this, SIGNAL(bookmarkImportFinished(int)));
+    connect(worker, SIGNAL(downloadsAvailable(QVariantList)), this, SIGNAL(downloadsAvailable(QVariantList)));
+    connect(worker, SIGNAL(thumbPathChanged(QString,QString,QByteArray,int)), this, SIGNAL(thumbPathChanged(QString,QString,QByteArray,int)));
     workerThread.start();
 
+    TRACE_SPAN("DBManager::initWorker");
     QMetaObject::invokeMethod(worker, "init", Qt::BlockingQueuedConnection);
     QMetaObject::invokeMethod(worker, "getMaxTabId", Qt::BlockingQueuedConnection,
                               Q_RETURN_ARG(int, m_maxTabId));
@@ -125,10 +135,11 @@ void DBManager::updateTitle(int linkId, QString title)
                               Q_ARG(int, linkId), Q_ARG(QString, title));
 }
 
-void DBManager::updateThumbPath(QString url, QString path, int tabId)
+void DBManager::updateThumbPath(QString url, QString path, QByteArray placeholder, int tabId)
 {
     QMetaObject::invokeMethod(worker, "updateThumbPath", Qt::QueuedConnection,
-                              Q_ARG(QString, url), Q_ARG(QString, path), Q_ARG(int, tabId));
+                              Q_ARG(QString, url), Q_ARG(QString, path),
+                              Q_ARG(QByteArray, placeholder), Q_ARG(int, tabId));
 }
 
 void DBManager::clearHistory()
@@ -141,6 +152,11 @@ void DBManager::getHistory(const QString &filter)
     QMetaObject::invokeMethod(worker, "getHistory", Qt::QueuedConnection, Q_ARG(QString, filter));
 }
 
+void DBManager::getHistoryIndex()
+{
+    QMetaObject::invokeMethod(worker, "getHistoryIndex", Qt::QueuedConnection);
+}
+
 void DBManager::clearTabHistory(int tabId)
 {
     QMetaObject::invokeMethod(worker, "clearTabHistory", Qt::QueuedConnection, Q_ARG(int, tabId));
@@ -178,7 +194,54 @@ void DBManager::deleteSetting(QString name)
     }
 }
 
+void DBManager::getBookmarks()
+{
+    QMetaObject::invokeMethod(worker, "getBookmarks", Qt::QueuedConnection);
+}
+
+/**
+ * @brief DBManager::saveBookmarks
+ * @param wait blocks until the changes and everything queued before them have been stored
+ */
+void DBManager::saveBookmarks(QVariantList added, QStringList removed, bool wait)
+{
+    QMetaObject::invokeMethod(worker, "saveBookmarks", wait ? Qt::BlockingQueuedConnection : Qt::QueuedConnection,
+                              Q_ARG(QVariantList, added), Q_ARG(QStringList, removed));
+}
+
+/**
+ * @brief DBManager::importBookmarks
+ * Parsing and storing happen in the worker thread, progress is reported
+ * with bookmarkImportProgress.
+ */
+void DBManager::importBookmarks(QString path)
+{
+    QMetaObject::invokeMethod(worker, "importBookmarks", Qt::QueuedConnection,
+                              Q_ARG(QString, path));
+}
+
 void DBManager::tabListAvailable(QList<Tab> tabs)
 {
     emit tabsAvailable(tabs);
 }
+
+void DBManager::getDownloads()
+{
+    QMetaObject::invokeMethod(worker, "getDownloads", Qt::QueuedConnection);
+}
+
+/**
+ * @brief DBManager::saveDownload
+ * Inserts or replaces the download registry entry of download's target path.
+ */
+void DBManager::saveDownload(QVariantMap download)
+{
+    QMetaObject::invokeMethod(worker, "saveDownload", Qt::QueuedConnection,
+                              Q_ARG(QVariantMap, download));
+}
+
+void DBManager::removeDownload(QString targetPath)
+{
+    QMetaObject::invokeMethod(worker, "removeDownload", Qt::QueuedConnection,
+                              Q_ARG(QString, targetPath));
+}
@@ -15,6 +15,8 @@
 #include <QObject>
 #include <QMap>
 #include <QThread>
+#include <QStringList>
+#include <QVariantList>
 
 #include "link.h"
 #include "tab.h"
@@ -38,11 +40,12 @@ public:
     void goForward(int tabId);
     void goBack(int tabId);
 
-    void updateThumbPath(QString url, QString path, int tabId);
+    void updateThumbPath(QString url, QString path, QByteArray placeholder, int tabId);
     void updateTitle(int linkId, QString title);
 
     void clearHistory();
     void getHistory(const QString &filter = "");
+    void getHistoryIndex();
     void clearTabHistory(int tabId);
     void getTabHistory(int tabId);
 
@@ -52,18 +55,34 @@ public:
 
     int getMaxTabId();
 
+    void getBookmarks();
+    void saveBookmarks(QVariantList added, QStringList removed, bool wait = false);
+
+    void getDownloads();
+    void saveDownload(QVariantMap download);
+    void removeDownload(QString targetPath);
+
 public slots:
     void tabListAvailable(QList<Tab> tabs);
+    void importBookmarks(QString path);
 
 signals:
     void tabChanged(Tab tab);
     void tabAvailable(Tab tab);
     void tabsAvailable(QList<Tab> tab);
     void historyAvailable(QList<Link> links);
+    void historyIndexAvailable(QVariantList history);
+    void historyCleared();
+    void linkVisited(QString url, QString title);
     void tabHistoryAvailable(int tabId, QList<Link> links);
-    void thumbPathChanged(QString url, QString path, int tabId);
+    void thumbPathChanged(QString url, QString path, QByteArray placeholder, int tabId);
     void titleChanged(QString url, QString title);
     void settingsChanged();
+    void bookmarksAvailable(QVariantList bookmarks);
+    void bookmarksImported(QVariantList bookmarks);
+    void bookmarkImportProgress(int imported, int total);
+    void bookmarkImportFinished(int imported);
+    void downloadsAvailable(QVariantList downloads);
 
 private:
     DBManager(QObject *parent = 0);
@@ -15,6 +15,8 @@ DBusAdaptor::DBusAdaptor(BrowserService *browserService):
     QDBusAbstractAdaptor(browserService),
     m_BrowserService(browserService)
 {
+    // Progress signals of the service are emitted on D-Bus as well.
+    setAutoRelaySignals(true);
 }
 
 void DBusAdaptor::openUrl(QStringList args) {
@@ -28,3 +30,7 @@ void DBusAdaptor::cancelTransfer(int transferId) {
 void DBusAdaptor::restartTransfer(int transferId) {
     m_BrowserService->restartTransfer(transferId);
 }
+
+void DBusAdaptor::importBookmarks(QString path) {
+    m_BrowserService->importBookmarks(path);
+}
@@ -27,6 +27,11 @@ public slots:
     void openUrl(QStringList args);
     void cancelTransfer(int transferId);
     void restartTransfer(int transferId);
+    void importBookmarks(QString path);
+
+signals:
+    void bookmarkImportProgress(int imported, int total);
+    void bookmarkImportFinished(int imported);
 
 private:
     BrowserService *m_BrowserService;
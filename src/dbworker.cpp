@@ -10,6 +10,9 @@
  * You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "dbworker.h"
+#include "thumbnailcache.h"
+#include "bookmarkparser.h"
+#include "browsertrace.h"
 
 #include <QSqlError>
 #include <QSqlQuery>
@@ -31,7 +34,8 @@ static const char * const create_table_link =
         "CREATE TABLE link (link_id INTEGER PRIMARY KEY AUTOINCREMENT,\n"
         "url TEXT,\n"
         "title TEXT,\n"
-        "thumb_path TEXT\n"
+        "thumb_path TEXT,\n"
+        "thumb_placeholder BLOB\n"
         ");\n";
 
 static const char * const create_table_history =
@@ -51,22 +55,52 @@ static const char * const create_table_settings =
         "value TEXT\n"
         ");\n";
 
+static const char * const create_table_bookmark =
+        "CREATE TABLE bookmark (url TEXT PRIMARY KEY,\n"
+        "title TEXT,\n"
+        "favicon TEXT,\n"
+        "position INTEGER\n"
+        ");\n";
+
+static const char * const create_table_download =
+        "CREATE TABLE download (target_path TEXT PRIMARY KEY,\n"
+        "url TEXT,\n"
+        "display_name TEXT,\n"
+        "mime_type TEXT,\n"
+        "size INTEGER,\n"
+        "received INTEGER,\n"
+        "etag TEXT,\n"
+        "last_modified TEXT,\n"
+        "transfer_id INTEGER,\n"
+        "status INTEGER\n"
+        ");\n";
+
+// Bookmarks used to be stored to a json file, imported once to the database.
+static const char * const bookmarks_imported_setting = "bookmarks_imported";
+// Bulk imports are stored in transactions of this many bookmarks. Other queued
+// database calls get served between the batches.
+static const int gImportBatchSize = 200;
+
 static const char *db_schema[] = {
     create_table_tab,
     create_table_tab_history,
     create_table_link,
     create_table_history,
-    create_table_settings
+    create_table_settings,
+    create_table_bookmark,
+    create_table_download
 };
 static int db_schema_count = sizeof(db_schema) / sizeof(*db_schema);
 
 DBWorker::DBWorker(QObject *parent) :
     QObject(parent)
+  , m_imported(0)
 {
 }
 
 void DBWorker::init()
 {
+    TRACE_SPAN("DBWorker::init");
     QString databaseDir = QStandardPaths::writableLocation(QStandardPaths::DataLocation);
     const QString dbFileName = QLatin1String(DB_NAME);
     QDir dir(databaseDir);
@@ -90,6 +124,19 @@ void DBWorker::init()
             QSqlQuery query = prepare(db_schema[i]);
             execute(query);
         }
+    } else {
+        if (!m_database.record("link").contains("thumb_placeholder")) {
+            QSqlQuery query = prepare("ALTER TABLE link ADD COLUMN thumb_placeholder BLOB;");
+            execute(query);
+        }
+        if (!m_database.tables().contains("bookmark")) {
+            QSqlQuery query = prepare(create_table_bookmark);
+            execute(query);
+        }
+        if (!m_database.tables().contains("download")) {
+            QSqlQuery query = prepare(create_table_download);
+            execute(query);
+        }
     }
 }
 
@@ -138,6 +185,8 @@ int DBWorker::createLink(int tabId, QString url, QString title)
 
     if (!addToHistory(linkId)) {
         qWarning() << Q_FUNC_INFO << "failed to add url to history" << url;
+    } else {
+        emit linkVisited(url, title);
     }
 
     int historyId = addToTabHistory(tabId, linkId);
@@ -254,6 +303,7 @@ void DBWorker::getTab(int tabId)
 
 void DBWorker::getAllTabs()
 {
+    TRACE_SPAN("DBWorker::getAllTabs");
     QList<Tab> tabList;
     QSqlQuery query = prepare("SELECT tab_id, tab_history_id FROM tab;");
     if (!execute(query)) {
@@ -311,6 +361,8 @@ void DBWorker::navigateTo(int tabId, QString url, QString title, QString path) {
     int linkId = createLink(url, title, path);
     if (!addToHistory(linkId)) {
         qWarning() << Q_FUNC_INFO << "failed to add url to history" << url;
+    } else {
+        emit linkVisited(url, title);
     }
 
     int historyId = addToTabHistory(tabId, linkId);
@@ -476,6 +528,7 @@ void DBWorker::clearHistory()
     query = prepare("DELETE FROM link;");
     execute(query);
 
+    emit historyCleared();
     QList<Link> linkList;
     emit historyAvailable(linkList);
     QList<Tab> tabList;
@@ -538,7 +591,7 @@ int DBWorker::createLink(QString url, QString title, QString thumbPath)
     QSqlQuery query = prepare("INSERT INTO link (url, title, thumb_path) VALUES (?, ?, ?);");
     query.bindValue(0, url);
     query.bindValue(1, title);
-    query.bindValue(2, thumbPath);
+    query.bindValue(2, ThumbnailCache::keyForPath(thumbPath));
     execute(query);
 
     QVariant lastId = query.lastInsertId();
@@ -583,9 +636,36 @@ void DBWorker::getHistory(const QString &filter)
     emit historyAvailable(linkList);
 }
 
+/**
+ * @brief DBWorker::getHistoryIndex
+ * Emits all distinct urls of the history with the title of the latest visit,
+ * number of visits, and time of the latest visit.
+ */
+void DBWorker::getHistoryIndex()
+{
+    QSqlQuery query = prepare("SELECT link.url, link.title, COUNT(*), MAX(history.date) "
+                              "FROM history INNER JOIN link "
+                              "ON history.link_id = link.link_id "
+                              "GROUP BY link.url;");
+    if (!execute(query)) {
+        return;
+    }
+
+    QVariantList history;
+    while (query.next()) {
+        QVariantMap link;
+        link.insert("url", query.value(0));
+        link.insert("title", query.value(1));
+        link.insert("visits", query.value(2));
+        link.insert("lastVisit", query.value(3));
+        history.append(link);
+    }
+    emit historyIndexAvailable(history);
+}
+
 void DBWorker::getTabHistory(int tabId)
 {
-    QSqlQuery query = prepare("SELECT link.link_id, link.url, link.thumb_path, link.title "
+    QSqlQuery query = prepare("SELECT link.link_id, link.url, link.thumb_path, link.title, link.thumb_placeholder "
                               "FROM tab_history "
                               "INNER JOIN link "
                               "ON tab_history.link_id=link.link_id "
@@ -598,23 +678,22 @@ void DBWorker::getTabHistory(int tabId)
 
     QList<Link> linkList;
     while (query.next()) {
-        Link tmp(query.value(0).toInt(),
-                query.value(1).toString(),
-                query.value(2).toString(),
-                query.value(3).toString());
-        linkList.append(tmp);
+        linkList.append(readLink(query));
     }
 
     emit tabHistoryAvailable(tabId, linkList);
 }
 
-void DBWorker::updateThumbPath(QString url, QString path, int tabId)
+void DBWorker::updateThumbPath(QString url, QString path, QByteArray placeholder, int tabId)
 {
-    QSqlQuery query = prepare("UPDATE link SET thumb_path = ? WHERE url = ?;");
-    query.bindValue(0, path);
-    query.bindValue(1, url);
+    // Links store the key of the thumbnail, ThumbnailCache resolves it to a path.
+    // Placeholder is kept when not given.
+    QSqlQuery query = prepare("UPDATE link SET thumb_path = ?, thumb_placeholder = ifnull(?, thumb_placeholder) WHERE url = ?;");
+    query.bindValue(0, ThumbnailCache::keyForPath(path));
+    query.bindValue(1, placeholder.isEmpty() ? QVariant(QVariant::ByteArray) : QVariant(placeholder));
+    query.bindValue(2, url);
     if (execute(query)) {
-        emit thumbPathChanged(url, path, tabId);
+        emit thumbPathChanged(url, path, placeholder, tabId);
     }
 }
 
@@ -673,14 +752,11 @@ void DBWorker::deleteSetting(QString name)
 
 Link DBWorker::getLink(int linkId)
 {
-    QSqlQuery query = prepare("SELECT link_id, url, thumb_path, title FROM link WHERE link_id = ?;");
+    QSqlQuery query = prepare("SELECT link_id, url, thumb_path, title, thumb_placeholder FROM link WHERE link_id = ?;");
     query.bindValue(0, linkId);
     if (execute(query)) {
         if (query.first()) {
-            return Link(query.value(0).toInt(),
-                       query.value(1).toString(),
-                       query.value(2).toString(),
-                       query.value(3).toString());
+            return readLink(query);
         }
     }
     return Link();
@@ -692,19 +768,27 @@ Link DBWorker::getLink(QString url)
         return Link();
     }
 
-    QSqlQuery query = prepare("SELECT link_id, url, thumb_path, title FROM link WHERE url = ?;");
+    QSqlQuery query = prepare("SELECT link_id, url, thumb_path, title, thumb_placeholder FROM link WHERE url = ?;");
     query.bindValue(0, url);
     if (execute(query)) {
         if (query.first()) {
-            return Link(query.value(0).toInt(),
-                       query.value(1).toString(),
-                       query.value(2).toString(),
-                       query.value(3).toString());
+            return readLink(query);
         }
     }
     return Link();
 }
 
+// Reads link_id, url, thumb_path, title, thumb_placeholder columns.
+Link DBWorker::readLink(const QSqlQuery &query) const
+{
+    Link link(query.value(0).toInt(),
+              query.value(1).toString(),
+              ThumbnailCache::instance()->path(query.value(2).toString()),
+              query.value(3).toString());
+    link.setThumbPlaceholder(query.value(4).toByteArray());
+    return link;
+}
+
 void DBWorker::updateLink(int linkId, QString url, QString title, QString thumbPath)
 {
     // todo: check if an url in the db already contains url, then replace url
@@ -748,8 +832,174 @@ void DBWorker::updateLink(int linkId, QString url, QString title, QString thumbP
         query.bindValue(titleIndex, title);
     }
     if (thumbIndex > -1) {
-        query.bindValue(thumbIndex, thumbPath);
+        query.bindValue(thumbIndex, ThumbnailCache::keyForPath(thumbPath));
     }
     query.bindValue(index, linkId);
     execute(query);
 }
+
+void DBWorker::getBookmarks()
+{
+    QSqlQuery query = prepare("SELECT value FROM settings WHERE name = ?;");
+    query.bindValue(0, QString(bookmarks_imported_setting));
+    if (execute(query) && !query.first()) {
+        QString path = QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/bookmarks.json";
+        if (!QFile::exists(path)) {
+            path = QLatin1String("/usr/share/sailfish-browser/content/bookmarks.json");
+        }
+        saveBookmarks(BookmarkParser::parse(path), QStringList());
+        saveSetting(bookmarks_imported_setting, "true");
+    }
+
+    query = prepare("SELECT url, title, favicon FROM bookmark ORDER BY position ASC;");
+    if (!execute(query)) {
+        return;
+    }
+
+    QVariantList bookmarks;
+    while (query.next()) {
+        QVariantMap bookmark;
+        bookmark.insert("url", query.value(0));
+        bookmark.insert("title", query.value(1));
+        bookmark.insert("favicon", query.value(2));
+        bookmarks.append(bookmark);
+    }
+    emit bookmarksAvailable(bookmarks);
+}
+
+/**
+ * @brief DBWorker::saveBookmarks
+ * Applies a batch of changes in one transaction. Removals are applied first so
+ * that a bookmark removed and added again within the batch is kept.
+ * @param added list of maps with url, title, and favicon keys, new ones appended in order
+ * @param removed list of urls
+ */
+void DBWorker::saveBookmarks(QVariantList added, QStringList removed)
+{
+    m_database.transaction();
+
+    QSqlQuery query = prepare("DELETE FROM bookmark WHERE url = ?;");
+    foreach (const QString &url, removed) {
+        query.bindValue(0, url);
+        execute(query);
+    }
+
+    // Last position is read once per batch, positions skipped by updates leave gaps.
+    qlonglong position = 0;
+    query = prepare("SELECT MAX(position) FROM bookmark;");
+    if (execute(query) && query.first()) {
+        position = query.value(0).toLongLong();
+    }
+
+    // Updated bookmarks keep their position, new ones are appended.
+    query = prepare("INSERT OR REPLACE INTO bookmark (url, title, favicon, position) "
+                    "VALUES (?, ?, ?, ifnull((SELECT position FROM bookmark WHERE url = ?), ?));");
+    foreach (const QVariant &item, added) {
+        QVariantMap bookmark = item.toMap();
+        QString url = bookmark.value("url").toString();
+        query.bindValue(0, url);
+        query.bindValue(1, bookmark.value("title").toString());
+        query.bindValue(2, bookmark.value("favicon").toString());
+        query.bindValue(3, url);
+        query.bindValue(4, ++position);
+        execute(query);
+    }
+
+    if (!m_database.commit()) {
+        qWarning() << Q_FUNC_INFO << "failed to commit bookmarks" << m_database.lastError();
+        m_database.rollback();
+    }
+}
+
+/**
+ * @brief DBWorker::importBookmarks
+ * Parses a bookmark file and stores its bookmarks in batches. Imported bookmarks
+ * are reported batch by batch with bookmarksImported. Files queued while an
+ * import is running are appended to it.
+ * @param path json or html bookmark file
+ */
+void DBWorker::importBookmarks(QString path)
+{
+    QVariantList bookmarks = BookmarkParser::parse(path);
+#ifdef DEBUG_LOGS
+    qDebug() << "import" << bookmarks.count() << "bookmarks from" << path;
+#endif
+
+    bool importing = !m_importQueue.isEmpty();
+    m_importQueue.append(bookmarks);
+    if (!importing) {
+        if (m_importQueue.isEmpty()) {
+            emit bookmarkImportFinished(0);
+            return;
+        }
+        QMetaObject::invokeMethod(this, "importNextBatch", Qt::QueuedConnection);
+    }
+}
+
+void DBWorker::importNextBatch()
+{
+    QVariantList batch = m_importQueue.mid(m_imported, gImportBatchSize);
+    saveBookmarks(batch, QStringList());
+    m_imported += batch.count();
+    emit bookmarksImported(batch);
+    emit bookmarkImportProgress(m_imported, m_importQueue.count());
+
+    if (m_imported < m_importQueue.count()) {
+        QMetaObject::invokeMethod(this, "importNextBatch", Qt::QueuedConnection);
+    } else {
+        emit bookmarkImportFinished(m_imported);
+        m_importQueue.clear();
+        m_imported = 0;
+    }
+}
+
+void DBWorker::getDownloads()
+{
+    QSqlQuery query = prepare("SELECT target_path, url, display_name, mime_type, size, received, "
+                              "etag, last_modified, transfer_id, status FROM download;");
+    if (!execute(query)) {
+        return;
+    }
+
+    QVariantList downloads;
+    while (query.next()) {
+        QVariantMap download;
+        download.insert("targetPath", query.value(0));
+        download.insert("url", query.value(1));
+        download.insert("displayName", query.value(2));
+        download.insert("mimeType", query.value(3));
+        download.insert("size", query.value(4));
+        download.insert("received", query.value(5));
+        download.insert("etag", query.value(6));
+        download.insert("lastModified", query.value(7));
+        download.insert("transferId", query.value(8));
+        download.insert("status", query.value(9));
+        downloads.append(download);
+    }
+    emit downloadsAvailable(downloads);
+}
+
+void DBWorker::saveDownload(QVariantMap download)
+{
+    QSqlQuery query = prepare("INSERT OR REPLACE INTO download (target_path, url, display_name, mime_type, "
+                              "size, received, etag, last_modified, transfer_id, status) "
+                              "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?);");
+    query.bindValue(0, download.value("targetPath").toString());
+    query.bindValue(1, download.value("url").toString());
+    query.bindValue(2, download.value("displayName").toString());
+    query.bindValue(3, download.value("mimeType").toString());
+    query.bindValue(4, download.value("size").toLongLong());
+    query.bindValue(5, download.value("received").toLongLong());
+    query.bindValue(6, download.value("etag").toString());
+    query.bindValue(7, download.value("lastModified").toString());
+    query.bindValue(8, download.value("transferId").toInt());
+    query.bindValue(9, download.value("status").toInt());
+    execute(query);
+}
+
+void DBWorker::removeDownload(QString targetPath)
+{
+    QSqlQuery query = prepare("DELETE FROM download WHERE target_path = ?;");
+    query.bindValue(0, targetPath);
+    execute(query);
+}
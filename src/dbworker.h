@@ -15,6 +15,8 @@
 #include <QObject>
 #include <QMap>
 #include <QSqlDatabase>
+#include <QStringList>
+#include <QVariantList>
 
 #include "link.h"
 #include "tab.h"
@@ -42,11 +44,12 @@ public slots:
     int getMaxTabId();
 
     void updateTitle(int linkId, QString title);
-    void updateThumbPath(QString url, QString path, int tabId);
+    void updateThumbPath(QString url, QString path, QByteArray placeholder, int tabId);
 
     void goForward(int tabId);
     void goBack(int tabId);
     void getHistory(const QString &filter);
+    void getHistoryIndex();
     void getTabHistory(int tabId);
     void clearHistory();
     void clearTabHistory(int tabId);
@@ -55,19 +58,36 @@ public slots:
     SettingsMap getSettings();
     void deleteSetting(QString name);
 
+    void getBookmarks();
+    void saveBookmarks(QVariantList added, QStringList removed);
+    void importBookmarks(QString path);
+
+    void getDownloads();
+    void saveDownload(QVariantMap download);
+    void removeDownload(QString targetPath);
+
 signals:
     void tabAvailable(Tab tab);
     void tabChanged(Tab tab);
     void tabsAvailable(QList<Tab> tabs);
-    void thumbPathChanged(QString url, QString path, int tabId);
+    void thumbPathChanged(QString url, QString path, QByteArray placeholder, int tabId);
     void titleChanged(QString url, QString title);
     void tabHistoryAvailable(int tabId, QList<Link>);
     void historyAvailable(QList<Link>);
+    void historyIndexAvailable(QVariantList history);
+    void historyCleared();
+    void linkVisited(QString url, QString title);
+    void bookmarksAvailable(QVariantList bookmarks);
+    void bookmarksImported(QVariantList bookmarks);
+    void bookmarkImportProgress(int imported, int total);
+    void bookmarkImportFinished(int imported);
+    void downloadsAvailable(QVariantList downloads);
     void error(QString query);
 
 private:
     Link getLink(int linkId);
     Link getLink(QString url);
+    Link readLink(const QSqlQuery &query) const;
     void updateLink(int linkId, QString url, QString title, QString thumbPath);
     bool addToHistory(int linkId);
     int addToTabHistory(int tabId, int linkId);
@@ -84,6 +104,13 @@ private:
     QSqlQuery prepare(const char* statement);
     bool execute(QSqlQuery &query);
     QSqlDatabase m_database;
+
+    // Bookmarks of a bulk import, the first m_imported of them are stored.
+    QVariantList m_importQueue;
+    int m_imported;
+
+private slots:
+    void importNextBatch();
 };
 
 #endif // DBWORKER_H
@@ -10,19 +10,33 @@
  * You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "declarativebookmarkmodel.h"
+#include "dbmanager.h"
 
-#include <QJsonDocument>
-#include <QJsonArray>
-#include <QJsonObject>
+#include <QCoreApplication>
 #include <QDebug>
-#include <QDesktopServices>
-#include <QDir>
-#include <QFile>
-#include <QTextStream>
+#include <QSet>
+#include <QTimerEvent>
+
+// Changes done within this time are saved in one batch.
+static const int gSaveDelay = 250;
 
 DeclarativeBookmarkModel::DeclarativeBookmarkModel(QObject *parent) :
     QAbstractListModel(parent)
+  , m_loaded(false)
+  , m_saveTimer(0)
 {
+    connect(DBManager::instance(), SIGNAL(bookmarksAvailable(QVariantList)),
+            this, SLOT(bookmarksAvailable(QVariantList)));
+    connect(DBManager::instance(), SIGNAL(bookmarksImported(QVariantList)),
+            this, SLOT(bookmarksImported(QVariantList)));
+    // The model is not necessarily destroyed before the process exits.
+    connect(QCoreApplication::instance(), SIGNAL(aboutToQuit()), this, SLOT(flush()));
+}
+
+DeclarativeBookmarkModel::~DeclarativeBookmarkModel()
+{
+    flush();
+    qDeleteAll(m_bookmarks);
 }
 
 QHash<int, QByteArray> DeclarativeBookmarkModel::roleNames() const
@@ -34,117 +48,264 @@ QHash<int, QByteArray> DeclarativeBookmarkModel::roleNames() const
     return roles;
 }
 
-// TODO cleanup
 void DeclarativeBookmarkModel::addBookmark(const QString& url, const QString& title, const QString& favicon) {
-    beginInsertRows(QModelIndex(), rowCount(), rowCount());
-    bookmarks.insert(url, new Bookmark(title, url, favicon));
-    bookmarkUrls.append(url);
-    endInsertRows();
+    int row = m_rows.value(url, -1);
+    if (row >= 0) {
+        // Existing bookmark is updated in place.
+        Bookmark *bookmark = m_bookmarks.at(row);
+        bookmark->setTitle(title);
+        bookmark->setFavicon(favicon);
+        emit dataChanged(index(row), index(row), QVector<int>() << TitleRole << FaviconRole);
+    } else {
+        beginInsertRows(QModelIndex(), m_bookmarks.count(), m_bookmarks.count());
+        append(new Bookmark(title, url, favicon));
+        endInsertRows();
+        emit countChanged();
+    }
 
-    emit countChanged();
-    save();
+    queueAdd(url, title, favicon);
+    scheduleSave();
 }
 
 void DeclarativeBookmarkModel::removeBookmark(const QString& url) {
-    if(!contains(url)) {
+    int row = m_rows.value(url, -1);
+    if (row < 0) {
         return;
     }
 
-    if (bookmarks.contains(url)) {
-        int index = bookmarkUrls.indexOf(url);
-        beginRemoveRows(QModelIndex(), index, index);
-        Bookmark* bookmark = bookmarks.take(url);
-        delete bookmark;
-        bookmarkUrls.removeAt(index);
-        endRemoveRows();
+    beginRemoveRows(QModelIndex(), row, row);
+    delete m_bookmarks.takeAt(row);
+    m_rows.remove(url);
+    updateRows(row);
+    endRemoveRows();
 
+    if (m_addedBookmarks.remove(url) > 0) {
+        m_addedUrls.removeAll(url);
+    }
+    m_removedUrls.insert(url);
+
+    emit countChanged();
+    scheduleSave();
+}
+
+/**
+ * @brief DeclarativeBookmarkModel::importBookmarks
+ * Appends bookmarks that are not yet in the model with a single model reset.
+ * @param bookmarks list of objects with url, title, and favicon properties
+ * @return number of imported bookmarks
+ */
+int DeclarativeBookmarkModel::importBookmarks(const QVariantList &bookmarks)
+{
+    int imported = 0;
+    beginResetModel();
+    foreach (const QVariant &item, bookmarks) {
+        QVariantMap bookmark = item.toMap();
+        QString url = bookmark.value("url").toString();
+        if (url.isEmpty() || m_rows.contains(url)) {
+            continue;
+        }
+        QString title = bookmark.value("title").toString();
+        QString favicon = bookmark.value("favicon").toString();
+        append(new Bookmark(title, url, favicon));
+        queueAdd(url, title, favicon);
+        ++imported;
+    }
+    endResetModel();
+
+    if (imported > 0) {
         emit countChanged();
-        save();
+        scheduleSave();
     }
+    return imported;
+}
+
+/**
+ * @brief DeclarativeBookmarkModel::exportBookmarks
+ * @return bookmarks in display order as objects with url, title, and favicon properties.
+ */
+QVariantList DeclarativeBookmarkModel::exportBookmarks() const
+{
+    QVariantList bookmarks;
+    bookmarks.reserve(m_bookmarks.count());
+    foreach (const Bookmark *bookmark, m_bookmarks) {
+        QVariantMap item;
+        item.insert("url", bookmark->url());
+        item.insert("title", bookmark->title());
+        item.insert("favicon", bookmark->favicon());
+        bookmarks.append(item);
+    }
+    return bookmarks;
 }
 
 void DeclarativeBookmarkModel::componentComplete() {
-    QString settingsLocation = QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/bookmarks.json";
-    QScopedPointer<QFile> file(new QFile(settingsLocation));
+    // Bookmarks are loaded asynchronously by the DBWorker.
+    DBManager::instance()->getBookmarks();
+}
 
-    if (!file->open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qWarning() << "Unable to open bookmarks "+settingsLocation;
+void DeclarativeBookmarkModel::classBegin() {}
 
-        file.reset(new QFile(QLatin1Literal("/usr/share/sailfish-browser/content/bookmarks.json")));
-        if (!file->open(QIODevice::ReadOnly | QIODevice::Text)) {
-            qWarning() << "Unable to open bookmarks defaults";
-            return;
-        }
+void DeclarativeBookmarkModel::bookmarksAvailable(QVariantList bookmarkList)
+{
+    // Loaded once, model is the owner of the bookmarks after that.
+    if (m_loaded) {
+        return;
     }
+    m_loaded = true;
 
-    QJsonDocument doc = QJsonDocument::fromJson(file->readAll());
-    if (doc.isArray()) {
-        QJsonArray array = doc.array();
-        QJsonArray::iterator i;
-        for(i=array.begin(); i != array.end(); ++i) {
-            if((*i).isObject()) {
-                QJsonObject obj = (*i).toObject();
-                QString url = obj.value("url").toString();
-                Bookmark* m = new Bookmark(obj.value("title").toString(),
-                                           url,
-                                           obj.value("favicon").toString());
-                bookmarks.insert(url, m);
-                bookmarkUrls.append(url);
-            }
+    beginResetModel();
+    // Bookmarks added before loading completed are kept last.
+    QList<Bookmark*> added = m_bookmarks;
+    m_bookmarks.clear();
+    m_rows.clear();
+    m_bookmarks.reserve(bookmarkList.count() + added.count());
+    foreach (const QVariant &item, bookmarkList) {
+        QVariantMap bookmark = item.toMap();
+        QString url = bookmark.value("url").toString();
+        if (m_rows.contains(url) || m_removedUrls.contains(url) || m_addedBookmarks.contains(url)) {
+            continue;
         }
-    } else {
-        qWarning() << "Bookmarks.json should be an array of items";
+        append(new Bookmark(bookmark.value("title").toString(), url,
+                            bookmark.value("favicon").toString()));
+    }
+    foreach (Bookmark *bookmark, added) {
+        append(bookmark);
     }
+    endResetModel();
+
+    // Changes made before loading have been saved already unless a save is pending.
+    if (!m_saveTimer) {
+        m_addedBookmarks.clear();
+        m_addedUrls.clear();
+        m_removedUrls.clear();
+    }
+
     emit countChanged();
-    file->close();
 }
 
-void DeclarativeBookmarkModel::classBegin() {}
+/**
+ * @brief DeclarativeBookmarkModel::bookmarksImported
+ * Merges a batch of a bulk import that has already been stored. New bookmarks
+ * are inserted at the end in one go, existing ones are updated in place.
+ */
+void DeclarativeBookmarkModel::bookmarksImported(QVariantList bookmarkList)
+{
+    // Not loaded yet, loading picks the stored batches up.
+    if (!m_loaded) {
+        return;
+    }
 
-void DeclarativeBookmarkModel::save() {
-    QString settingsLocation = QStandardPaths::writableLocation(QStandardPaths::DataLocation);
-    QDir dir(settingsLocation);
-    if(!dir.exists()) {
-        if(!dir.mkpath(settingsLocation)) {
-            qWarning() << "Can't create directory "+ settingsLocation;
-            return;
+    QList<Bookmark*> added;
+    QSet<QString> addedUrls;
+    foreach (const QVariant &item, bookmarkList) {
+        QVariantMap bookmark = item.toMap();
+        QString url = bookmark.value("url").toString();
+        QString title = bookmark.value("title").toString();
+        QString favicon = bookmark.value("favicon").toString();
+        int row = m_rows.value(url, -1);
+        if (row >= 0) {
+            m_bookmarks.at(row)->setTitle(title);
+            m_bookmarks.at(row)->setFavicon(favicon);
+            emit dataChanged(index(row), index(row), QVector<int>() << TitleRole << FaviconRole);
+        } else if (!url.isEmpty() && !addedUrls.contains(url)) {
+            addedUrls.insert(url);
+            added.append(new Bookmark(title, url, favicon));
         }
     }
-    QString path = settingsLocation + "/bookmarks.json";
-    QFile file(path);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qWarning() << "Can't create file "+ path;
+
+    if (added.isEmpty()) {
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), m_bookmarks.count(), m_bookmarks.count() + added.count() - 1);
+    m_bookmarks.reserve(m_bookmarks.count() + added.count());
+    foreach (Bookmark *bookmark, added) {
+        append(bookmark);
+    }
+    endInsertRows();
+    emit countChanged();
+}
+
+void DeclarativeBookmarkModel::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() == m_saveTimer) {
+        save();
+    }
+}
+
+void DeclarativeBookmarkModel::append(Bookmark *bookmark)
+{
+    m_rows.insert(bookmark->url(), m_bookmarks.count());
+    m_bookmarks.append(bookmark);
+}
+
+// Rows after a removed row shift up by one.
+void DeclarativeBookmarkModel::updateRows(int from)
+{
+    for (int i = from; i < m_bookmarks.count(); ++i) {
+        m_rows[m_bookmarks.at(i)->url()] = i;
+    }
+}
+
+void DeclarativeBookmarkModel::queueAdd(const QString &url, const QString &title, const QString &favicon)
+{
+    QVariantMap bookmark;
+    bookmark.insert("url", url);
+    bookmark.insert("title", title);
+    bookmark.insert("favicon", favicon);
+    if (!m_addedBookmarks.contains(url)) {
+        m_addedUrls.append(url);
+    }
+    m_addedBookmarks.insert(url, bookmark);
+}
+
+void DeclarativeBookmarkModel::scheduleSave()
+{
+    if (!m_saveTimer) {
+        m_saveTimer = startTimer(gSaveDelay);
+    }
+}
+
+// Pending changes are stored before returning, the DBWorker thread is not joined on exit.
+void DeclarativeBookmarkModel::flush()
+{
+    save(true);
+}
+
+void DeclarativeBookmarkModel::save(bool wait) {
+    if (m_saveTimer) {
+        killTimer(m_saveTimer);
+        m_saveTimer = 0;
+    }
+
+    if (m_addedUrls.isEmpty() && m_removedUrls.isEmpty()) {
         return;
     }
-    QTextStream out(&file);
-    QJsonArray items;
 
-    QMapIterator<QString, Bookmark*> bookmarkIterator(bookmarks);
-    while (bookmarkIterator.hasNext()) {
-        bookmarkIterator.next();
-        QJsonObject title;
-        Bookmark* bookmark = bookmarkIterator.value();
-        title.insert("url", QJsonValue(bookmark->url()));
-        title.insert("title", QJsonValue(bookmark->title()));
-        title.insert("favicon", QJsonValue(bookmark->favicon()));
-        items.append(QJsonValue(title));
+    QVariantList added;
+    added.reserve(m_addedUrls.count());
+    foreach (const QString &url, m_addedUrls) {
+        added.append(m_addedBookmarks.value(url));
+    }
+    DBManager::instance()->saveBookmarks(added, m_removedUrls.toList(), wait);
+
+    // Loading still needs the changes to skip the stored rows, saving them again is harmless.
+    if (m_loaded) {
+        m_addedBookmarks.clear();
+        m_addedUrls.clear();
+        m_removedUrls.clear();
     }
-    QJsonDocument doc(items);
-    out.setCodec("UTF-8");
-    out << doc.toJson();
-    file.close();
 }
 
 int DeclarativeBookmarkModel::rowCount(const QModelIndex & parent) const {
     Q_UNUSED(parent)
-    return bookmarks.count();
+    return m_bookmarks.count();
 }
 
 QVariant DeclarativeBookmarkModel::data(const QModelIndex & index, int role) const {
-    if (index.row() < 0 || index.row() > bookmarkUrls.count())
+    if (index.row() < 0 || index.row() >= m_bookmarks.count())
         return QVariant();
 
-    const Bookmark * bookmark = bookmarks.value(bookmarkUrls[index.row()]);
+    const Bookmark * bookmark = m_bookmarks.at(index.row());
     if (role == UrlRole) {
         return bookmark->url();
     } else if (role == TitleRole) {
@@ -156,5 +317,5 @@ QVariant DeclarativeBookmarkModel::data(const QModelIndex & index, int role) con
 }
 
 bool DeclarativeBookmarkModel::contains(const QString& url) const {
-    return bookmarks.contains(url);
+    return m_rows.contains(url);
 }
@@ -14,7 +14,10 @@
 
 #include <QAbstractListModel>
 #include <QStringList>
-#include <QMap>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QVariantList>
 #include <QQmlParserStatus>
 
 #include "bookmark.h"
@@ -27,6 +30,7 @@ class DeclarativeBookmarkModel : public QAbstractListModel, public QQmlParserSta
     Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
 public:
     DeclarativeBookmarkModel(QObject *parent = 0);
+    ~DeclarativeBookmarkModel();
     
     enum BookmarkRoles {
            UrlRole = Qt::UserRole + 1,
@@ -37,6 +41,8 @@ public:
     Q_INVOKABLE void addBookmark(const QString& url, const QString& title, const QString& favicon);
     Q_INVOKABLE void removeBookmark(const QString& url);
     Q_INVOKABLE bool contains(const QString& url) const;
+    Q_INVOKABLE int importBookmarks(const QVariantList &bookmarks);
+    Q_INVOKABLE QVariantList exportBookmarks() const;
 
     // From QAbstractListModel
     int rowCount(const QModelIndex & parent = QModelIndex()) const;
@@ -50,10 +56,33 @@ public:
 signals:
     void countChanged();
 
+protected:
+    void timerEvent(QTimerEvent *event);
+
+private slots:
+    void bookmarksAvailable(QVariantList bookmarkList);
+    void bookmarksImported(QVariantList bookmarkList);
+    void flush();
+
 private:
-    void save();
+    void append(Bookmark *bookmark);
+    void updateRows(int from);
+    void queueAdd(const QString &url, const QString &title, const QString &favicon);
+    void scheduleSave();
+    void save(bool wait = false);
+
+    // Bookmarks in display order, which is also the order they are stored.
+    QList<Bookmark*> m_bookmarks;
+    QHash<QString, int> m_rows;
+    bool m_loaded;
+
+    // Changes not yet passed to the DBWorker. Until the initial load has been
+    // merged they are also kept after saving, loading skips the changed rows.
+    QHash<QString, QVariantMap> m_addedBookmarks;
+    QStringList m_addedUrls;
+    QSet<QString> m_removedUrls;
+    int m_saveTimer;
 
-    QMap<QString, Bookmark*> bookmarks;
-    QStringList bookmarkUrls;
+    friend class tst_declarativebookmarkmodel;
 };
 #endif // DECLARATIVEBOOKMARKMODEL_H
@@ -12,6 +12,9 @@
 #include "declarativehistorymodel.h"
 
 #include "dbmanager.h"
+#include "listdiff.h"
+
+#include <QVector>
 
 DeclarativeHistoryModel::DeclarativeHistoryModel(QObject *parent)
     : QAbstractListModel(parent)
@@ -37,6 +40,7 @@ void DeclarativeHistoryModel::clear()
 
     beginRemoveRows(QModelIndex(), 0, m_links.count() - 1);
     m_links.clear();
+    m_rows.clear();
     endRemoveRows();
     DBManager::instance()->clearHistory();
     emit countChanged();
@@ -81,38 +85,64 @@ void DeclarativeHistoryModel::historyAvailable(QList<Link> linkList)
     updateModel(linkList);
 }
 
+/**
+ * @brief DeclarativeHistoryModel::updateModel
+ * Applies the difference of the current and the new list as row removals,
+ * insertions, and moves so that views keep delegates of the unchanged rows.
+ * Rows are identified by url, changed titles are signaled with dataChanged.
+ */
 void DeclarativeHistoryModel::updateModel(QList<Link> linkList)
 {
-    int i = 0;
+    QVector<QString> oldKeys;
+    oldKeys.reserve(m_links.count());
+    foreach (const Link &link, m_links) {
+        oldKeys.append(link.url());
+    }
+    QVector<QString> newKeys;
+    newKeys.reserve(linkList.count());
+    foreach (const Link &link, linkList) {
+        newKeys.append(link.url());
+    }
+
+    int oldCount = m_links.count();
+    foreach (const ListEdit &edit, ListDiff::edits(oldKeys, newKeys)) {
+        if (edit.type == ListEdit::Remove) {
+            beginRemoveRows(QModelIndex(), edit.first, edit.last);
+            m_links.erase(m_links.begin() + edit.first, m_links.begin() + edit.last + 1);
+            endRemoveRows();
+        } else if (edit.type == ListEdit::Insert) {
+            beginInsertRows(QModelIndex(), edit.first, edit.last);
+            for (int row = edit.first; row <= edit.last; ++row) {
+                m_links.insert(row, linkList.at(row));
+            }
+            endInsertRows();
+        } else {
+            beginMoveRows(QModelIndex(), edit.first, edit.first, QModelIndex(), edit.last);
+            m_links.move(edit.first, edit.last);
+            endMoveRows();
+        }
+    }
+
     int startIndex = -1;
-    for (i = 0; i < linkList.count() && i < m_links.count(); i++) {
-        if (m_links.at(i) != linkList.at(i)) {
+    for (int i = 0; i <= linkList.count(); ++i) {
+        if (i < linkList.count() && m_links.at(i) != linkList.at(i)) {
             m_links[i] = linkList.at(i);
             if (startIndex < 0) {
                 startIndex = i;
             }
         } else if (startIndex >= 0) {
-            emit dataChanged(index(startIndex), index(i-1));
+            emit dataChanged(index(startIndex), index(i - 1));
             startIndex = -1;
         }
     }
 
-    if (startIndex >= 0) {
-        emit dataChanged(index(startIndex), index(m_links.count()-1));
+    m_rows.clear();
+    m_rows.reserve(m_links.count());
+    for (int i = 0; i < m_links.count(); ++i) {
+        m_rows.insert(m_links.at(i).url(), i);
     }
 
-    int difference = linkList.count() - m_links.count();
-    if (difference != 0) {
-        if (difference < 0) {
-            beginRemoveRows(QModelIndex(), linkList.count(), m_links.count()-1);
-            m_links.erase(m_links.begin()+linkList.count(), m_links.end());
-            endRemoveRows();
-        } else {
-            beginInsertRows(QModelIndex(), m_links.count(), linkList.count()-1);
-            m_links.append(linkList.mid(m_links.count()));
-            endInsertRows();
-        }
-
+    if (oldCount != m_links.count()) {
         emit countChanged();
     }
 }
@@ -121,8 +151,10 @@ void DeclarativeHistoryModel::updateTitle(QString url, QString title)
 {
     QVector<int> roles;
     roles << TitleRole;
-    for (int i = 0; i < m_links.count(); i++) {
-        if (m_links.at(i).url() == url && m_links.at(i).title() != title) {
+    QMultiHash<QString, int>::const_iterator it = m_rows.constFind(url);
+    for (; it != m_rows.constEnd() && it.key() == url; ++it) {
+        int i = it.value();
+        if (m_links.at(i).title() != title) {
             m_links[i].setTitle(title);
             QModelIndex start = index(i, 0);
             QModelIndex end = index(i, 0);
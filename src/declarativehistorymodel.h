@@ -13,6 +13,7 @@
 #define DECLARATIVEHISTORYMODEL_H
 
 #include <QAbstractListModel>
+#include <QMultiHash>
 #include <QQmlParserStatus>
 
 #include "tab.h"
@@ -55,6 +56,8 @@ private:
     void updateModel(QList<Link> linkList);
 
     QList<Link> m_links;
+    // Rows of each url, rebuilt by updateModel.
+    QMultiHash<QString, int> m_rows;
 
     friend class tst_declarativehistorymodel;
 };
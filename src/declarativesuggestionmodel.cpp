@@ -0,0 +1,306 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "declarativesuggestionmodel.h"
+#include "dbmanager.h"
+#include "listdiff.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QTimerEvent>
+
+static const int gDefaultLimit = 20;
+// Time a keystroke may spend collecting suggestions, in milliseconds.
+static const int gLatencyBudget = 8;
+
+DeclarativeSuggestionModel::DeclarativeSuggestionModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , m_limit(gDefaultLimit)
+    , m_dirtySources(0)
+    , m_updateTimer(0)
+{
+    connect(DBManager::instance(), SIGNAL(historyIndexAvailable(QVariantList)),
+            this, SLOT(historyIndexAvailable(QVariantList)));
+    connect(DBManager::instance(), SIGNAL(linkVisited(QString,QString)),
+            this, SLOT(linkVisited(QString,QString)));
+    connect(DBManager::instance(), SIGNAL(titleChanged(QString,QString)),
+            this, SLOT(updateTitle(QString,QString)));
+    connect(DBManager::instance(), SIGNAL(historyCleared()),
+            this, SLOT(clearHistory()));
+}
+
+QHash<int, QByteArray> DeclarativeSuggestionModel::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+    roles[UrlRole] = "url";
+    roles[TitleRole] = "title";
+    roles[BookmarkedRole] = "bookmarked";
+    roles[OpenTabRole] = "openTab";
+    return roles;
+}
+
+QObject *DeclarativeSuggestionModel::bookmarkModel() const
+{
+    return m_bookmarkModel;
+}
+
+void DeclarativeSuggestionModel::setBookmarkModel(QObject *object)
+{
+    QAbstractListModel *model = qobject_cast<QAbstractListModel *>(object);
+    if (m_bookmarkModel != model) {
+        if (m_bookmarkModel) {
+            m_bookmarkModel->disconnect(this);
+        }
+        m_bookmarkModel = model;
+        connectModel(model, SLOT(bookmarksChanged()));
+        bookmarksChanged();
+        emit bookmarkModelChanged();
+    }
+}
+
+QObject *DeclarativeSuggestionModel::tabModel() const
+{
+    return m_tabModel;
+}
+
+void DeclarativeSuggestionModel::setTabModel(QObject *object)
+{
+    QAbstractListModel *model = qobject_cast<QAbstractListModel *>(object);
+    if (m_tabModel != model) {
+        if (m_tabModel) {
+            m_tabModel->disconnect(this);
+        }
+        m_tabModel = model;
+        connectModel(model, SLOT(tabsChanged()));
+        tabsChanged();
+        emit tabModelChanged();
+    }
+}
+
+QString DeclarativeSuggestionModel::filter() const
+{
+    return m_filter;
+}
+
+void DeclarativeSuggestionModel::search(const QString &filter)
+{
+    if (m_filter != filter) {
+        m_filter = filter;
+        emit filterChanged();
+    }
+    update();
+}
+
+int DeclarativeSuggestionModel::rowCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent);
+    return m_suggestions.count();
+}
+
+QVariant DeclarativeSuggestionModel::data(const QModelIndex &index, int role) const
+{
+    if (index.row() < 0 || index.row() >= m_suggestions.count())
+        return QVariant();
+
+    const SuggestionIndex::Suggestion &suggestion = m_suggestions.at(index.row());
+    if (role == UrlRole) {
+        return suggestion.url;
+    } else if (role == TitleRole) {
+        return suggestion.title;
+    } else if (role == BookmarkedRole) {
+        return (suggestion.sources & SuggestionIndex::Bookmark) != 0;
+    } else if (role == OpenTabRole) {
+        return (suggestion.sources & SuggestionIndex::Tab) != 0;
+    }
+    return QVariant();
+}
+
+void DeclarativeSuggestionModel::classBegin()
+{
+}
+
+void DeclarativeSuggestionModel::componentComplete()
+{
+    DBManager::instance()->getHistoryIndex();
+}
+
+void DeclarativeSuggestionModel::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() == m_updateTimer) {
+        killTimer(m_updateTimer);
+        m_updateTimer = 0;
+        update();
+    }
+}
+
+void DeclarativeSuggestionModel::historyIndexAvailable(QVariantList history)
+{
+    foreach (const QVariant &item, history) {
+        QVariantMap link = item.toMap();
+        m_index.addHistory(link.value("url").toString(), link.value("title").toString(),
+                           link.value("visits").toInt(), link.value("lastVisit").toLongLong());
+    }
+    update();
+}
+
+void DeclarativeSuggestionModel::linkVisited(QString url, QString title)
+{
+    m_index.addHistory(url, title, 1, QDateTime::currentDateTimeUtc().toTime_t());
+    scheduleUpdate();
+}
+
+void DeclarativeSuggestionModel::updateTitle(QString url, QString title)
+{
+    m_index.updateTitle(url, title);
+    scheduleUpdate();
+}
+
+void DeclarativeSuggestionModel::clearHistory()
+{
+    m_index.clearHistory();
+    update();
+}
+
+void DeclarativeSuggestionModel::bookmarksChanged()
+{
+    m_dirtySources |= SuggestionIndex::Bookmark;
+    scheduleUpdate();
+}
+
+void DeclarativeSuggestionModel::tabsChanged()
+{
+    m_dirtySources |= SuggestionIndex::Tab;
+    scheduleUpdate();
+}
+
+void DeclarativeSuggestionModel::connectModel(QAbstractListModel *model, const char *slot)
+{
+    if (!model) {
+        return;
+    }
+    connect(model, SIGNAL(rowsInserted(QModelIndex,int,int)), this, slot);
+    connect(model, SIGNAL(rowsRemoved(QModelIndex,int,int)), this, slot);
+    connect(model, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)), this, slot);
+    connect(model, SIGNAL(modelReset()), this, slot);
+    connect(model, SIGNAL(layoutChanged()), this, slot);
+}
+
+// Items are read through the url and title roles of the model.
+void DeclarativeSuggestionModel::readItems(SuggestionIndex::Source source, QAbstractListModel *model)
+{
+    QList<SuggestionIndex::Item> items;
+    if (model) {
+        QHash<int, QByteArray> roles = model->roleNames();
+        int urlRole = roles.key("url", -1);
+        int titleRole = roles.key("title", -1);
+        int count = model->rowCount();
+        items.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            QModelIndex index = model->index(i);
+            items.append(qMakePair(model->data(index, urlRole).toString(),
+                                   model->data(index, titleRole).toString()));
+        }
+    }
+    m_index.setItems(source, items);
+}
+
+// Changes that arrive together, like a visit and the title of the page, are searched once.
+void DeclarativeSuggestionModel::scheduleUpdate()
+{
+    if (!m_updateTimer) {
+        m_updateTimer = startTimer(0);
+    }
+}
+
+void DeclarativeSuggestionModel::update()
+{
+    if (m_dirtySources & SuggestionIndex::Bookmark) {
+        readItems(SuggestionIndex::Bookmark, m_bookmarkModel);
+    }
+    if (m_dirtySources & SuggestionIndex::Tab) {
+        readItems(SuggestionIndex::Tab, m_tabModel);
+    }
+    m_dirtySources = 0;
+
+#ifdef DEBUG_LOGS
+    QElapsedTimer timer;
+    timer.start();
+#endif
+    if (m_filter.trimmed().isEmpty()) {
+        updateModel(QList<SuggestionIndex::Suggestion>());
+    } else {
+        updateModel(m_index.search(m_filter, m_limit, gLatencyBudget));
+    }
+#ifdef DEBUG_LOGS
+    qDebug() << "suggestions for" << m_filter << m_suggestions.count() << timer.nsecsElapsed() / 1000 << "us";
+#endif
+}
+
+/**
+ * @brief DeclarativeSuggestionModel::updateModel
+ * Applies the difference of the current and the new suggestions as row removals,
+ * insertions, and moves so that views keep delegates of the suggestions that stay
+ * while the user types. Rows are identified by url.
+ */
+void DeclarativeSuggestionModel::updateModel(const QList<SuggestionIndex::Suggestion> &suggestions)
+{
+    QVector<QString> oldKeys;
+    oldKeys.reserve(m_suggestions.count());
+    foreach (const SuggestionIndex::Suggestion &suggestion, m_suggestions) {
+        oldKeys.append(suggestion.url);
+    }
+    QVector<QString> newKeys;
+    newKeys.reserve(suggestions.count());
+    foreach (const SuggestionIndex::Suggestion &suggestion, suggestions) {
+        newKeys.append(suggestion.url);
+    }
+
+    int oldCount = m_suggestions.count();
+    foreach (const ListEdit &edit, ListDiff::edits(oldKeys, newKeys)) {
+        if (edit.type == ListEdit::Remove) {
+            beginRemoveRows(QModelIndex(), edit.first, edit.last);
+            m_suggestions.erase(m_suggestions.begin() + edit.first, m_suggestions.begin() + edit.last + 1);
+            endRemoveRows();
+        } else if (edit.type == ListEdit::Insert) {
+            beginInsertRows(QModelIndex(), edit.first, edit.last);
+            for (int row = edit.first; row <= edit.last; ++row) {
+                m_suggestions.insert(row, suggestions.at(row));
+            }
+            endInsertRows();
+        } else {
+            beginMoveRows(QModelIndex(), edit.first, edit.first, QModelIndex(), edit.last);
+            m_suggestions.move(edit.first, edit.last);
+            endMoveRows();
+        }
+    }
+
+    // Score is not shown, only changes of the roles are signaled.
+    int first = -1;
+    for (int i = 0; i <= suggestions.count(); ++i) {
+        bool changed = false;
+        if (i < suggestions.count()) {
+            changed = m_suggestions.at(i).title != suggestions.at(i).title
+                    || m_suggestions.at(i).sources != suggestions.at(i).sources;
+            m_suggestions[i] = suggestions.at(i);
+        }
+        if (changed && first < 0) {
+            first = i;
+        } else if (!changed && first >= 0) {
+            emit dataChanged(index(first), index(i - 1));
+            first = -1;
+        }
+    }
+
+    if (oldCount != m_suggestions.count()) {
+        emit countChanged();
+    }
+}
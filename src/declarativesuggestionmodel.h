@@ -0,0 +1,106 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef DECLARATIVESUGGESTIONMODEL_H
+#define DECLARATIVESUGGESTIONMODEL_H
+
+#include <QAbstractListModel>
+#include <QPointer>
+#include <QQmlParserStatus>
+
+#include "suggestionindex.h"
+
+class QTimerEvent;
+
+/**
+ * Suggestions for the url field from history, bookmarks, and open tabs ranked
+ * together. History is loaded once from the database and kept up to date with
+ * visits, bookmarks and tabs are read from the given models when they change.
+ *
+ * An empty filter has no suggestions, the history list shows the unranked
+ * history of HistoryModel until the user types something.
+ */
+class DeclarativeSuggestionModel : public QAbstractListModel, public QQmlParserStatus
+{
+    Q_OBJECT
+    Q_INTERFACES(QQmlParserStatus)
+
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+    // Any list models with url and title roles.
+    Q_PROPERTY(QObject *bookmarkModel READ bookmarkModel WRITE setBookmarkModel NOTIFY bookmarkModelChanged FINAL)
+    Q_PROPERTY(QObject *tabModel READ tabModel WRITE setTabModel NOTIFY tabModelChanged FINAL)
+    Q_PROPERTY(int limit MEMBER m_limit NOTIFY limitChanged FINAL)
+    Q_PROPERTY(QString filter READ filter NOTIFY filterChanged FINAL)
+
+public:
+    DeclarativeSuggestionModel(QObject *parent = 0);
+
+    enum SuggestionRoles {
+        UrlRole = Qt::UserRole + 1,
+        TitleRole,
+        BookmarkedRole,
+        OpenTabRole
+    };
+
+    QObject *bookmarkModel() const;
+    void setBookmarkModel(QObject *model);
+
+    QObject *tabModel() const;
+    void setTabModel(QObject *model);
+
+    QString filter() const;
+    Q_INVOKABLE void search(const QString &filter);
+
+    // From QAbstractListModel
+    int rowCount(const QModelIndex & parent = QModelIndex()) const;
+    QVariant data(const QModelIndex & index, int role = Qt::DisplayRole) const;
+    QHash<int, QByteArray> roleNames() const;
+
+    // From QQmlParserStatus
+    void classBegin();
+    void componentComplete();
+
+signals:
+    void countChanged();
+    void bookmarkModelChanged();
+    void tabModelChanged();
+    void limitChanged();
+    void filterChanged();
+
+protected:
+    void timerEvent(QTimerEvent *event);
+
+private slots:
+    void historyIndexAvailable(QVariantList history);
+    void linkVisited(QString url, QString title);
+    void updateTitle(QString url, QString title);
+    void clearHistory();
+    void bookmarksChanged();
+    void tabsChanged();
+
+private:
+    void connectModel(QAbstractListModel *model, const char *slot);
+    void readItems(SuggestionIndex::Source source, QAbstractListModel *model);
+    void scheduleUpdate();
+    void update();
+    void updateModel(const QList<SuggestionIndex::Suggestion> &suggestions);
+
+    SuggestionIndex m_index;
+    QList<SuggestionIndex::Suggestion> m_suggestions;
+    QPointer<QAbstractListModel> m_bookmarkModel;
+    QPointer<QAbstractListModel> m_tabModel;
+    QString m_filter;
+    int m_limit;
+    // Sources whose model changed since the last search, history is always up to date.
+    int m_dirtySources;
+    int m_updateTimer;
+};
+#endif // DECLARATIVESUGGESTIONMODEL_H
@@ -11,9 +11,10 @@
 
 #include "declarativetabmodel.h"
 #include "dbmanager.h"
+#include "browsertrace.h"
 #include "linkvalidator.h"
+#include "thumbnailcache.h"
 
-#include <QFile>
 #include <QDebug>
 #include <QStringList>
 #include <QUrl>
@@ -25,6 +26,7 @@ DeclarativeTabModel::DeclarativeTabModel(QObject *parent)
     , m_loaded(false)
     , m_browsing(false)
     , m_nextTabId(DBManager::instance()->getMaxTabId() + 1)
+    , m_restoredActiveTabId(0)
     , m_backForwardNavigation(false)
 {
     connect(DBManager::instance(), SIGNAL(tabsAvailable(QList<Tab>)),
@@ -40,6 +42,7 @@ QHash<int, QByteArray> DeclarativeTabModel::roleNames() const
     roles[TitleRole] = "title";
     roles[UrlRole] = "url";
     roles[TabIdRole] = "tabId";
+    roles[ThumbPlaceholderRole] = "thumbnailPlaceholder";
     return roles;
 }
 
@@ -76,7 +79,7 @@ int DeclarativeTabModel::nextTabId() const
 void DeclarativeTabModel::remove(int index) {
     if (!m_tabs.isEmpty() && index >= 0 && index < m_tabs.count()) {
         beginRemoveRows(QModelIndex(), index, index);
-        removeTab(m_tabs.at(index).tabId(), m_tabs.at(index).thumbnailPath(), index);
+        removeTab(m_tabs.at(index).tabId(), index);
         endRemoveRows();
         saveTabOrder();
     }
@@ -103,7 +106,7 @@ void DeclarativeTabModel::clear()
 
     beginResetModel();
     for (int i = m_tabs.count() - 1; i >= 0; --i) {
-        removeTab(m_tabs.at(i).tabId(), m_tabs.at(i).thumbnailPath(), i);
+        removeTab(m_tabs.at(i).tabId(), i);
     }
     closeActiveTab();
     endResetModel();
@@ -169,7 +172,7 @@ void DeclarativeTabModel::closeActiveTab()
         int activeTabId = m_activeTab.tabId();
         // Invalidate
         m_activeTab.setTabId(0);
-        removeTab(activeTabId, m_activeTab.thumbnailPath());
+        removeTab(activeTabId);
         if (!activateTab(0)) {
             // Last active tab got closed.
             emit activeTabChanged(activeTabId, 0);
@@ -229,6 +232,8 @@ QVariant DeclarativeTabModel::data(const QModelIndex & index, int role) const {
         return tab.url();
     } else if (role == TabIdRole) {
         return tab.tabId();
+    } else if (role == ThumbPlaceholderRole) {
+        return ThumbnailCache::placeholderUrl(tab.thumbnailPlaceholder());
     }
     return QVariant();
 }
@@ -305,33 +310,60 @@ void DeclarativeTabModel::setBackForwardNavigation(bool backForwardNavigation)
 
 void DeclarativeTabModel::classBegin()
 {
+    // A tab opened before the tabs are available overwrites the saved order.
+    m_restoredActiveTabId = loadTabOrder();
     DBManager::instance()->getAllTabs();
 }
 
 void DeclarativeTabModel::tabsAvailable(QList<Tab> tabs)
 {
+    TRACE_SPAN("DeclarativeTabModel::tabsAvailable");
     beginResetModel();
     int oldCount = count();
+
+    // Tabs opened before the restore finished, e.g. for a url the browser
+    // was launched with, stay in front of the restored tabs.
+    bool keepOpenedTabs = !m_loaded && m_activeTab.isValid();
+    QList<Tab> openedTabs;
+    if (keepOpenedTabs) {
+        openedTabs = m_tabs;
+        foreach (const Tab &tab, openedTabs) {
+            tabs.removeAll(tab);
+        }
+        tabs.removeAll(m_activeTab);
+    }
+
     m_tabs.clear();
     m_tabs = tabs;
 
-    int activeTabId = loadTabOrder();
+    Tab restoredActiveTab;
     if (m_tabs.count() > 0) {
         Tab tab;
-        tab.setTabId(activeTabId);
+        tab.setTabId(m_restoredActiveTabId);
 
         int index = m_tabs.indexOf(tab);
         if (index == -1) {
             index = 0;
         }
-        const Tab &activeTab = m_tabs.at(index);
-        m_tabs.removeAt(index);
-        m_activeTab = activeTab;
+        restoredActiveTab = m_tabs.takeAt(index);
     }
 
     qSort(m_tabs.begin(), m_tabs.end(), DeclarativeTabModel::tabSort);
+
+    if (keepOpenedTabs) {
+        if (restoredActiveTab.isValid()) {
+            m_tabs.prepend(restoredActiveTab);
+        }
+        m_tabs = openedTabs + m_tabs;
+    } else if (restoredActiveTab.isValid()) {
+        m_activeTab = restoredActiveTab;
+    }
     endResetModel();
 
+    if (keepOpenedTabs) {
+        saveTabOrder();
+    }
+
     if (count() != oldCount) {
         emit countChanged();
     }
@@ -371,6 +403,9 @@ void DeclarativeTabModel::tabChanged(const Tab &tab)
             if (oldTab.thumbnailPath() != tab.thumbnailPath()) {
                 roles << ThumbPathRole;
             }
+            if (oldTab.thumbnailPlaceholder() != tab.thumbnailPlaceholder()) {
+                roles << ThumbPlaceholderRole;
+            }
             m_tabs[i] = tab;
             QModelIndex start = index(i, 0);
             QModelIndex end = index(i, 0);
@@ -414,16 +449,13 @@ void DeclarativeTabModel::updateTitle(int tabId, bool activeTab, QString title)
     }
 }
 
-void DeclarativeTabModel::removeTab(int tabId, const QString &thumbnail, int index)
+void DeclarativeTabModel::removeTab(int tabId, int index)
 {
 #ifdef DEBUG_LOGS
     qDebug() << "index:" << index << tabId;
 #endif
     DBManager::instance()->removeTab(tabId);
-    QFile f(thumbnail);
-    if (f.exists()) {
-        f.remove();
-    }
+    ThumbnailCache::instance()->remove(ThumbnailCache::tabKey(tabId));
 
     if (index >= 0) {
         m_tabs.removeAt(index);
@@ -562,22 +594,36 @@ bool DeclarativeTabModel::tabSort(const Tab &t1, const Tab &t2)
     }
 }
 
-void DeclarativeTabModel::updateThumbnailPath(int tabId, bool activeTab, QString path)
+void DeclarativeTabModel::updateThumbnailPath(int tabId, bool activeTab, QString path, QByteArray placeholder)
 {
 #ifdef DEBUG_LOGS
     qDebug() << &m_activeTab;
 #endif
     if (activeTab) {
         m_activeTab.setThumbnailPath(path);
+        if (!placeholder.isEmpty()) {
+            m_activeTab.setThumbnailPlaceholder(placeholder);
+        }
     } else {
-        QVector<int> roles;
-        roles << ThumbPathRole;
         for (int i = 0; i < m_tabs.count(); i++) {
-            if (m_tabs.at(i).tabId() == tabId && m_tabs.at(i).thumbnailPath() != path) {
+            if (m_tabs.at(i).tabId() != tabId) {
+                continue;
+            }
+            QVector<int> roles;
+            if (m_tabs.at(i).thumbnailPath() != path) {
+                roles << ThumbPathRole;
+            }
+            if (!placeholder.isEmpty() && m_tabs.at(i).thumbnailPlaceholder() != placeholder) {
+                roles << ThumbPlaceholderRole;
+            }
+            if (!roles.isEmpty()) {
 #ifdef DEBUG_LOGS
                 qDebug() << "model tab thumbnail updated: " << path << tabId;
 #endif
                 m_tabs[i].setThumbnailPath(path);
+                if (!placeholder.isEmpty()) {
+                    m_tabs[i].setThumbnailPlaceholder(placeholder);
+                }
                 QModelIndex start = index(i, 0);
                 QModelIndex end = index(i, 0);
                 emit dataChanged(start, end, roles);
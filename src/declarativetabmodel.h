@@ -40,7 +40,8 @@ public:
         ThumbPathRole = Qt::UserRole + 1,
         TitleRole,
         UrlRole,
-        TabIdRole
+        TabIdRole,
+        ThumbPlaceholderRole
     };
 
     Q_INVOKABLE void remove(int index);
@@ -90,7 +91,7 @@ public:
 
     void updateUrl(int tabId, bool activeTab, QString url);
     void updateTitle(int tabId, bool activeTab, QString title);
-    void updateThumbnailPath(int tabId, bool activeTab, QString path);
+    void updateThumbnailPath(int tabId, bool activeTab, QString path, QByteArray placeholder = QByteArray());
 
     static bool tabSort(const Tab &t1, const Tab &t2);
 
@@ -129,7 +130,7 @@ private:
     };
 
     void load();
-    void removeTab(int tabId, const QString &thumbnail, int index = -1);
+    void removeTab(int tabId, int index = -1);
     int findTabIndex(int tabId) const;
     void saveTabOrder();
     int loadTabOrder();
@@ -144,6 +145,8 @@ private:
     bool m_loaded;
     bool m_browsing;
     int m_nextTabId;
+    // Active tab of the previous session, read before any tab gets opened.
+    int m_restoredActiveTabId;
     bool m_backForwardNavigation;
 
     QScopedPointer<NewTabData> m_newTabData;
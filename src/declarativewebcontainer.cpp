@@ -15,6 +15,7 @@
 #include "dbmanager.h"
 #include "downloadmanager.h"
 #include "declarativewebutils.h"
+#include "thumbnailcache.h"
 
 #include <QPointer>
 #include <QTimerEvent>
@@ -22,10 +23,14 @@
 #include <QDir>
 #include <QTransform>
 #include <QStandardPaths>
-#include <QtConcurrentRun>
+#include <QRunnable>
+#include <QThread>
 #include <QGuiApplication>
 #include <QScreen>
 #include <QMetaMethod>
+#include <QMutexLocker>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
 
 #include <qmozcontext.h>
 #include <QGuiApplication>
@@ -39,6 +44,7 @@ DeclarativeWebContainer::DeclarativeWebContainer(QQuickItem *parent)
     , m_background(false)
     , m_windowVisible(false)
     , m_backgroundTimer(0)
+    , m_batteryPowered(false)
     , m_active(false)
     , m_popupActive(false)
     , m_portrait(true)
@@ -54,9 +60,16 @@ DeclarativeWebContainer::DeclarativeWebContainer(QQuickItem *parent)
     , m_realNavigation(false)
     , m_readyToLoad(false)
     , m_maxLiveTabCount(5)
+    , m_capturePending(false)
+    , m_captureWindow(0)
+    , m_skippedCaptures(0)
     , m_deferredReload(false)
 {
     m_webPages.reset(new WebPages(this));
+    connect(m_webPages.data(), SIGNAL(virtualizeRequested(int)), this, SLOT(virtualizePage(int)));
+    // Background pages idle faster towards suspend when browser is not visible.
+    connect(this, SIGNAL(backgroundChanged()), m_webPages.data(), SLOT(schedule()));
+    connect(this, SIGNAL(batteryPoweredChanged()), m_webPages.data(), SLOT(schedule()));
     setFlag(QQuickItem::ItemHasContents, true);
     if (!window()) {
         connect(this, SIGNAL(windowChanged(QQuickWindow*)), this, SLOT(handleWindowChanged(QQuickWindow*)));
@@ -64,10 +77,14 @@ DeclarativeWebContainer::DeclarativeWebContainer(QQuickItem *parent)
         connect(window(), SIGNAL(visibleChanged(bool)), this, SLOT(windowVisibleChanged(bool)));
     }
 
-    connect(&m_screenCapturer, SIGNAL(finished()), this, SLOT(screenCaptureReady()));
+    m_captureThreadPool.setMaxThreadCount(1);
+    qRegisterMetaType<CaptureRequest>("CaptureRequest");
+    m_captureRequest.serial = 0;
     connect(DownloadManager::instance(), SIGNAL(downloadStarted()), this, SLOT(onDownloadStarted()));
-    connect(DBManager::instance(), SIGNAL(thumbPathChanged(QString,QString,int)),
-            this, SLOT(onPageThumbnailChanged(QString,QString,int)));
+    connect(this, SIGNAL(loadingChanged()), this, SLOT(updatePageLoading()));
+    connect(this, SIGNAL(foregroundChanged()), this, SLOT(updatePageLoading()));
+    connect(DBManager::instance(), SIGNAL(thumbPathChanged(QString,QString,QByteArray,int)),
+            this, SLOT(onPageThumbnailChanged(QString,QString,QByteArray,int)));
     connect(this, SIGNAL(maxLiveTabCountChanged()), this, SLOT(manageMaxTabCount()));
     connect(this, SIGNAL(_readyToLoadChanged()), this, SLOT(onReadyToLoad()));
     connect(this, SIGNAL(heightChanged()), this, SLOT(resetHeight()));
@@ -90,8 +107,8 @@ DeclarativeWebContainer::~DeclarativeWebContainer()
         disconnect(m_webPage, 0, 0, 0);
     }
 
-    m_screenCapturer.cancel();
-    m_screenCapturer.waitForFinished();
+    m_captureThreadPool.clear();
+    m_captureThreadPool.waitForDone();
 }
 
 DeclarativeWebPage *DeclarativeWebContainer::webPage() const
@@ -127,6 +144,7 @@ void DeclarativeWebContainer::setTabModel(DeclarativeTabModel *model)
             connect(m_model, SIGNAL(loadedChanged()), this, SLOT(onModelLoaded()));
             connect(m_model, SIGNAL(tabAdded(int)), this, SLOT(manageMaxTabCount()));
             connect(m_model, SIGNAL(tabClosed(int)), this, SLOT(releasePage(int)));
+            connect(m_model, SIGNAL(tabClosed(int)), this, SLOT(forgetThumbnail(int)));
             // Try to make this to normal direct connection once we have removed QML_BAD_GUI_RENDER_LOOP.
             connect(m_model, SIGNAL(newTabRequested(QString,QString,int)), this, SLOT(onNewTabRequested(QString,QString,int)), Qt::QueuedConnection);
             connect(m_model, SIGNAL(updateActiveThumbnail()), this, SLOT(updateThumbnail()));
@@ -158,6 +176,19 @@ bool DeclarativeWebContainer::background() const
     return m_background;
 }
 
+bool DeclarativeWebContainer::batteryPowered() const
+{
+    return m_batteryPowered;
+}
+
+void DeclarativeWebContainer::setBatteryPowered(bool batteryPowered)
+{
+    if (m_batteryPowered != batteryPowered) {
+        m_batteryPowered = batteryPowered;
+        emit batteryPoweredChanged();
+    }
+}
+
 int DeclarativeWebContainer::loadProgress() const
 {
     return m_loadProgress;
@@ -257,6 +288,11 @@ QString DeclarativeWebContainer::thumbnailPath() const
     return m_thumbnailPath;
 }
 
+int DeclarativeWebContainer::skippedCaptures() const
+{
+    return m_skippedCaptures;
+}
+
 void DeclarativeWebContainer::setThumbnailPath(QString thumbnailPath)
 {
     if (m_thumbnailPath != thumbnailPath) {
@@ -336,7 +372,8 @@ bool DeclarativeWebContainer::activatePage(int tabId, bool force)
     }
 
     m_webPages->initialize(this, m_webPageComponent.data());
-    if ((m_model->loaded() || force) && tabId > 0 && m_webPages->initialized()) {
+    // A requested url does not need to wait for the tabs to be restored.
+    if ((m_model->loaded() || force || m_model->hasNewTabData()) && tabId > 0 && m_webPages->initialized()) {
         WebPageActivationData activationData = m_webPages->page(tabId, m_model->newTabParentId());
         setWebPage(activationData.webPage);
         m_webPage->setChrome(true);
@@ -432,24 +469,61 @@ qreal DeclarativeWebContainer::contentHeight() const
     }
 }
 
-DeclarativeWebContainer::ScreenCapture DeclarativeWebContainer::saveToFile(QString url, QImage image, QRect cropBounds, int tabId, qreal rotate)
+class ScreenCaptureTask : public QRunnable
 {
-    QString path = QString("%1/tab-%2-thumb.png").arg(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).arg(tabId);
-    QTransform transform;
-    transform.rotate(360 - rotate);
-    image = image.transformed(transform);
-    image = image.copy(cropBounds);
+public:
+    ScreenCaptureTask(DeclarativeWebContainer *container, const DeclarativeWebContainer::ScreenCapture &capture)
+        : m_container(container)
+        , m_capture(capture)
+    {
+    }
 
-    ScreenCapture capture;
-    if(image.save(path)) {
-        capture.tabId = tabId;
-        capture.path = path;
-        capture.url = url;
-    } else {
-        capture.tabId = -1;
-        qWarning() << Q_FUNC_INFO << "failed to save image" << path;
+    void run()
+    {
+        // Encoding must not take CPU time from page rendering.
+        QThread::currentThread()->setPriority(QThread::IdlePriority);
+        QString key = ThumbnailCache::tabKey(m_capture.tabId);
+        ThumbnailCache *cache = ThumbnailCache::instance();
+
+        // Skip encoding and saving when the page looks the same as in the latest thumbnail.
+        uint hash = DeclarativeWebContainer::contentHash(m_capture.image, m_capture.transform);
+        if (m_capture.hasPreviousHash && m_capture.previousHash == hash && cache->contains(key)) {
+            QMetaObject::invokeMethod(m_container, "screenCaptureSkipped", Qt::QueuedConnection,
+                                      Q_ARG(int, m_capture.tabId), Q_ARG(QString, m_capture.url));
+            return;
+        }
+
+        QImage thumbnail = DeclarativeWebContainer::renderThumbnail(m_capture.image, m_capture.transform,
+                                                                    m_capture.swapRgb);
+        cache->setImage(key, thumbnail);
+        QByteArray placeholder = ThumbnailCache::placeholder(thumbnail);
+        // Container waits for the pool to be done before it gets destroyed.
+        QMetaObject::invokeMethod(m_container, "thumbnailReady", Qt::QueuedConnection,
+                                  Q_ARG(int, m_capture.tabId), Q_ARG(QByteArray, placeholder));
+
+        // Disk is only a backing store for the thumbnail kept in memory.
+        QString path = cache->store(key, thumbnail);
+        if (path.isEmpty()) {
+            qWarning() << Q_FUNC_INFO << "failed to store thumbnail" << m_capture.tabId;
+        }
+        QMetaObject::invokeMethod(m_container, "screenCaptureReady", Qt::QueuedConnection,
+                                  Q_ARG(int, m_capture.tabId), Q_ARG(QString, m_capture.url), Q_ARG(QString, path),
+                                  Q_ARG(QByteArray, placeholder), Q_ARG(uint, hash));
+    }
+
+private:
+    DeclarativeWebContainer *m_container;
+    DeclarativeWebContainer::ScreenCapture m_capture;
+};
+
+QImage DeclarativeWebContainer::renderThumbnail(QImage image, QTransform transform, bool swapRgb)
+{
+    if (swapRgb) {
+        // GL_RGBA byte order read into a 32-bit QImage.
+        image = image.rgbSwapped();
     }
-    return capture;
+    // Image contains only the captured region. Flip, rotation, and downscale are done in one pass.
+    return image.transformed(transform, Qt::SmoothTransformation);
 }
 
 void DeclarativeWebContainer::timerEvent(QTimerEvent *event)
@@ -523,19 +597,83 @@ void DeclarativeWebContainer::onActiveTabChanged(int oldTabId, int activeTabId)
     }
 }
 
-void DeclarativeWebContainer::screenCaptureReady()
+// Thumbnail is in memory, update immediately without waiting for disk and dbworker round trip.
+void DeclarativeWebContainer::thumbnailReady(int tabId, QByteArray placeholder)
 {
-    ScreenCapture capture = m_screenCapturer.result();
+    if (m_closedCaptures.contains(tabId)) {
+        return;
+    }
+
+    QString thumbnailUrl = ThumbnailCache::instance()->imageUrl(tabId);
 #ifdef DEBUG_LOGS
-    qDebug() << capture.tabId << capture.path << capture.url;
+    qDebug() << tabId << thumbnailUrl;
 #endif
-    if (capture.tabId != -1) {
-        // Update immediately without dbworker round trip.
-        if (isActiveTab(capture.tabId)) {
-            setThumbnailPath(capture.path);
-        }
+    if (isActiveTab(tabId)) {
+        setThumbnailPath(thumbnailUrl);
+    }
+    if (m_model) {
+        m_model->updateThumbnailPath(tabId, isActiveTab(tabId), thumbnailUrl, placeholder);
+    }
+}
+
+void DeclarativeWebContainer::screenCaptureReady(int tabId, QString url, QString path, QByteArray placeholder, uint hash)
+{
+#ifdef DEBUG_LOGS
+    qDebug() << tabId << path << url;
+#endif
+    m_capturesInFlight.remove(tabId);
+    if (m_closedCaptures.remove(tabId)) {
+        // Tab was closed while capturing, don't resurrect its thumbnail.
+        ThumbnailCache::instance()->remove(ThumbnailCache::tabKey(tabId));
+        return;
+    }
+
+    if (!path.isEmpty()) {
         // TODO: Cleanup url.
-        DBManager::instance()->updateThumbPath(capture.url, capture.path, capture.tabId);
+        DBManager::instance()->updateThumbPath(url, path, placeholder, tabId);
+        CapturedContent content;
+        content.hash = hash;
+        content.url = url;
+        content.placeholder = placeholder;
+        m_capturedContent.insert(tabId, content);
+    } else {
+        // Don't let a failed capture prevent next capture of the same content.
+        m_capturedContent.remove(tabId);
+    }
+
+    startNextCapture(tabId);
+}
+
+// Content has not changed since the latest thumbnail, which is kept.
+void DeclarativeWebContainer::screenCaptureSkipped(int tabId, QString url)
+{
+    m_capturesInFlight.remove(tabId);
+    if (m_closedCaptures.remove(tabId)) {
+        return;
+    }
+
+    if (isActiveTab(tabId)) {
+        setThumbnailPath(ThumbnailCache::instance()->imageUrl(tabId));
+    }
+    if (m_capturedContent.contains(tabId) && m_capturedContent.value(tabId).url != url) {
+        // Same content behind another url e.g. after a fragment navigation.
+        QString path = ThumbnailCache::instance()->path(ThumbnailCache::tabKey(tabId));
+        DBManager::instance()->updateThumbPath(url, path, m_capturedContent.value(tabId).placeholder, tabId);
+        m_capturedContent[tabId].url = url;
+    }
+    ++m_skippedCaptures;
+    emit skippedCapturesChanged();
+#ifdef DEBUG_LOGS
+    qDebug() << "capture skipped, content not changed:" << tabId << m_skippedCaptures;
+#endif
+
+    startNextCapture(tabId);
+}
+
+void DeclarativeWebContainer::startNextCapture(int tabId)
+{
+    if (m_queuedCaptures.contains(tabId)) {
+        queueScreenCapture(m_queuedCaptures.take(tabId));
     }
 }
 
@@ -582,6 +720,12 @@ void DeclarativeWebContainer::onDownloadStarted()
     }
 }
 
+void DeclarativeWebContainer::updatePageLoading()
+{
+    // Downloads wait while the user is looking at a page that is loading.
+    DownloadManager::instance()->setPageLoading(m_foreground && m_loading);
+}
+
 void DeclarativeWebContainer::onNewTabRequested(QString url, QString title, int parentId)
 {
     if (m_active) {
@@ -603,7 +747,8 @@ void DeclarativeWebContainer::onNewTabRequested(QString url, QString title, int
 
 void DeclarativeWebContainer::onReadyToLoad()
 {
-    // Triggered when tabs of tab model are available and QmlMozView is ready to load.
+    // Triggered when tabs of tab model are available, or a new tab has been requested,
+    // and QmlMozView is ready to load.
     // Load test
     // 1) tabModel.hasNewTabData -> loadTab (already activated view)
     // 2) model has tabs, load active tab -> load (activate view when needed)
@@ -620,7 +765,10 @@ void DeclarativeWebContainer::onReadyToLoad()
         // First tab is actived when tabs are loaded to the tabs tabModel.
         m_model->resetNewTabData();
         const Tab &tab = m_model->activeTab();
-        emit triggerLoad(tab.url(), tab.title());
+        // The tab requested before the tabs were restored is already loaded.
+        if (m_webPage->tabId() != tab.tabId() || m_webPage->url().toString() != tab.url()) {
+            emit triggerLoad(tab.url(), tab.title());
+        }
     } else {
         // This can happen only during startup.
         emit triggerLoad(DeclarativeWebUtils::instance()->homePage(), "");
@@ -630,6 +778,8 @@ void DeclarativeWebContainer::onReadyToLoad()
 /**
  * @brief DeclarativeTab::captureScreen
  * Rotation transformation is applied first, then geometry values on top of it.
+ * Only the region of the window that ends up in the thumbnail is read back
+ * once the window has been rendered.
  * @param url
  * @param size
  * @param rotate clockwise rotation of the image in degrees
@@ -640,17 +790,156 @@ void DeclarativeWebContainer::captureScreen(QString url, int size, qreal rotate)
         return;
     }
 
-    // Cleanup old thumb.
-    setThumbnailPath("");
-
-    QImage image = window()->grabWindow();
+    QTransform rotation;
+    rotation.rotate(360 - rotate);
     QRect cropBounds(0, 0, size, size);
+    QRect windowRect(0, 0, window()->width(), window()->height());
+    // Map crop bounds of the rotated image back to window coordinates.
+    QTransform windowToImage = QImage::trueMatrix(rotation, windowRect.width(), windowRect.height());
+    QRect rect = windowToImage.inverted().mapRect(cropBounds) & windowRect;
+    // Framebuffer is in device pixels.
+    qreal devicePixelRatio = window()->devicePixelRatio();
+
+    // Downscale to the resolution tier of the thumbnail cache.
+    int thumbnailSize = ThumbnailCache::instance()->thumbnailSize(QGuiApplication::primaryScreen()->size().width());
+
+    QMutexLocker lock(&m_captureMutex);
+    m_captureRequest.url = url;
+    m_captureRequest.tabId = m_webPage->tabId();
+    ++m_captureRequest.serial;
+    m_captureRequest.rect = QRectF(QPointF(rect.topLeft()) * devicePixelRatio,
+                                   QSizeF(rect.size()) * devicePixelRatio).toAlignedRect();
+    m_captureRequest.windowHeight = qRound(windowRect.height() * devicePixelRatio);
+    m_captureRequest.rotation = rotation;
+    m_captureRequest.scale = qMin<qreal>(1.0, (qreal)thumbnailSize / (size * devicePixelRatio));
+
+    if (!m_capturePending) {
+        m_capturePending = true;
+        m_captureWindow = window();
+        connect(m_captureWindow, SIGNAL(afterRendering()), this, SLOT(readbackScreen()), Qt::DirectConnection);
+    }
+    window()->update();
+}
+
+// Invoked in the rendering thread right after the scene graph has been rendered
+// and before buffers are swapped.
+void DeclarativeWebContainer::readbackScreen()
+{
+    // sender() is not set for a receiver living in another thread, the window
+    // is taken under the lock so that only the first frame reads back.
+    CaptureRequest request;
+    QQuickWindow *captureWindow = 0;
+    {
+        QMutexLocker lock(&m_captureMutex);
+        captureWindow = m_captureWindow;
+        m_captureWindow = 0;
+        request = m_captureRequest;
+    }
+    if (!captureWindow) {
+        return;
+    }
+    disconnect(captureWindow, SIGNAL(afterRendering()), this, SLOT(readbackScreen()));
+
+    QImage image;
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    const QRect &rect = request.rect;
+    if (context && !rect.isEmpty()) {
+        image = QImage(rect.size(), QImage::Format_RGB32);
+        // Framebuffer origin is at bottom left corner.
+        context->functions()->glReadPixels(rect.x(), request.windowHeight - rect.bottom() - 1,
+                                           rect.width(), rect.height(),
+                                           GL_RGBA, GL_UNSIGNED_BYTE, image.bits());
+    }
+    QMetaObject::invokeMethod(this, "processScreenCapture", Qt::QueuedConnection,
+                              Q_ARG(QImage, image), Q_ARG(CaptureRequest, request));
+}
+
+void DeclarativeWebContainer::processScreenCapture(QImage image, CaptureRequest request)
+{
+    {
+        QMutexLocker lock(&m_captureMutex);
+        m_capturePending = false;
+        if (m_captureRequest.serial != request.serial && window()) {
+            // Requested again after the readback, capture the newer request on the next frame.
+            m_capturePending = true;
+            m_captureWindow = window();
+            connect(m_captureWindow, SIGNAL(afterRendering()), this, SLOT(readbackScreen()), Qt::DirectConnection);
+            window()->update();
+        }
+    }
+
+    bool glReadback = !image.isNull();
+    if (!glReadback) {
+        if (!window()) {
+            return;
+        }
+        // No current GL context available, fallback to grabbing the whole window.
+        image = window()->grabWindow().copy(request.rect);
+    }
 
+    QTransform transform;
+    if (glReadback) {
+        transform.scale(1, -1);
+    }
+    transform *= request.rotation;
+    transform *= QTransform::fromScale(request.scale, request.scale);
+
+    ScreenCapture capture;
+    capture.tabId = request.tabId;
+    capture.url = request.url;
+    capture.image = image;
+    capture.transform = transform;
+    capture.swapRgb = glReadback;
+    queueScreenCapture(capture);
+}
+
+// Asynchronous hash, encode, and save to avoid the slow I/O. Capture waiting for
+// an earlier capture of the same tab is replaced by the newer one.
+void DeclarativeWebContainer::queueScreenCapture(ScreenCapture capture)
+{
+    if (m_capturesInFlight.contains(capture.tabId)) {
 #ifdef DEBUG_LOGS
-    qDebug() << "about to set future";
+        qDebug() << "capture in flight, queue:" << capture.tabId << m_queuedCaptures.contains(capture.tabId);
 #endif
-    // asynchronous save to avoid the slow I/O
-    m_screenCapturer.setFuture(QtConcurrent::run(this, &DeclarativeWebContainer::saveToFile, url, image, cropBounds, m_webPage->tabId(), rotate));
+        m_queuedCaptures.insert(capture.tabId, capture);
+        return;
+    }
+
+    // Earlier capture of the tab has finished, its hash is final.
+    capture.hasPreviousHash = m_capturedContent.contains(capture.tabId);
+    capture.previousHash = m_capturedContent.value(capture.tabId).hash;
+    m_capturesInFlight.insert(capture.tabId);
+    m_captureThreadPool.start(new ScreenCaptureTask(this, capture));
+}
+
+/**
+ * @brief DeclarativeWebContainer::contentHash
+ * Hashes a downsampled grayscale version of the captured region. Differences that
+ * are not visible at the thumbnail size do not change the hash.
+ */
+uint DeclarativeWebContainer::contentHash(const QImage &image, const QTransform &transform)
+{
+    if (image.isNull()) {
+        return 0;
+    }
+
+    // Area averaged 32x32 sample quantized to 32 gray levels.
+    QImage sample = image.scaled(32, 32, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
+            .convertToFormat(QImage::Format_RGB32);
+    QByteArray levels;
+    levels.reserve(sample.width() * sample.height());
+    for (int y = 0; y < sample.height(); ++y) {
+        const QRgb *line = reinterpret_cast<const QRgb *>(sample.constScanLine(y));
+        for (int x = 0; x < sample.width(); ++x) {
+            levels.append(char(qGray(line[x]) >> 3));
+        }
+    }
+
+    // Orientation and scale of the thumbnail are part of the content.
+    uint hash = qHash(levels);
+    hash ^= qHash(image.width()) ^ (qHash(image.height()) << 1);
+    hash ^= qHash(qRound(transform.m11() * 1000)) ^ (qHash(qRound(transform.m12() * 1000)) << 2);
+    return hash;
 }
 
 int DeclarativeWebContainer::parentTabId(int tabId) const
@@ -676,6 +965,29 @@ void DeclarativeWebContainer::releasePage(int tabId, bool virtualize)
     }
 }
 
+void DeclarativeWebContainer::virtualizePage(int tabId)
+{
+    // Page activated meanwhile is scheduled again once it is hidden.
+    if (!m_model || isActiveTab(tabId)) {
+        return;
+    }
+    // Releasing would reset pending new tab data.
+    if (m_model->hasNewTabData()) {
+        m_webPages->postponeVirtualize(tabId);
+        return;
+    }
+    releasePage(tabId, true);
+}
+
+void DeclarativeWebContainer::forgetThumbnail(int tabId)
+{
+    m_capturedContent.remove(tabId);
+    m_queuedCaptures.remove(tabId);
+    if (m_capturesInFlight.contains(tabId)) {
+        m_closedCaptures.insert(tabId);
+    }
+}
+
 void DeclarativeWebContainer::closeWindow()
 {
     DeclarativeWebPage *webPage = qobject_cast<DeclarativeWebPage *>(sender());
@@ -719,15 +1031,17 @@ void DeclarativeWebContainer::onPageTitleChanged()
     }
 }
 
-void DeclarativeWebContainer::onPageThumbnailChanged(QString url, QString path, int tabId)
+void DeclarativeWebContainer::onPageThumbnailChanged(QString url, QString path, QByteArray placeholder, int tabId)
 {
     Q_UNUSED(url);
+    // Thumbnails are served from memory by the tabthumb image provider.
+    QString thumbnailUrl = path.isEmpty() ? QString() : ThumbnailCache::instance()->imageUrl(tabId);
     if (isActiveTab(tabId)) {
-        setThumbnailPath(path);
+        setThumbnailPath(thumbnailUrl);
     }
 
     if (m_model) {
-        m_model->updateThumbnailPath(tabId, isActiveTab(tabId), path);
+        m_model->updateThumbnailPath(tabId, isActiveTab(tabId), thumbnailUrl, placeholder);
     }
 }
 
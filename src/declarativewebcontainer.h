@@ -18,7 +18,11 @@
 #include <QQuickItem>
 #include <QPointer>
 #include <QImage>
-#include <QFutureWatcher>
+#include <QMutex>
+#include <QTransform>
+#include <QHash>
+#include <QSet>
+#include <QThreadPool>
 
 class QTimerEvent;
 class DeclarativeTabModel;
@@ -27,6 +31,18 @@ class DeclarativeWebPage;
 class DeclarativeWebContainer : public QQuickItem {
     Q_OBJECT
 
+    struct CaptureRequest {
+        QString url;
+        int tabId;
+        // Incremented by every capture request, a newer request arms the readback again.
+        int serial;
+        // Region of the window to be read back, in device pixels.
+        QRect rect;
+        int windowHeight;
+        QTransform rotation;
+        qreal scale;
+    };
+
     Q_PROPERTY(DeclarativeWebPage *contentItem READ webPage NOTIFY contentItemChanged FINAL)
     Q_PROPERTY(DeclarativeTabModel *tabModel READ tabModel WRITE setTabModel NOTIFY tabModelChanged FINAL)
     Q_PROPERTY(bool foreground READ foreground WRITE setForeground NOTIFY foregroundChanged FINAL)
@@ -41,6 +57,7 @@ class DeclarativeWebContainer : public QQuickItem {
     Q_PROPERTY(qreal inputPanelOpenHeight MEMBER m_inputPanelOpenHeight NOTIFY inputPanelOpenHeightChanged FINAL)
     Q_PROPERTY(qreal toolbarHeight MEMBER m_toolbarHeight NOTIFY toolbarHeightChanged FINAL)
     Q_PROPERTY(bool background READ background NOTIFY backgroundChanged FINAL)
+    Q_PROPERTY(bool batteryPowered READ batteryPowered WRITE setBatteryPowered NOTIFY batteryPoweredChanged FINAL)
 
     Q_PROPERTY(QString favicon MEMBER m_favicon NOTIFY faviconChanged)
 
@@ -54,6 +71,8 @@ class DeclarativeWebContainer : public QQuickItem {
     Q_PROPERTY(QString title READ title NOTIFY titleChanged FINAL)
     Q_PROPERTY(QString url READ url NOTIFY urlChanged FINAL)
     Q_PROPERTY(QString thumbnailPath READ thumbnailPath NOTIFY thumbnailPathChanged FINAL)
+    // Number of captures that were skipped as the page had not changed since the last thumbnail.
+    Q_PROPERTY(int skippedCaptures READ skippedCaptures NOTIFY skippedCapturesChanged FINAL)
 
     Q_PROPERTY(QQmlComponent* webPageComponent MEMBER m_webPageComponent NOTIFY webPageComponentChanged FINAL)
 
@@ -77,6 +96,9 @@ public:
 
     bool background() const;
 
+    bool batteryPowered() const;
+    void setBatteryPowered(bool batteryPowered);
+
     int loadProgress() const;
     void setLoadProgress(int loadProgress);
 
@@ -97,6 +119,7 @@ public:
     QString title() const;
     QString url() const;
     QString thumbnailPath() const;
+    int skippedCaptures() const;
 
     bool readyToLoad() const;
     void setReadyToLoad(bool readyToLoad);
@@ -116,6 +139,7 @@ signals:
     void pageStackChanged();
     void foregroundChanged();
     void backgroundChanged();
+    void batteryPoweredChanged();
     void activeChanged();
     void maxLiveTabCountChanged();
     void popupActiveChanged();
@@ -136,6 +160,7 @@ signals:
     void titleChanged();
     void urlChanged();
     void thumbnailPathChanged();
+    void skippedCapturesChanged();
 
     void deferredReloadChanged();
     void deferredLoadChanged();
@@ -152,20 +177,27 @@ private slots:
     void imeNotificationChanged(int state, bool open, int cause, int focusChange, const QString& type);
     void windowVisibleChanged(bool visible);
     void handleWindowChanged(QQuickWindow *window);
-    void screenCaptureReady();
+    void readbackScreen();
+    void processScreenCapture(QImage image, CaptureRequest request);
+    void thumbnailReady(int tabId, QByteArray placeholder);
+    void screenCaptureReady(int tabId, QString url, QString path, QByteArray placeholder, uint hash);
+    void screenCaptureSkipped(int tabId, QString url);
     void triggerLoad();
     void onActiveTabChanged(int oldTabId, int activeTabId);
     void onModelLoaded();
     void onDownloadStarted();
+    void updatePageLoading();
     void onNewTabRequested(QString url, QString title, int parentId);
     void onReadyToLoad();
     void manageMaxTabCount();
     void releasePage(int tabId, bool virtualize = false);
+    void virtualizePage(int tabId);
     void closeWindow();
     void onPageUrlChanged();
     void onPageTitleChanged();
-    void onPageThumbnailChanged(QString url, QString path, int tabId);
+    void onPageThumbnailChanged(QString url, QString path, QByteArray placeholder, int tabId);
     void updateThumbnail();
+    void forgetThumbnail(int tabId);
 
     // These are here to inform embedlite-components that keyboard is open or close
     // matching composition metrics.
@@ -184,13 +216,25 @@ private:
 
     struct ScreenCapture {
         int tabId;
-        QString path;
         QString url;
+        QImage image;
+        QTransform transform;
+        bool swapRgb;
+        // Content hash of the latest thumbnail of the tab, set when the capture is started.
+        bool hasPreviousHash;
+        uint previousHash;
+    };
+
+    struct CapturedContent {
+        uint hash;
+        QString url;
+        QByteArray placeholder;
     };
 
-    // Grep following todos
-    // TODO: Remove url parameter from this, worker, and manager.
-    ScreenCapture saveToFile(QString url, QImage image, QRect cropBounds, int tabId, qreal rotate);
+    static QImage renderThumbnail(QImage image, QTransform transform, bool swapRgb);
+    void queueScreenCapture(ScreenCapture capture);
+    void startNextCapture(int tabId);
+    static uint contentHash(const QImage &image, const QTransform &transform);
 
     QPointer<DeclarativeWebPage> m_webPage;
     QPointer<DeclarativeTabModel> m_model;
@@ -200,6 +244,7 @@ private:
     bool m_background;
     bool m_windowVisible;
     int m_backgroundTimer;
+    bool m_batteryPowered;
     bool m_active;
     bool m_popupActive;
     bool m_portrait;
@@ -220,12 +265,28 @@ private:
     bool m_readyToLoad;
     int m_maxLiveTabCount;
 
-    QFutureWatcher<ScreenCapture> m_screenCapturer;
+    // Thumbnails are encoded one at a time in an idle priority thread. At most one
+    // capture per tab is in flight, newer captures of the tab wait in m_queuedCaptures.
+    QThreadPool m_captureThreadPool;
+    QSet<int> m_capturesInFlight;
+    // Tabs closed while their capture was in flight, the capture is dropped once ready.
+    QSet<int> m_closedCaptures;
+    QHash<int, ScreenCapture> m_queuedCaptures;
+    // Guards m_captureRequest that is copied when the window has been rendered.
+    QMutex m_captureMutex;
+    CaptureRequest m_captureRequest;
+    bool m_capturePending;
+    // Window whose afterRendering is connected to readbackScreen, cleared by the first readback.
+    QQuickWindow *m_captureWindow;
+    // Content hash of the latest thumbnail per tab.
+    QHash<int, CapturedContent> m_capturedContent;
+    int m_skippedCaptures;
 
     bool m_deferredReload;
     QVariant m_deferredLoad;
 
     friend class tst_webview;
+    friend class ScreenCaptureTask;
 };
 
 QML_DECLARE_TYPE(DeclarativeWebContainer)
@@ -29,7 +29,9 @@ static DeclarativeWebUtils *gSingleton = 0;
 
 DeclarativeWebUtils::DeclarativeWebUtils() :
     QObject(),
-    m_homePage("http://www.jolla.com")
+    m_homePage("http://www.jolla.com"),
+    m_startupPrefs(QDir::homePath() + profilePath + QStringLiteral("/user.js")),
+    m_startupPrefsSaved(false)
 {
     connect(QMozContext::GetInstance(), SIGNAL(onInitialized()),
             this, SLOT(updateWebEngineSettings()));
@@ -38,6 +40,7 @@ DeclarativeWebUtils::DeclarativeWebUtils() :
 
     QString path = QStandardPaths::writableLocation(QStandardPaths::DataLocation) + QStringLiteral("/.firstUseDone");
     m_firstUseDone = fileExists(path);
+    initStartupPrefs();
 }
 
 DeclarativeWebUtils::~DeclarativeWebUtils()
@@ -45,13 +48,6 @@ DeclarativeWebUtils::~DeclarativeWebUtils()
     gSingleton = 0;
 }
 
-QUrl DeclarativeWebUtils::getFaviconForUrl(QUrl url)
-{
-    QUrl faviconUrl(url);
-    faviconUrl.setPath("/favicon.ico");
-    return faviconUrl;
-}
-
 int DeclarativeWebUtils::getLightness(QColor color) const
 {
     return color.lightness();
@@ -78,7 +74,7 @@ void DeclarativeWebUtils::clearStartupCacheIfNeeded()
     }
 }
 
-void DeclarativeWebUtils::updateWebEngineSettings()
+void DeclarativeWebUtils::initStartupPrefs()
 {
     // Infer and set Accept-Language header from the current system locale
     QString langs;
@@ -89,48 +85,98 @@ void DeclarativeWebUtils::updateWebEngineSettings()
         langs = locale.at(0);
     }
 
-    QMozContext* mozContext = QMozContext::GetInstance();
-    mozContext->setPref(QString("intl.accept_languages"), QVariant(langs));
+    PrefsFile &prefs = m_startupPrefs;
+    prefs.setPref(QString("intl.accept_languages"), QVariant(langs));
 
     // these are magic numbers defining touch radius required to detect <image src=""> touch
-    mozContext->setPref(QString("browser.ui.touch.left"), QVariant(32));
-    mozContext->setPref(QString("browser.ui.touch.right"), QVariant(32));
-    mozContext->setPref(QString("browser.ui.touch.top"), QVariant(48));
-    mozContext->setPref(QString("browser.ui.touch.bottom"), QVariant(16));
+    prefs.setPref(QString("browser.ui.touch.left"), QVariant(32));
+    prefs.setPref(QString("browser.ui.touch.right"), QVariant(32));
+    prefs.setPref(QString("browser.ui.touch.top"), QVariant(48));
+    prefs.setPref(QString("browser.ui.touch.bottom"), QVariant(16));
 
     // Install embedlite handlers for guestures
-    mozContext->setPref(QString("embedlite.azpc.handle.singletap"), QVariant(false));
-    mozContext->setPref(QString("embedlite.azpc.json.singletap"), QVariant(true));
-    mozContext->setPref(QString("embedlite.azpc.handle.longtap"), QVariant(false));
-    mozContext->setPref(QString("embedlite.azpc.json.longtap"), QVariant(true));
-    mozContext->setPref(QString("embedlite.azpc.json.viewport"), QVariant(true));
+    prefs.setPref(QString("embedlite.azpc.handle.singletap"), QVariant(false));
+    prefs.setPref(QString("embedlite.azpc.json.singletap"), QVariant(true));
+    prefs.setPref(QString("embedlite.azpc.handle.longtap"), QVariant(false));
+    prefs.setPref(QString("embedlite.azpc.json.longtap"), QVariant(true));
+    prefs.setPref(QString("embedlite.azpc.json.viewport"), QVariant(true));
 
     // Without this pref placeholders get cleaned as soon as a character gets committed
     // by VKB and that happens only when Enter is pressed or comma/space/dot is entered.
-    mozContext->setPref(QString("dom.placeholder.show_on_focus"), QVariant(false));
+    prefs.setPref(QString("dom.placeholder.show_on_focus"), QVariant(false));
 
-    mozContext->setPref(QString("security.alternate_certificate_error_page"), QString("certerror"));
+    prefs.setPref(QString("security.alternate_certificate_error_page"), QString("certerror"));
 
     // Use autodownload, never ask
-    mozContext->setPref(QString("browser.download.useDownloadDir"), QVariant(true));
+    prefs.setPref(QString("browser.download.useDownloadDir"), QVariant(true));
     // see https://developer.mozilla.org/en-US/docs/Download_Manager_preferences
     // Use custom downloads location defined in browser.download.dir
-    mozContext->setPref(QString("browser.download.folderList"), QVariant(2));
-    mozContext->setPref(QString("browser.download.dir"), downloadDir());
+    prefs.setPref(QString("browser.download.folderList"), QVariant(2));
+    prefs.setPref(QString("browser.download.dir"), downloadDir());
     // Downloads should never be removed automatically
-    mozContext->setPref(QString("browser.download.manager.retention"), QVariant(2));
+    prefs.setPref(QString("browser.download.manager.retention"), QVariant(2));
     // Downloads will be canceled on quit
     // TODO: this doesn't really work. Instead the incomplete downloads get restarted
-    //       on browser launch.
-    mozContext->setPref(QString("browser.download.manager.quitBehavior"), QVariant(2));
+    //       on browser launch. DownloadManager cancels these restarts and resumes
+    //       the downloads from its registry.
+    prefs.setPref(QString("browser.download.manager.quitBehavior"), QVariant(2));
     // TODO: this doesn't really work too
-    mozContext->setPref(QString("browser.helperApps.deleteTempFileOnExit"), QVariant(true));
-    mozContext->setPref(QString("geo.wifi.scan"), QVariant(false));
-    mozContext->setPref(QString("browser.enable_automatic_image_resizing"), QVariant(true));
+    prefs.setPref(QString("browser.helperApps.deleteTempFileOnExit"), QVariant(true));
+    prefs.setPref(QString("geo.wifi.scan"), QVariant(false));
+    prefs.setPref(QString("browser.enable_automatic_image_resizing"), QVariant(true));
 
     // Make long press timeout equal to the one in Qt
-    mozContext->setPref(QString("ui.click_hold_context_menus.delay"), QVariant(800));
-    mozContext->setPref(QString("apz.fling_stopped_threshold"), QString("0.13f"));
+    prefs.setPref(QString("ui.click_hold_context_menus.delay"), QVariant(800));
+    prefs.setPref(QString("apz.fling_stopped_threshold"), QString("0.13f"));
+
+    // Enable internet search
+    prefs.setPref(QString("keyword.enabled"), QVariant(true));
+
+    // Theme.fontSizeSmall
+    prefs.setPref(QString("embedlite.inputItemSize"), QVariant(28));
+    prefs.setPref(QString("embedlite.zoomMargin"), QVariant(14));
+}
+
+/**
+ * @brief DeclarativeWebUtils::startupPrefs
+ * Preferences applied when the engine starts. Add to them before
+ * saveStartupPrefs() is called.
+ */
+PrefsFile *DeclarativeWebUtils::startupPrefs()
+{
+    return &m_startupPrefs;
+}
+
+/**
+ * @brief DeclarativeWebUtils::saveStartupPrefs
+ * Merges the startup preferences to user.js of the profile, call before the
+ * embedding is started.
+ * @return false if the preferences need to be sent once the engine is up.
+ */
+bool DeclarativeWebUtils::saveStartupPrefs()
+{
+    m_startupPrefsSaved = m_startupPrefs.save();
+    return m_startupPrefsSaved;
+}
+
+bool DeclarativeWebUtils::startupPrefsSaved() const
+{
+    return m_startupPrefsSaved;
+}
+
+void DeclarativeWebUtils::updateWebEngineSettings()
+{
+    QMozContext* mozContext = QMozContext::GetInstance();
+
+    // The engine read the startup preferences from user.js, only send them
+    // one by one when the file could not be written.
+    if (!m_startupPrefsSaved) {
+        QMapIterator<QString, QVariant> pref(m_startupPrefs.prefs());
+        while (pref.hasNext()) {
+            pref.next();
+            mozContext->setPref(pref.key(), pref.value());
+        }
+    }
 
     // subscribe to gecko messages
     mozContext->addObservers(QStringList()
@@ -139,15 +185,8 @@ void DeclarativeWebUtils::updateWebEngineSettings()
                              << "embed:download"
                              << "embed:search");
 
-    // Enable internet search
-    mozContext->setPref(QString("keyword.enabled"), QVariant(true));
-
     // Scale up content size
     mozContext->setPixelRatio(1.5);
-
-    // Theme.fontSizeSmall
-    mozContext->setPref(QString("embedlite.inputItemSize"), QVariant(28));
-    mozContext->setPref(QString("embedlite.zoomMargin"), QVariant(14));
 }
 
 void DeclarativeWebUtils::setFirstUseDone(bool firstUseDone) {
@@ -17,6 +17,7 @@
 #include <QColor>
 #include <QVariant>
 #include "browserservice.h"
+#include "prefsfile.h"
 #include <QProcess>
 
 class DeclarativeWebUtils : public QObject
@@ -36,7 +37,10 @@ public:
     bool firstUseDone() const;
     void setFirstUseDone(bool firstUseDone);
 
-    Q_INVOKABLE QUrl getFaviconForUrl(QUrl url);
+    PrefsFile *startupPrefs();
+    bool saveStartupPrefs();
+    bool startupPrefsSaved() const;
+
     Q_INVOKABLE int getLightness(QColor color) const;
     Q_INVOKABLE bool fileExists(QString fileName) const;
     Q_INVOKABLE QString displayableUrl(QString fullUrl) const;
@@ -58,7 +62,11 @@ private:
     explicit DeclarativeWebUtils();
     ~DeclarativeWebUtils();
 
+    void initStartupPrefs();
+
     QString m_homePage;
     bool m_firstUseDone;
+    PrefsFile m_startupPrefs;
+    bool m_startupPrefsSaved;
 };
 #endif // DECLARATIVEWEBUTILS_H
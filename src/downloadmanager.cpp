@@ -11,21 +11,59 @@
 
 #include "downloadmanager.h"
 #include "qmozcontext.h"
+#include "transferprogressthrottle.h"
+#include "downloadresumer.h"
+#include "downloadscheduler.h"
+#include "downloadrestartguard.h"
+#include "dbmanager.h"
+
+#include <QDBusPendingCallWatcher>
+#include <QFile>
+#include <QFileInfo>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QUrl>
 
 #include <transferengineinterface.h>
 #include <transfertypes.h>
 
 static DownloadManager *gSingleton = 0;
 
+// Progress of a download is stored to the registry in steps of this many percents.
+static const int gRegistryProgressStep = 10;
+
+static QString localPath(const QString &path)
+{
+    QUrl url(path);
+    return url.isLocalFile() ? url.toLocalFile() : path;
+}
+
 DownloadManager::DownloadManager()
     : QObject()
+    , m_network(0)
 {
     m_transferClient = new TransferEngineInterface("org.nemo.transferengine",
                                                    "/org/nemo/transferengine",
                                                    QDBusConnection::sessionBus(),
                                                    this);
+    m_progressThrottle = new TransferProgressThrottle(this);
+    connect(m_progressThrottle, SIGNAL(progressChanged(int,qreal)),
+            this, SLOT(updateTransferProgress(int,qreal)));
+    m_scheduler = new DownloadScheduler(this);
+    connect(m_scheduler, SIGNAL(pauseRequested(QString)), this, SLOT(pauseDownload(QString)));
+    connect(m_scheduler, SIGNAL(resumeRequested(QString)), this, SLOT(resumeScheduledDownload(QString)));
+    m_restartGuard = new DownloadRestartGuard(this);
+    connect(m_restartGuard, SIGNAL(cancelRequested(qulonglong)), this, SLOT(cancelDownload(qulonglong)));
+    connect(m_restartGuard, SIGNAL(resumeRequested(QString)), this, SLOT(continueDownload(QString)));
+    connect(QMozContext::GetInstance(), SIGNAL(onInitialized()), m_restartGuard, SLOT(startTimeout()));
     connect(QMozContext::GetInstance(), SIGNAL(recvObserve(const QString, const QVariant)),
             this, SLOT(recvObserve(const QString, const QVariant)));
+
+    DBManager *dbManager = DBManager::instance();
+    connect(dbManager, SIGNAL(downloadsAvailable(QVariantList)),
+            this, SLOT(downloadsAvailable(QVariantList)));
+    dbManager->getDownloads();
 }
 
 DownloadManager::~DownloadManager()
@@ -44,10 +82,56 @@ void DownloadManager::recvObserve(const QString message, const QVariant data)
     QString msg(dataMap.value("msg").toString());
     qulonglong downloadId(dataMap.value("id").toULongLong());
 
+    if (m_restartGuard->isCanceling(downloadId)) {
+        if (msg == "dl-done" || msg == "dl-fail" || msg == "dl-cancel") {
+            m_restartGuard->restartFinished(downloadId);
+        }
+        return;
+    }
+
+    if (m_pendingMessages.contains(downloadId)) {
+        // Replayed once the transfer has been created.
+        m_pendingMessages[downloadId].append(dataMap);
+        return;
+    }
+
     if (msg == "dl-start" && m_download2transferMap.contains(downloadId)) { // restart existing transfer
         m_transferClient->startTransfer(m_download2transferMap.value(downloadId));
-        m_statusCache.insert(downloadId, DownloadStarted);
+        m_activeDownloads.insert(downloadId);
+        QString targetPath(m_downloadPaths.value(downloadId));
+        if (m_registry.contains(targetPath)) {
+            m_registry[targetPath].insert("status", DownloadStarted);
+            DBManager::instance()->saveDownload(m_registry.value(targetPath));
+        }
+        // Retried by the user, or continued by the scheduler in which case this is a no-op.
+        m_scheduler->add(targetPath, 0, false);
     } else if (msg == "dl-start") { // create new transfer
+        QString targetPath(localPath(dataMap.value("targetPath").toString()));
+        DownloadResumer *resumer = this->resumer(targetPath);
+        if (resumer || m_restartGuard->isHeld(targetPath)) {
+            // Gecko restarts downloads that were incomplete when the browser was closed
+            // from the beginning. The browser continues them from where they were left
+            // once Gecko has let go of the file.
+            if (resumer) {
+                resumer->pause();
+            }
+            m_restartGuard->hold(targetPath);
+            m_restartGuard->cancelRestart(downloadId, targetPath);
+            return;
+        }
+
+        QVariantMap download;
+        download.insert("targetPath", targetPath);
+        download.insert("url", dataMap.value("sourceUrl").toString());
+        download.insert("displayName", dataMap.value("displayName").toString());
+        download.insert("mimeType", dataMap.value("mimeType").toString());
+        download.insert("size", dataMap.value("size").toLongLong());
+        download.insert("received", 0);
+        download.insert("status", DownloadStarted);
+        m_registry.insert(targetPath, download);
+        m_downloadPaths.insert(downloadId, targetPath);
+        fetchValidators(targetPath);
+
         emit downloadStarted();
         QStringList callback;
         callback << "org.sailfishos.browser" << "/" << "org.sailfishos.browser";
@@ -60,50 +144,241 @@ void DownloadManager::recvObserve(const QString message, const QVariant data)
                                                                         callback,
                                                                         QString("cancelTransfer"),
                                                                         QString("restartTransfer"));
-        reply.waitForFinished();
-
-        if (reply.isError()) {
-            qWarning() << "DownloadManager::recvObserve: failed to get transfer ID!" << reply.error();
-            return;
-        }
-
-        int transferId(reply.value());
-
-        m_download2transferMap.insert(downloadId, transferId);
-        m_transfer2downloadMap.insert(transferId, downloadId);
-
-        m_transferClient->startTransfer(transferId);
-        m_statusCache.insert(downloadId, DownloadStarted);
+        QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(reply, this);
+        connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)),
+                this, SLOT(transferCreated(QDBusPendingCallWatcher*)));
+        m_pendingTransfers.insert(watcher, downloadId);
+        m_pendingMessages.insert(downloadId, QList<QVariantMap>());
+        m_activeDownloads.insert(downloadId);
+        // Gecko drops what it has received when a download is canceled, thus Gecko
+        // downloads are queued only when they start and are not paused afterwards.
+        m_scheduler->add(targetPath, 0, false);
     } else if (msg == "dl-progress") {
-        qreal progress(dataMap.value("percent").toULongLong() / 100.0);
+        qulonglong percent(dataMap.value("percent").toULongLong());
+        qreal progress(percent / 100.0);
 
-        m_transferClient->updateTransferProgress(m_download2transferMap.value(downloadId),
-                                                 progress);
+        m_progressThrottle->update(m_download2transferMap.value(downloadId), progress);
+
+        QString targetPath(m_downloadPaths.value(downloadId));
+        if (m_registry.contains(targetPath)) {
+            QVariantMap &download = m_registry[targetPath];
+            // Bytes that have reached the file, the resumer continues from these.
+            qint64 received(QFileInfo(targetPath).size());
+            qint64 step(download.value("size").toLongLong() * gRegistryProgressStep / 100);
+            if (step > 0 && received / step != download.value("received").toLongLong() / step) {
+                download.insert("received", received);
+                DBManager::instance()->saveDownload(download);
+            }
+        }
     } else if (msg == "dl-done") {
-        m_transferClient->finishTransfer(m_download2transferMap.value(downloadId),
-                                         TransferEngineData::TransferFinished,
-                                         QString("success"));
-        m_statusCache.insert(downloadId, DownloadDone);
+        finishTransfer(downloadId, TransferEngineData::TransferFinished, QString("success"));
+        forgetDownload(downloadId);
         checkAllTransfers();
     } else if (msg == "dl-fail") {
-        m_transferClient->finishTransfer(m_download2transferMap.value(downloadId),
-                                         TransferEngineData::TransferInterrupted,
-                                         QString("browser failure"));
-        m_statusCache.insert(downloadId, DownloadFailed);
+        finishTransfer(downloadId, TransferEngineData::TransferInterrupted, QString("browser failure"));
+        // Mapping to the transfer is kept for restarting the download.
+        m_activeDownloads.remove(downloadId);
+        QString targetPath(m_downloadPaths.value(downloadId));
+        m_scheduler->remove(targetPath);
+        if (m_registry.contains(targetPath)) {
+            m_registry[targetPath].insert("status", DownloadFailed);
+            DBManager::instance()->saveDownload(m_registry.value(targetPath));
+        }
         checkAllTransfers();
+    } else if (msg == "dl-cancel" && m_queuedDownloads.contains(downloadId)) {
+        // Canceled for waiting its turn in the scheduler.
+        m_activeDownloads.remove(downloadId);
+        if (m_scheduler->isActive(m_downloadPaths.value(downloadId))) {
+            // Its turn came while Gecko was canceling it.
+            m_queuedDownloads.remove(downloadId);
+            sendDownloadMessage(QString("retryDownload"), downloadId);
+        }
     } else if (msg == "dl-cancel") {
-        m_transferClient->finishTransfer(m_download2transferMap.value(downloadId),
-                                         TransferEngineData::TransferCanceled,
-                                         QString("download canceled"));
-        m_statusCache.insert(downloadId, DownloadCanceled);
+        downloadCanceled(downloadId);
+    }
+}
+
+void DownloadManager::transferCreated(QDBusPendingCallWatcher *watcher)
+{
+    watcher->deleteLater();
+    qulonglong downloadId(m_pendingTransfers.take(watcher));
+    QList<QVariantMap> messages(m_pendingMessages.take(downloadId));
+
+    QDBusPendingReply<int> reply = *watcher;
+    if (reply.isError()) {
+        qWarning() << "DownloadManager::transferCreated: failed to get transfer ID!" << reply.error();
+        m_activeDownloads.remove(downloadId);
+        m_queuedDownloads.remove(downloadId);
+        QString targetPath(m_downloadPaths.take(downloadId));
+        m_scheduler->remove(targetPath);
+        m_registry.remove(targetPath);
         checkAllTransfers();
+        return;
+    }
+
+    int transferId(reply.value());
+
+    m_download2transferMap.insert(downloadId, transferId);
+    m_transfer2downloadMap.insert(transferId, downloadId);
+
+    m_transferClient->startTransfer(transferId);
+
+    QString targetPath(m_downloadPaths.value(downloadId));
+    if (m_registry.contains(targetPath)) {
+        m_registry[targetPath].insert("transferId", transferId);
+        DBManager::instance()->saveDownload(m_registry.value(targetPath));
+    }
+
+    foreach (const QVariantMap &dataMap, messages) {
+        recvObserve(QString("embed:download"), dataMap);
+    }
+}
+
+/**
+ * @brief DownloadManager::fetchValidators
+ * Gecko does not tell the ETag or Last-Modified of a download, they are asked
+ * with a HEAD request so that the download can be resumed in a later session.
+ */
+void DownloadManager::fetchValidators(const QString &targetPath)
+{
+    QUrl url(m_registry.value(targetPath).value("url").toString());
+    if (url.scheme() != QLatin1String("http") && url.scheme() != QLatin1String("https")) {
+        return;
+    }
+
+    if (!m_network) {
+        m_network = new QNetworkAccessManager(this);
+    }
+
+    QNetworkRequest request(url);
+    // Same representation as the ranges of DownloadResumer.
+    request.setRawHeader("Accept-Encoding", "identity");
+    QNetworkReply *reply = m_network->head(request);
+    reply->setProperty("targetPath", targetPath);
+    connect(reply, SIGNAL(finished()), this, SLOT(validatorsFetched()));
+}
+
+void DownloadManager::validatorsFetched()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    if (!reply) {
+        return;
+    }
+
+    reply->deleteLater();
+    QString targetPath(reply->property("targetPath").toString());
+    int status(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt());
+    if (reply->error() != QNetworkReply::NoError || status != 200 || !m_registry.contains(targetPath)) {
+        return;
+    }
+
+    QVariantMap &download = m_registry[targetPath];
+    if (QUrl(download.value("url").toString()) != reply->url()) {
+        // Target path has been reused by another download meanwhile.
+        return;
+    }
+    download.insert("etag", QString::fromLatin1(reply->rawHeader("ETag")));
+    download.insert("lastModified", QString::fromLatin1(reply->rawHeader("Last-Modified")));
+    DBManager::instance()->saveDownload(download);
+}
+
+void DownloadManager::updateTransferProgress(int transferId, qreal progress)
+{
+    m_transferClient->updateTransferProgress(transferId, progress);
+}
+
+/**
+ * @brief DownloadManager::downloadsAvailable
+ * Continues downloads that were in progress when the browser was closed.
+ * Failed and canceled downloads are kept so that they can be restarted from the transfer UI.
+ */
+void DownloadManager::downloadsAvailable(QVariantList downloads)
+{
+    foreach (const QVariant &item, downloads) {
+        QVariantMap download(item.toMap());
+        QString targetPath(download.value("targetPath").toString());
+        if (m_registry.contains(targetPath)) {
+            // Started during this session already.
+            continue;
+        }
+
+        m_registry.insert(targetPath, download);
+        if (download.value("status").toInt() == DownloadStarted) {
+            // Continued once Gecko's restart of the download has been canceled.
+            m_restartGuard->hold(targetPath);
+        }
+    }
+
+    if (m_restartGuard->hasHeld() && QMozContext::GetInstance()->initialized()) {
+        m_restartGuard->startTimeout();
     }
 }
 
+void DownloadManager::resumeProgress(qint64 received, qint64 size)
+{
+    DownloadResumer *resumer = qobject_cast<DownloadResumer *>(sender());
+    if (!resumer) {
+        return;
+    }
+
+    int transferId(m_resumers.key(resumer));
+    if (size > 0) {
+        m_progressThrottle->update(transferId, qreal(received) / size);
+    }
+
+    QVariantMap &download = m_registry[resumer->targetPath()];
+    qint64 step(size > 0 ? size * gRegistryProgressStep / 100 : 0);
+    if (step > 0 && received / step != download.value("received").toLongLong() / step) {
+        download.insert("received", received);
+        download.insert("size", size);
+        download.insert("etag", resumer->etag());
+        download.insert("lastModified", resumer->lastModified());
+        DBManager::instance()->saveDownload(download);
+    }
+}
+
+void DownloadManager::resumeFinished(bool success)
+{
+    DownloadResumer *resumer = qobject_cast<DownloadResumer *>(sender());
+    if (!resumer) {
+        return;
+    }
+
+    int transferId(m_resumers.key(resumer));
+    m_resumers.remove(transferId);
+    resumer->deleteLater();
+    m_progressThrottle->finish(transferId);
+
+    QString targetPath(resumer->targetPath());
+    m_scheduler->remove(targetPath);
+    if (success) {
+        m_transferClient->finishTransfer(transferId, TransferEngineData::TransferFinished, QString("success"));
+        removeDownload(targetPath);
+    } else {
+        m_transferClient->finishTransfer(transferId, TransferEngineData::TransferInterrupted, QString("network failure"));
+        // What was received is kept for restarting the transfer.
+        QVariantMap &download = m_registry[targetPath];
+        download.insert("received", resumer->received());
+        download.insert("etag", resumer->etag());
+        download.insert("lastModified", resumer->lastModified());
+        download.insert("status", DownloadFailed);
+        DBManager::instance()->saveDownload(download);
+    }
+    checkAllTransfers();
+}
+
 void DownloadManager::cancelActiveTransfers()
 {
-    foreach (qulonglong downloadId, m_statusCache.keys()) {
-        if (m_statusCache.value(downloadId) == DownloadStarted) {
+    foreach (int transferId, m_resumers.keys()) {
+        cancelTransfer(transferId);
+    }
+
+    foreach (qulonglong downloadId, m_activeDownloads + m_queuedDownloads) {
+        if (m_pendingMessages.contains(downloadId)) {
+            // No transfer yet, dl-cancel is queued until it has been created.
+            m_queuedDownloads.remove(downloadId);
+            cancelDownload(downloadId);
+        } else {
             cancelTransfer(m_download2transferMap.value(downloadId));
         }
     }
@@ -111,11 +386,32 @@ void DownloadManager::cancelActiveTransfers()
 
 void DownloadManager::cancelTransfer(int transferId)
 {
+    QString targetPath(registryPath(transferId));
     if (m_transfer2downloadMap.contains(transferId)) {
-        QVariantMap data;
-        data.insert("msg", "cancelDownload");
-        data.insert("id", m_transfer2downloadMap.value(transferId));
-        QMozContext::GetInstance()->sendObserve(QString("embedui:download"), QVariant(data));
+        qulonglong downloadId(m_transfer2downloadMap.value(transferId));
+        if (m_queuedDownloads.remove(downloadId) && !m_activeDownloads.contains(downloadId)) {
+            // Already canceled in Gecko while waiting in the scheduler.
+            downloadCanceled(downloadId);
+        } else {
+            cancelDownload(downloadId);
+        }
+    } else if (!targetPath.isEmpty()) {
+        // Download of an earlier session, either being resumed or failed.
+        DownloadResumer *resumer = m_resumers.take(transferId);
+        if (resumer) {
+            resumer->disconnect(this);
+            resumer->abort();
+            resumer->deleteLater();
+        }
+        m_progressThrottle->finish(transferId);
+        m_scheduler->remove(targetPath);
+        m_restartGuard->discard(targetPath);
+        m_transferClient->finishTransfer(transferId,
+                                         TransferEngineData::TransferCanceled,
+                                         QString("download canceled"));
+        QFile::remove(targetPath);
+        removeDownload(targetPath);
+        checkAllTransfers();
     } else {
         m_transferClient->finishTransfer(transferId,
                                          TransferEngineData::TransferInterrupted,
@@ -126,10 +422,12 @@ void DownloadManager::cancelTransfer(int transferId)
 void DownloadManager::restartTransfer(int transferId)
 {
     if (m_transfer2downloadMap.contains(transferId)) {
-        QVariantMap data;
-        data.insert("msg", "retryDownload");
-        data.insert("id", m_transfer2downloadMap.value(transferId));
-        QMozContext::GetInstance()->sendObserve(QString("embedui:download"), QVariant(data));
+        sendDownloadMessage(QString("retryDownload"), m_transfer2downloadMap.value(transferId));
+    } else if (!registryPath(transferId).isEmpty()) {
+        QString targetPath(registryPath(transferId));
+        if (!m_restartGuard->isHeld(targetPath)) {
+            resumeDownload(targetPath);
+        }
     } else {
         m_transferClient->finishTransfer(transferId,
                                          TransferEngineData::TransferInterrupted,
@@ -145,17 +443,15 @@ DownloadManager *DownloadManager::instance()
     return gSingleton;
 }
 
-bool DownloadManager::existActiveTransfers()
+void DownloadManager::setPageLoading(bool loading)
 {
-    bool exists(false);
+    m_scheduler->setPageLoading(loading);
+}
 
-    foreach (Status st, m_statusCache) {
-        if (st == DownloadStarted) {
-            exists = true;
-            break;
-        }
-    }
-    return exists;
+bool DownloadManager::existActiveTransfers()
+{
+    return !m_activeDownloads.isEmpty() || !m_queuedDownloads.isEmpty()
+            || !m_resumers.isEmpty() || m_restartGuard->hasHeld();
 }
 
 void DownloadManager::checkAllTransfers()
@@ -164,3 +460,146 @@ void DownloadManager::checkAllTransfers()
         emit allTransfersCompleted();
     }
 }
+
+// Drops a completed download from the session state and the registry.
+void DownloadManager::forgetDownload(qulonglong downloadId)
+{
+    m_activeDownloads.remove(downloadId);
+    int transferId(m_download2transferMap.take(downloadId));
+    m_transfer2downloadMap.remove(transferId);
+    QString targetPath(m_downloadPaths.take(downloadId));
+    m_scheduler->remove(targetPath);
+    removeDownload(targetPath);
+}
+
+// Canceled download is kept like a failed one so that it can be restarted from the transfer UI.
+void DownloadManager::downloadCanceled(qulonglong downloadId)
+{
+    finishTransfer(downloadId, TransferEngineData::TransferCanceled, QString("download canceled"));
+    m_activeDownloads.remove(downloadId);
+    QString targetPath(m_downloadPaths.value(downloadId));
+    m_scheduler->remove(targetPath);
+    if (m_registry.contains(targetPath)) {
+        m_registry[targetPath].insert("status", DownloadCanceled);
+        DBManager::instance()->saveDownload(m_registry.value(targetPath));
+    }
+    checkAllTransfers();
+}
+
+void DownloadManager::finishTransfer(qulonglong downloadId, int status, QString reason)
+{
+    int transferId(m_download2transferMap.value(downloadId));
+    // Progress held back by the throttle must reach the transfer engine before the final state.
+    m_progressThrottle->finish(transferId);
+    m_transferClient->finishTransfer(transferId, status, reason);
+}
+
+void DownloadManager::cancelDownload(qulonglong downloadId)
+{
+    sendDownloadMessage(QString("cancelDownload"), downloadId);
+}
+
+void DownloadManager::sendDownloadMessage(const QString &msg, qulonglong downloadId)
+{
+    QVariantMap data;
+    data.insert("msg", msg);
+    data.insert("id", downloadId);
+    QMozContext::GetInstance()->sendObserve(QString("embedui:download"), QVariant(data));
+}
+
+void DownloadManager::resumeDownload(const QString &targetPath)
+{
+    QVariantMap &download = m_registry[targetPath];
+    int transferId(download.value("transferId").toInt());
+    if (transferId <= 0 || m_resumers.contains(transferId)) {
+        return;
+    }
+
+    if (!m_network) {
+        m_network = new QNetworkAccessManager(this);
+    }
+
+    DownloadResumer *resumer = new DownloadResumer(QUrl(download.value("url").toString()), targetPath, m_network, this);
+    resumer->setExpectedSize(download.value("size").toLongLong());
+    resumer->setValidators(download.value("etag").toString(), download.value("lastModified").toString());
+    connect(resumer, SIGNAL(progress(qint64,qint64)), this, SLOT(resumeProgress(qint64,qint64)));
+    connect(resumer, SIGNAL(finished(bool)), this, SLOT(resumeFinished(bool)));
+    m_resumers.insert(transferId, resumer);
+
+    download.insert("status", DownloadStarted);
+    DBManager::instance()->saveDownload(download);
+
+    m_transferClient->startTransfer(transferId);
+    m_scheduler->add(targetPath);
+    if (m_scheduler->isActive(targetPath)) {
+        resumer->start();
+    }
+}
+
+void DownloadManager::continueDownload(QString targetPath)
+{
+    DownloadResumer *resumer = this->resumer(targetPath);
+    if (!resumer) {
+        resumeDownload(targetPath);
+    } else if (m_scheduler->isActive(targetPath)) {
+        resumer->start();
+    }
+}
+
+/**
+ * @brief DownloadManager::pauseDownload
+ * Gecko cannot pause a download, a Gecko download over the limit is canceled
+ * and retried once the scheduler lets it run.
+ */
+void DownloadManager::pauseDownload(QString targetPath)
+{
+    DownloadResumer *resumer = this->resumer(targetPath);
+    qulonglong downloadId(m_downloadPaths.key(targetPath));
+    if (resumer) {
+        resumer->pause();
+    } else if (downloadId && !m_queuedDownloads.contains(downloadId)) {
+        m_queuedDownloads.insert(downloadId);
+        cancelDownload(downloadId);
+    }
+}
+
+void DownloadManager::resumeScheduledDownload(QString targetPath)
+{
+    DownloadResumer *resumer = this->resumer(targetPath);
+    qulonglong downloadId(m_downloadPaths.key(targetPath));
+    if (resumer && !m_restartGuard->isHeld(targetPath)) {
+        resumer->start();
+    } else if (m_queuedDownloads.contains(downloadId) && !m_activeDownloads.contains(downloadId)) {
+        // Retried once Gecko has canceled it otherwise, see dl-cancel.
+        m_queuedDownloads.remove(downloadId);
+        sendDownloadMessage(QString("retryDownload"), downloadId);
+    }
+}
+
+void DownloadManager::removeDownload(const QString &targetPath)
+{
+    if (m_registry.remove(targetPath)) {
+        DBManager::instance()->removeDownload(targetPath);
+    }
+}
+
+DownloadResumer *DownloadManager::resumer(const QString &targetPath) const
+{
+    foreach (DownloadResumer *resumer, m_resumers) {
+        if (resumer->targetPath() == targetPath) {
+            return resumer;
+        }
+    }
+    return 0;
+}
+
+QString DownloadManager::registryPath(int transferId) const
+{
+    QHash<QString, QVariantMap>::const_iterator it;
+    for (it = m_registry.constBegin(); it != m_registry.constEnd(); ++it) {
+        if (it->value("transferId").toInt() == transferId) {
+            return it.key();
+        }
+    }
+    return QString();
+}
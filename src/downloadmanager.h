@@ -14,10 +14,17 @@
 
 #include <QObject>
 #include <QHash>
+#include <QSet>
 #include <QString>
 #include <QVariant>
 
 class TransferEngineInterface;
+class QDBusPendingCallWatcher;
+class QNetworkAccessManager;
+class TransferProgressThrottle;
+class DownloadResumer;
+class DownloadScheduler;
+class DownloadRestartGuard;
 
 class DownloadManager : public QObject
 {
@@ -34,11 +41,24 @@ signals:
 
 public slots:
     void cancelActiveTransfers();
+    // Downloads continued by the browser are held back while a page is loading in the foreground,
+    // Gecko downloads that start meanwhile wait for the load to finish.
+    void setPageLoading(bool loading);
 
 private slots:
     void recvObserve(const QString message, const QVariant data);
+    void updateTransferProgress(int transferId, qreal progress);
+    void transferCreated(QDBusPendingCallWatcher *watcher);
+    void validatorsFetched();
+    void downloadsAvailable(QVariantList downloads);
+    void resumeProgress(qint64 received, qint64 size);
+    void resumeFinished(bool success);
+    void continueDownload(QString targetPath);
+    void pauseDownload(QString targetPath);
+    void resumeScheduledDownload(QString targetPath);
     void cancelTransfer(int transferId);
     void restartTransfer(int transferId);
+    void cancelDownload(qulonglong downloadId);
 
 private:
     explicit DownloadManager();
@@ -52,15 +72,43 @@ private:
     };
 
     void checkAllTransfers();
-
-    // TODO: unlike Gecko downloads and Sailfish transfers these mappings
-    //       are not persistent -> after user has browser closed transfers can't be
-    //       restarted.
+    void finishTransfer(qulonglong downloadId, int status, QString reason);
+    void forgetDownload(qulonglong downloadId);
+    void downloadCanceled(qulonglong downloadId);
+    void sendDownloadMessage(const QString &msg, qulonglong downloadId);
+    void fetchValidators(const QString &targetPath);
+    void resumeDownload(const QString &targetPath);
+    void removeDownload(const QString &targetPath);
+    DownloadResumer *resumer(const QString &targetPath) const;
+    QString registryPath(int transferId) const;
+
+    // Gecko download ids are valid for one session only. Downloads that outlive
+    // the session are found from m_registry by their target path.
     QHash<qulonglong, int> m_download2transferMap;
     QHash<int, qulonglong> m_transfer2downloadMap;
-    QHash<qulonglong, Status> m_statusCache;
+    // Gecko downloads that are running or waiting for their transfer. Terminal
+    // states are not kept, failed and canceled downloads stay in the transfer
+    // mappings only.
+    QSet<qulonglong> m_activeDownloads;
+    // Gecko downloads canceled by the scheduler, retried when it is their turn.
+    QSet<qulonglong> m_queuedDownloads;
+    // Downloads whose transfer is being created. Messages received for them
+    // are queued until the transfer id is known.
+    QHash<QDBusPendingCallWatcher *, qulonglong> m_pendingTransfers;
+    QHash<qulonglong, QList<QVariantMap> > m_pendingMessages;
+
+    // Persistent download registry by target path, mirrors the download table.
+    QHash<QString, QVariantMap> m_registry;
+    QHash<qulonglong, QString> m_downloadPaths;
+    // Downloads of earlier sessions continued by the browser, by transfer id.
+    QHash<int, DownloadResumer *> m_resumers;
+    // Downloads of earlier sessions wait for Gecko's restarts to be canceled.
+    DownloadRestartGuard *m_restartGuard;
+    QNetworkAccessManager *m_network;
+    DownloadScheduler *m_scheduler;
 
     TransferEngineInterface *m_transferClient;
+    TransferProgressThrottle *m_progressThrottle;
 };
 
 #endif
@@ -0,0 +1,165 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "downloadrestartguard.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QTimerEvent>
+
+// Gecko restarts interrupted downloads soon after the engine has been initialized.
+static const int gRestartTimeout = 10000;
+
+DownloadRestartGuard::DownloadRestartGuard(QObject *parent)
+    : QObject(parent)
+    , m_timeout(gRestartTimeout)
+    , m_timer(0)
+{
+}
+
+int DownloadRestartGuard::timeout() const
+{
+    return m_timeout;
+}
+
+void DownloadRestartGuard::setTimeout(int timeout)
+{
+    m_timeout = timeout;
+}
+
+/**
+ * @brief DownloadRestartGuard::hold
+ * Moves the partial file of a download of an earlier session aside until
+ * Gecko's restart of it has been canceled.
+ */
+void DownloadRestartGuard::hold(const QString &targetPath)
+{
+    if (m_held.contains(targetPath)) {
+        return;
+    }
+
+    QString partial(partialPath(targetPath));
+    if (QFile::exists(targetPath)) {
+        QFile::remove(partial);
+        if (!QFile::rename(targetPath, partial)) {
+            qWarning() << Q_FUNC_INFO << "failed to move aside" << targetPath;
+        }
+    }
+    m_held.insert(targetPath);
+}
+
+/**
+ * @brief DownloadRestartGuard::discard
+ * Forgets a held download and removes its partial file.
+ */
+void DownloadRestartGuard::discard(const QString &targetPath)
+{
+    if (m_held.remove(targetPath)) {
+        QFile::remove(partialPath(targetPath));
+    }
+}
+
+bool DownloadRestartGuard::isHeld(const QString &targetPath) const
+{
+    return m_held.contains(targetPath);
+}
+
+bool DownloadRestartGuard::hasHeld() const
+{
+    return !m_held.isEmpty();
+}
+
+/**
+ * @brief DownloadRestartGuard::cancelRestart
+ * Asks Gecko to cancel its restart of a download continued by the browser.
+ * The browser may write the file again once restartFinished has been called.
+ */
+void DownloadRestartGuard::cancelRestart(qulonglong downloadId, const QString &targetPath)
+{
+    m_canceling.insert(downloadId, targetPath);
+    emit cancelRequested(downloadId);
+}
+
+bool DownloadRestartGuard::isCanceling(qulonglong downloadId) const
+{
+    return m_canceling.contains(downloadId);
+}
+
+/**
+ * @brief DownloadRestartGuard::restartFinished
+ * Gecko has stopped the restarted download, with dl-cancel normally. Whatever
+ * Gecko left in the target path gives way to the partial file.
+ */
+void DownloadRestartGuard::restartFinished(qulonglong downloadId)
+{
+    if (!m_canceling.contains(downloadId)) {
+        return;
+    }
+
+    QString targetPath(m_canceling.take(downloadId));
+    if (m_held.contains(targetPath)) {
+        release(targetPath);
+    } else {
+        emit resumeRequested(targetPath);
+    }
+}
+
+QString DownloadRestartGuard::partialPath(const QString &targetPath)
+{
+    return targetPath + QLatin1String(".part");
+}
+
+/**
+ * @brief DownloadRestartGuard::startTimeout
+ * Starts waiting for Gecko's restarts, downloads that Gecko has not restarted
+ * by the timeout are released.
+ */
+void DownloadRestartGuard::startTimeout()
+{
+    if (m_timer) {
+        killTimer(m_timer);
+    }
+    m_timer = startTimer(m_timeout);
+}
+
+void DownloadRestartGuard::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() != m_timer) {
+        return;
+    }
+
+    killTimer(m_timer);
+    m_timer = 0;
+
+    QList<QString> canceling(m_canceling.values());
+    foreach (const QString &targetPath, m_held.toList()) {
+        if (!canceling.contains(targetPath)) {
+            release(targetPath);
+        }
+    }
+}
+
+void DownloadRestartGuard::release(const QString &targetPath)
+{
+    m_held.remove(targetPath);
+
+    QString partial(partialPath(targetPath));
+    if (QFile::exists(partial)) {
+        QFile::remove(targetPath);
+        if (!QFile::rename(partial, targetPath)) {
+            qWarning() << Q_FUNC_INFO << "failed to restore" << targetPath;
+        }
+    }
+#ifdef DEBUG_LOGS
+    qDebug() << "release download:" << targetPath;
+#endif
+    emit resumeRequested(targetPath);
+}
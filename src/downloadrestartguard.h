@@ -0,0 +1,71 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef DOWNLOADRESTARTGUARD_H
+#define DOWNLOADRESTARTGUARD_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QString>
+
+class QTimerEvent;
+
+/**
+ * Keeps Gecko and the browser from writing the same file. Gecko restarts the
+ * downloads that were incomplete when the browser was closed from the first
+ * byte and deletes the file when the restart is canceled. Partial files of
+ * held downloads are moved aside until Gecko's restart has been canceled, or
+ * until the timeout has passed without a restart, and resumeRequested tells
+ * when the browser may continue writing the file.
+ */
+class DownloadRestartGuard : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DownloadRestartGuard(QObject *parent = 0);
+
+    int timeout() const;
+    void setTimeout(int timeout);
+
+    void hold(const QString &targetPath);
+    void discard(const QString &targetPath);
+    bool isHeld(const QString &targetPath) const;
+    bool hasHeld() const;
+
+    void cancelRestart(qulonglong downloadId, const QString &targetPath);
+    bool isCanceling(qulonglong downloadId) const;
+    void restartFinished(qulonglong downloadId);
+
+    static QString partialPath(const QString &targetPath);
+
+public slots:
+    void startTimeout();
+
+signals:
+    void cancelRequested(qulonglong downloadId);
+    void resumeRequested(QString targetPath);
+
+protected:
+    void timerEvent(QTimerEvent *event);
+
+private:
+    void release(const QString &targetPath);
+
+    QSet<QString> m_held;
+    // Gecko restarts whose dl-cancel has not arrived yet, by download id.
+    QHash<qulonglong, QString> m_canceling;
+    int m_timeout;
+    int m_timer;
+};
+
+#endif // DOWNLOADRESTARTGUARD_H
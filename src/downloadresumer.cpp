@@ -0,0 +1,440 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "downloadresumer.h"
+
+#include <QDebug>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QRegExp>
+#include <QTimerEvent>
+
+static const int gMaxRedirects = 3;
+// Bandwidth limited downloads read from the network in slices of this many milliseconds.
+static const int gThrottleInterval = 100;
+
+DownloadResumer::DownloadResumer(const QUrl &url, const QString &targetPath, QNetworkAccessManager *network, QObject *parent)
+    : QObject(parent)
+    , m_url(url)
+    , m_file(targetPath)
+    , m_network(network)
+    , m_offset(0)
+    , m_resumedFrom(0)
+    , m_size(-1)
+    , m_redirects(0)
+    , m_accepted(false)
+    , m_restart(false)
+    , m_aborted(false)
+    , m_paused(false)
+    , m_completing(false)
+    , m_bandwidthLimit(0)
+    , m_budget(0)
+    , m_throttleTimer(0)
+{
+}
+
+void DownloadResumer::setExpectedSize(qint64 size)
+{
+    m_size = size > 0 ? size : -1;
+}
+
+void DownloadResumer::setValidators(const QString &etag, const QString &lastModified)
+{
+    m_etag = etag;
+    m_lastModified = lastModified;
+}
+
+/**
+ * @brief DownloadResumer::setBandwidthLimit
+ * Limits the download rate to bytesPerSecond, 0 for no limit. Takes effect on
+ * the next request.
+ */
+void DownloadResumer::setBandwidthLimit(qint64 bytesPerSecond)
+{
+    m_bandwidthLimit = qMax(qint64(0), bytesPerSecond);
+}
+
+qint64 DownloadResumer::bandwidthLimit() const
+{
+    return m_bandwidthLimit;
+}
+
+QUrl DownloadResumer::url() const
+{
+    return m_url;
+}
+
+QString DownloadResumer::targetPath() const
+{
+    return m_file.fileName();
+}
+
+QString DownloadResumer::etag() const
+{
+    return m_etag;
+}
+
+QString DownloadResumer::lastModified() const
+{
+    return m_lastModified;
+}
+
+qint64 DownloadResumer::received() const
+{
+    return m_offset;
+}
+
+qint64 DownloadResumer::size() const
+{
+    return m_size;
+}
+
+qint64 DownloadResumer::resumedFrom() const
+{
+    return m_resumedFrom;
+}
+
+bool DownloadResumer::isPaused() const
+{
+    return m_paused;
+}
+
+void DownloadResumer::start()
+{
+    if (m_reply || m_completing) {
+        return;
+    }
+
+    m_aborted = false;
+    m_paused = false;
+    m_redirects = 0;
+    // Opened again, the file may have been replaced while the download was paused.
+    m_file.close();
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        qWarning() << Q_FUNC_INFO << "failed to open" << m_file.fileName() << m_file.errorString();
+        emit finished(false);
+        return;
+    }
+
+    m_offset = m_file.size();
+    // Same size does not prove the same content, a range is requested only with a validator.
+    if (ifRange().isEmpty() || (m_size > 0 && m_offset > m_size)) {
+        m_offset = 0;
+    }
+    if (m_offset == 0) {
+        m_file.resize(0);
+    }
+    m_file.seek(m_offset);
+
+#ifdef DEBUG_LOGS
+    qDebug() << "resume download:" << m_url << m_file.fileName() << "from:" << m_offset << "size:" << m_size;
+#endif
+    request();
+}
+
+void DownloadResumer::abort()
+{
+    m_aborted = true;
+    if (m_reply) {
+        m_reply->abort();
+    } else if (m_completing) {
+        finish(false);
+    }
+}
+
+/**
+ * @brief DownloadResumer::pause
+ * Stops transferring data without finishing the download. start() continues
+ * from what has been written to the file.
+ */
+void DownloadResumer::pause()
+{
+    if (!m_reply) {
+        return;
+    }
+
+    m_paused = true;
+    m_reply->abort();
+}
+
+void DownloadResumer::metaDataChanged()
+{
+    if (sender() != m_reply || m_accepted
+            || m_reply->attribute(QNetworkRequest::RedirectionTargetAttribute).isValid()) {
+        return;
+    }
+
+    int status = m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status == 206) {
+        QRegExp contentRange("^bytes (\\d+)-(\\d+)/(\\d+|\\*)$");
+        qint64 total = -1;
+        bool valid = contentRange.indexIn(QString::fromLatin1(m_reply->rawHeader("Content-Range"))) == 0
+                && contentRange.cap(1).toLongLong() == m_offset;
+        if (valid && contentRange.cap(3) != QLatin1String("*")) {
+            total = contentRange.cap(3).toLongLong();
+        }
+        if (!valid) {
+            restart();
+            return;
+        }
+        if (total > 0) {
+            m_size = total;
+        }
+    } else if (status == 200) {
+        // Range was not honored or the resource has changed, the whole resource follows.
+        m_offset = 0;
+        m_file.resize(0);
+        m_file.seek(0);
+        qint64 length = m_reply->header(QNetworkRequest::ContentLengthHeader).toLongLong();
+        m_size = length > 0 ? length : -1;
+    } else {
+        // Errors are handled once the reply has finished.
+        return;
+    }
+
+    QByteArray etag = m_reply->rawHeader("ETag");
+    if (!etag.isEmpty()) {
+        m_etag = QString::fromLatin1(etag);
+    }
+    QByteArray lastModified = m_reply->rawHeader("Last-Modified");
+    if (!lastModified.isEmpty()) {
+        m_lastModified = QString::fromLatin1(lastModified);
+    }
+    m_accepted = true;
+}
+
+void DownloadResumer::readyRead()
+{
+    if (sender() == m_reply) {
+        write(m_reply);
+    }
+}
+
+void DownloadResumer::replyFinished()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    if (!reply) {
+        return;
+    }
+    reply->deleteLater();
+    if (reply != m_reply) {
+        return;
+    }
+    m_reply = 0;
+
+    if (m_paused && !m_aborted) {
+        m_file.close();
+        return;
+    }
+
+    if (m_restart && !m_aborted) {
+        m_etag.clear();
+        m_lastModified.clear();
+        m_offset = 0;
+        m_file.resize(0);
+        m_file.seek(0);
+        request();
+        return;
+    }
+
+    if (m_aborted) {
+        finish(false);
+        return;
+    }
+
+    QUrl redirect = reply->attribute(QNetworkRequest::RedirectionTargetAttribute).toUrl();
+    if (reply->error() == QNetworkReply::NoError && redirect.isValid()) {
+        if (m_redirects < gMaxRedirects) {
+            ++m_redirects;
+            m_url = reply->url().resolved(redirect);
+            request();
+        } else {
+            qWarning() << Q_FUNC_INFO << "too many redirects" << m_url;
+            finish(false);
+        }
+        return;
+    }
+
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status == 416) {
+        // Nothing after the offset, the file is complete if it has the size of the resource.
+        QRegExp contentRange("^bytes \\*/(\\d+)$");
+        if (contentRange.indexIn(QString::fromLatin1(reply->rawHeader("Content-Range"))) == 0) {
+            m_size = contentRange.cap(1).toLongLong();
+        }
+        if (m_size > 0 && m_offset == m_size) {
+            finish(true);
+        } else if (m_resumedFrom == 0) {
+            finish(false);
+        } else {
+            restart();
+        }
+        return;
+    }
+
+    if (reply->error() != QNetworkReply::NoError || !m_accepted) {
+        qWarning() << Q_FUNC_INFO << "download failed" << m_url << status << reply->errorString();
+        finish(false);
+        return;
+    }
+
+    // Whatever the bandwidth limit has held back is written before finishing.
+    m_tail = reply->readAll();
+    writeTail();
+}
+
+void DownloadResumer::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() != m_throttleTimer) {
+        return;
+    }
+
+    m_budget = m_bandwidthLimit * gThrottleInterval / 1000;
+    if (m_reply) {
+        write(m_reply);
+    } else if (m_completing) {
+        writeTail();
+    } else {
+        killTimer(m_throttleTimer);
+        m_throttleTimer = 0;
+    }
+}
+
+bool DownloadResumer::write(QNetworkReply *reply)
+{
+    if (!m_accepted) {
+        return true;
+    }
+
+    qint64 length = reply->bytesAvailable();
+    if (m_bandwidthLimit > 0) {
+        length = qMin(length, m_budget);
+        if (!m_throttleTimer) {
+            m_throttleTimer = startTimer(gThrottleInterval);
+        }
+    }
+    if (length <= 0) {
+        return true;
+    }
+
+    QByteArray data = reply->read(length);
+    m_budget -= data.size();
+    if (!append(data)) {
+        abort();
+        return false;
+    }
+    return true;
+}
+
+void DownloadResumer::writeTail()
+{
+    qint64 length = m_tail.size();
+    if (m_bandwidthLimit > 0) {
+        length = qMin(length, m_budget);
+    }
+    if (length > 0) {
+        if (!append(m_tail.left(length))) {
+            finish(false);
+            return;
+        }
+        m_tail.remove(0, length);
+        m_budget -= length;
+    }
+
+    if (m_tail.isEmpty()) {
+        finish(m_size < 0 || m_offset == m_size);
+    } else {
+        m_completing = true;
+        if (!m_throttleTimer) {
+            m_throttleTimer = startTimer(gThrottleInterval);
+        }
+    }
+}
+
+bool DownloadResumer::append(const QByteArray &data)
+{
+    if (m_file.write(data) != data.size()) {
+        qWarning() << Q_FUNC_INFO << "failed to write" << m_file.fileName() << m_file.errorString();
+        return false;
+    }
+    m_offset += data.size();
+    emit progress(m_offset, m_size);
+    return true;
+}
+
+QByteArray DownloadResumer::ifRange() const
+{
+    // Weak entity tags can't be used with If-Range.
+    if (!m_etag.isEmpty() && !m_etag.startsWith(QLatin1String("W/"))) {
+        return m_etag.toLatin1();
+    }
+    return m_lastModified.toLatin1();
+}
+
+void DownloadResumer::request()
+{
+    m_accepted = false;
+    m_restart = false;
+    m_resumedFrom = m_offset;
+
+    QNetworkRequest request(m_url);
+    // Ranges refer to the bytes of the entity as it is sent, ask for it without encoding.
+    request.setRawHeader("Accept-Encoding", "identity");
+    if (m_offset > 0) {
+        request.setRawHeader("Range", QString("bytes=%1-").arg(m_offset).toLatin1());
+        QByteArray validator = ifRange();
+        if (!validator.isEmpty()) {
+            request.setRawHeader("If-Range", validator);
+        }
+    }
+
+    m_reply = m_network->get(request);
+    if (m_bandwidthLimit > 0) {
+        // Data not read yet is left to the socket so that the sender slows down.
+        m_budget = m_bandwidthLimit * gThrottleInterval / 1000;
+        m_reply->setReadBufferSize(qMax(m_budget, qint64(1024)));
+    }
+    connect(m_reply, SIGNAL(metaDataChanged()), this, SLOT(metaDataChanged()));
+    connect(m_reply, SIGNAL(readyRead()), this, SLOT(readyRead()));
+    connect(m_reply, SIGNAL(finished()), this, SLOT(replyFinished()));
+}
+
+// Drops the partial content and downloads the whole resource.
+void DownloadResumer::restart()
+{
+    if (m_reply && m_reply->isRunning()) {
+        m_restart = true;
+        m_reply->abort();
+    } else {
+        m_etag.clear();
+        m_lastModified.clear();
+        m_offset = 0;
+        m_file.resize(0);
+        m_file.seek(0);
+        request();
+    }
+}
+
+void DownloadResumer::finish(bool success)
+{
+    m_completing = false;
+    m_tail.clear();
+    if (m_throttleTimer) {
+        killTimer(m_throttleTimer);
+        m_throttleTimer = 0;
+    }
+    m_file.close();
+#ifdef DEBUG_LOGS
+    qDebug() << "download finished:" << m_file.fileName() << success << m_offset << m_size;
+#endif
+    emit finished(success);
+}
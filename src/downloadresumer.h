@@ -0,0 +1,102 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef DOWNLOADRESUMER_H
+#define DOWNLOADRESUMER_H
+
+#include <QObject>
+#include <QFile>
+#include <QPointer>
+#include <QUrl>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QTimerEvent;
+
+/**
+ * Continues an interrupted download from the bytes already in the target file
+ * with a HTTP range request. The range is made conditional with If-Range, thus
+ * the download starts over when neither a strong ETag nor Last-Modified of the
+ * resource is known. A server that does not honor the range sends the whole
+ * resource and the file is rewritten.
+ */
+class DownloadResumer : public QObject
+{
+    Q_OBJECT
+
+public:
+    DownloadResumer(const QUrl &url, const QString &targetPath, QNetworkAccessManager *network, QObject *parent = 0);
+
+    void setExpectedSize(qint64 size);
+    void setValidators(const QString &etag, const QString &lastModified);
+    void setBandwidthLimit(qint64 bytesPerSecond);
+    qint64 bandwidthLimit() const;
+
+    QUrl url() const;
+    QString targetPath() const;
+    QString etag() const;
+    QString lastModified() const;
+    qint64 received() const;
+    qint64 size() const;
+    // Offset of the first byte requested from the server, 0 for a full download.
+    qint64 resumedFrom() const;
+
+    bool isPaused() const;
+
+    void start();
+    void pause();
+    void abort();
+
+signals:
+    void progress(qint64 received, qint64 size);
+    void finished(bool success);
+
+protected:
+    void timerEvent(QTimerEvent *event);
+
+private slots:
+    void metaDataChanged();
+    void readyRead();
+    void replyFinished();
+
+private:
+    QByteArray ifRange() const;
+    void request();
+    bool write(QNetworkReply *reply);
+    void writeTail();
+    bool append(const QByteArray &data);
+    void restart();
+    void finish(bool success);
+
+    QUrl m_url;
+    QFile m_file;
+    QNetworkAccessManager *m_network;
+    QPointer<QNetworkReply> m_reply;
+    QString m_etag;
+    QString m_lastModified;
+    qint64 m_offset;
+    qint64 m_resumedFrom;
+    qint64 m_size;
+    int m_redirects;
+    bool m_accepted;
+    bool m_restart;
+    bool m_aborted;
+    bool m_paused;
+    // Reply has finished but part of its data is still to be written.
+    bool m_completing;
+    QByteArray m_tail;
+    qint64 m_bandwidthLimit;
+    // Bytes that may still be read during the current throttle interval.
+    qint64 m_budget;
+    int m_throttleTimer;
+};
+
+#endif // DOWNLOADRESUMER_H
@@ -0,0 +1,250 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "downloadscheduler.h"
+
+#include <QDebug>
+#include <QTimerEvent>
+
+static const int gDefaultMaxActive = 2;
+// Page loads shorter than this do not pause downloads.
+static const int gDefaultPauseDelay = 1000;
+// Downloads continue after this long even if the page has not finished loading.
+static const int gDefaultMaxPause = 15000;
+
+DownloadScheduler::DownloadScheduler(QObject *parent)
+    : QObject(parent)
+    , m_sequence(0)
+    , m_maxActive(gDefaultMaxActive)
+    , m_paused(false)
+    , m_pageLoading(false)
+    , m_pauseDelay(gDefaultPauseDelay)
+    , m_maxPause(gDefaultMaxPause)
+    , m_pauseDelayTimer(0)
+    , m_maxPauseTimer(0)
+{
+}
+
+int DownloadScheduler::maxActive() const
+{
+    return m_maxActive;
+}
+
+void DownloadScheduler::setMaxActive(int maxActive)
+{
+    m_maxActive = qMax(1, maxActive);
+    while (m_active.count() > m_maxActive && pauseLast()) {
+    }
+    schedule();
+}
+
+bool DownloadScheduler::paused() const
+{
+    return m_paused;
+}
+
+/**
+ * @brief DownloadScheduler::setPaused
+ * Pauses all downloads, for example while a page is loading in the foreground.
+ * Paused downloads keep their place in the queue.
+ */
+void DownloadScheduler::setPaused(bool paused)
+{
+    if (m_paused == paused) {
+        return;
+    }
+
+    m_paused = paused;
+#ifdef DEBUG_LOGS
+    qDebug() << "downloads paused:" << m_paused << "active:" << m_active.count() << "queued:" << m_queue.count();
+#endif
+    if (m_paused) {
+        while (pauseLast()) {
+        }
+    } else {
+        schedule();
+    }
+}
+
+int DownloadScheduler::pauseDelay() const
+{
+    return m_pauseDelay;
+}
+
+void DownloadScheduler::setPauseDelay(int pauseDelay)
+{
+    m_pauseDelay = qMax(0, pauseDelay);
+}
+
+int DownloadScheduler::maxPause() const
+{
+    return m_maxPause;
+}
+
+void DownloadScheduler::setMaxPause(int maxPause)
+{
+    m_maxPause = qMax(0, maxPause);
+}
+
+/**
+ * @brief DownloadScheduler::setPageLoading
+ * Pauses downloads once the page has been loading for pauseDelay, and resumes
+ * them when the page has finished loading or maxPause has passed.
+ */
+void DownloadScheduler::setPageLoading(bool loading)
+{
+    if (m_pageLoading == loading) {
+        return;
+    }
+
+    m_pageLoading = loading;
+    if (m_pauseDelayTimer) {
+        killTimer(m_pauseDelayTimer);
+        m_pauseDelayTimer = 0;
+    }
+    if (m_maxPauseTimer) {
+        killTimer(m_maxPauseTimer);
+        m_maxPauseTimer = 0;
+    }
+
+    if (m_pageLoading) {
+        m_pauseDelayTimer = startTimer(m_pauseDelay);
+    } else {
+        setPaused(false);
+    }
+}
+
+void DownloadScheduler::add(const QString &key, int priority, bool pausable)
+{
+    if (contains(key)) {
+        return;
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.priority = priority;
+    entry.sequence = ++m_sequence;
+    entry.pausable = pausable;
+
+    if (!m_paused && m_active.count() < m_maxActive) {
+        m_active.append(entry);
+    } else {
+        enqueue(entry);
+        emit pauseRequested(key);
+    }
+}
+
+/**
+ * @brief DownloadScheduler::remove
+ * Forgets a download that has finished, failed or been canceled and lets the
+ * next queued download run.
+ */
+void DownloadScheduler::remove(const QString &key)
+{
+    for (int i = 0; i < m_active.count(); ++i) {
+        if (m_active.at(i).key == key) {
+            m_active.removeAt(i);
+            schedule();
+            return;
+        }
+    }
+
+    for (int i = 0; i < m_queue.count(); ++i) {
+        if (m_queue.at(i).key == key) {
+            m_queue.removeAt(i);
+            return;
+        }
+    }
+}
+
+bool DownloadScheduler::contains(const QString &key) const
+{
+    if (isActive(key)) {
+        return true;
+    }
+    foreach (const Entry &entry, m_queue) {
+        if (entry.key == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DownloadScheduler::isActive(const QString &key) const
+{
+    foreach (const Entry &entry, m_active) {
+        if (entry.key == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int DownloadScheduler::activeCount() const
+{
+    return m_active.count();
+}
+
+int DownloadScheduler::queuedCount() const
+{
+    return m_queue.count();
+}
+
+void DownloadScheduler::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() == m_pauseDelayTimer) {
+        killTimer(m_pauseDelayTimer);
+        m_pauseDelayTimer = 0;
+        setPaused(true);
+        m_maxPauseTimer = startTimer(m_maxPause);
+    } else if (event->timerId() == m_maxPauseTimer) {
+        killTimer(m_maxPauseTimer);
+        m_maxPauseTimer = 0;
+#ifdef DEBUG_LOGS
+        qDebug() << "page still loading, downloads continue";
+#endif
+        setPaused(false);
+    }
+}
+
+// Moves the latest pausable arrival back to the queue, returns false if there is none.
+bool DownloadScheduler::pauseLast()
+{
+    for (int i = m_active.count() - 1; i >= 0; --i) {
+        if (m_active.at(i).pausable) {
+            Entry entry = m_active.takeAt(i);
+            enqueue(entry);
+            emit pauseRequested(entry.key);
+            return true;
+        }
+    }
+    return false;
+}
+
+void DownloadScheduler::enqueue(const Entry &entry)
+{
+    int i = 0;
+    while (i < m_queue.count()
+           && (m_queue.at(i).priority > entry.priority
+               || (m_queue.at(i).priority == entry.priority && m_queue.at(i).sequence < entry.sequence))) {
+        ++i;
+    }
+    m_queue.insert(i, entry);
+}
+
+void DownloadScheduler::schedule()
+{
+    while (!m_paused && m_active.count() < m_maxActive && !m_queue.isEmpty()) {
+        Entry entry = m_queue.takeFirst();
+        m_active.append(entry);
+        emit resumeRequested(entry.key);
+    }
+}
@@ -0,0 +1,92 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef DOWNLOADSCHEDULER_H
+#define DOWNLOADSCHEDULER_H
+
+#include <QObject>
+#include <QList>
+#include <QStringList>
+
+class QTimerEvent;
+
+/**
+ * Decides which downloads may transfer data. At most maxActive downloads run
+ * at a time, the rest wait in a queue ordered by priority and then by arrival.
+ * While a page is loading in the foreground all downloads are held back so that
+ * the page gets the bandwidth. Loads shorter than pauseDelay do not pause the
+ * downloads, and a page that keeps loading holds them back for maxPause at most.
+ *
+ * Downloads start running when they are added, the scheduler asks the owner
+ * to pause and resume them with pauseRequested and resumeRequested. Downloads
+ * that cannot be paused without losing what they have received are added as
+ * not pausable, they are queued only when added and then run to the end.
+ */
+class DownloadScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DownloadScheduler(QObject *parent = 0);
+
+    int maxActive() const;
+    void setMaxActive(int maxActive);
+
+    bool paused() const;
+    void setPaused(bool paused);
+
+    int pauseDelay() const;
+    void setPauseDelay(int pauseDelay);
+    int maxPause() const;
+    void setMaxPause(int maxPause);
+    void setPageLoading(bool loading);
+
+    void add(const QString &key, int priority = 0, bool pausable = true);
+    void remove(const QString &key);
+
+    bool contains(const QString &key) const;
+    bool isActive(const QString &key) const;
+    int activeCount() const;
+    int queuedCount() const;
+
+signals:
+    void pauseRequested(QString key);
+    void resumeRequested(QString key);
+
+protected:
+    void timerEvent(QTimerEvent *event);
+
+private:
+    struct Entry {
+        QString key;
+        int priority;
+        quint64 sequence;
+        bool pausable;
+    };
+
+    bool pauseLast();
+    void enqueue(const Entry &entry);
+    void schedule();
+
+    QList<Entry> m_active;
+    // Sorted, the next download to run first.
+    QList<Entry> m_queue;
+    quint64 m_sequence;
+    int m_maxActive;
+    bool m_paused;
+    bool m_pageLoading;
+    int m_pauseDelay;
+    int m_maxPause;
+    int m_pauseDelayTimer;
+    int m_maxPauseTimer;
+};
+
+#endif // DOWNLOADSCHEDULER_H
@@ -0,0 +1,365 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "faviconcache.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QMutexLocker>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <QTimerEvent>
+
+static const int gIconSize = 64;
+static const int gMemoryBudget = 2 * 1024 * 1024;
+static const int gMaxRedirects = 3;
+// Index is written once fetching calms down.
+static const int gSaveIndexDelay = 2000;
+static const char * const gIndexFile = "index";
+
+class FaviconStoreTask : public QRunnable
+{
+public:
+    FaviconStoreTask(FaviconCache *cache, const QString &origin, const QUrl &iconUrl, int redirects,
+                     const QByteArray &data)
+        : m_cache(cache)
+        , m_origin(origin)
+        , m_iconUrl(iconUrl)
+        , m_redirects(redirects)
+        , m_data(data)
+    {
+    }
+
+    void run()
+    {
+        QImage image = QImage::fromData(m_data);
+        QByteArray hash;
+        if (!image.isNull()) {
+            if (image.width() > gIconSize || image.height() > gIconSize) {
+                image = image.scaled(gIconSize, gIconSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+            }
+            hash = QCryptographicHash::hash(m_data, QCryptographicHash::Sha1).toHex();
+            save(hash, image);
+        }
+
+        // Cache waits for the pool to be done before it gets destroyed.
+        QMetaObject::invokeMethod(m_cache, "iconStored", Qt::QueuedConnection,
+                                  Q_ARG(QString, m_origin), Q_ARG(QUrl, m_iconUrl), Q_ARG(int, m_redirects),
+                                  Q_ARG(QByteArray, hash), Q_ARG(QImage, image));
+    }
+
+private:
+    void save(const QByteArray &hash, const QImage &image)
+    {
+        QString path = m_cache->filePath(hash);
+        if (QFile::exists(path)) {
+            return;
+        }
+
+        QDir dir(m_cache->m_directory);
+        if (!dir.exists() && !dir.mkpath(m_cache->m_directory)) {
+            qWarning() << "Can't create directory " + m_cache->m_directory;
+            return;
+        }
+
+        // Icons with identical content may be stored at the same time.
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly) || !image.save(&file, "PNG") || !file.commit()) {
+            qWarning() << Q_FUNC_INFO << "failed to save favicon" << path;
+        }
+    }
+
+    FaviconCache *m_cache;
+    QString m_origin;
+    QUrl m_iconUrl;
+    int m_redirects;
+    QByteArray m_data;
+};
+
+FaviconCache::FaviconCache(const QString &directory, QObject *parent)
+    : QObject(parent)
+    , m_directory(directory)
+    , m_loaded(false)
+    , m_images(gMemoryBudget)
+    , m_network(0)
+    , m_saveTimer(0)
+{
+    if (m_directory.isEmpty()) {
+        m_directory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/favicons";
+    }
+}
+
+FaviconCache::~FaviconCache()
+{
+    m_storeThreadPool.waitForDone();
+    if (m_saveTimer) {
+        saveIndex();
+    }
+}
+
+FaviconCache *FaviconCache::instance()
+{
+    static FaviconCache *faviconCache;
+    if (!faviconCache) {
+        faviconCache = new FaviconCache();
+    }
+    return faviconCache;
+}
+
+QString FaviconCache::originKey(const QUrl &url)
+{
+    if (url.host().isEmpty()) {
+        return QString();
+    }
+    return url.toString(QUrl::RemoveUserInfo | QUrl::RemovePath | QUrl::RemoveQuery | QUrl::RemoveFragment);
+}
+
+/**
+ * @brief FaviconCache::origin
+ * Returns the origin whose favicon is shown for the page, that of the icon for
+ * pages without one.
+ */
+QString FaviconCache::origin(const QString &pageUrl, const QString &iconUrl) const
+{
+    QString origin = originKey(QUrl(pageUrl));
+    return origin.isEmpty() ? originKey(QUrl(iconUrl)) : origin;
+}
+
+/**
+ * @brief FaviconCache::faviconUrl
+ * Returns image url of the favicon of the page's origin. Unknown favicon is
+ * fetched, from iconUrl when given, and an empty string is returned meanwhile.
+ * Icons that are not fetched over http, like theme icons, are returned as they are.
+ * @param revision not used, binding dependency that is changed on faviconAvailable()
+ */
+QString FaviconCache::faviconUrl(const QString &pageUrl, const QString &iconUrl, int revision)
+{
+    Q_UNUSED(revision)
+    if (!iconUrl.isEmpty()) {
+        QString scheme = QUrl(iconUrl).scheme();
+        if (scheme != QLatin1String("http") && scheme != QLatin1String("https")) {
+            return iconUrl;
+        }
+    }
+
+    QString origin = this->origin(pageUrl, iconUrl);
+    if (origin.isEmpty()) {
+        return QString();
+    }
+
+    {
+        QMutexLocker lock(&m_mutex);
+        load();
+        QByteArray hash = m_origins.value(origin);
+        if (!hash.isEmpty()) {
+            return QString("image://favicon/%1").arg(QString::fromLatin1(hash));
+        }
+    }
+
+    if (!m_pending.contains(origin) && !m_failed.contains(origin)) {
+        fetch(origin, iconUrl.isEmpty() ? QUrl(origin + "/favicon.ico") : QUrl(iconUrl));
+    }
+    return QString();
+}
+
+/**
+ * @brief FaviconCache::image
+ * Returns decoded favicon from memory or loads it from disk.
+ */
+QImage FaviconCache::image(const QByteArray &hash)
+{
+    // Ids come from image urls, only accept content hashes as file names.
+    if (hash.isEmpty() || QByteArray::fromHex(hash).toHex() != hash) {
+        return QImage();
+    }
+
+    {
+        QMutexLocker lock(&m_mutex);
+        QImage *cached = m_images.object(hash);
+        if (cached) {
+            return *cached;
+        }
+    }
+
+    QImage image(filePath(hash));
+    if (!image.isNull()) {
+        QMutexLocker lock(&m_mutex);
+        m_images.insert(hash, new QImage(image), image.byteCount());
+    }
+    return image;
+}
+
+/**
+ * @brief FaviconCache::insert
+ * Decodes and stores the favicon of the origin on the worker thread. Icons with
+ * identical content are stored once. faviconAvailable() is emitted once the icon
+ * has been stored, data that can't be decoded is ignored.
+ */
+void FaviconCache::insert(const QString &origin, const QByteArray &data)
+{
+    store(origin, QUrl(), 0, data);
+}
+
+void FaviconCache::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() == m_saveTimer) {
+        killTimer(m_saveTimer);
+        m_saveTimer = 0;
+        saveIndex();
+    }
+}
+
+void FaviconCache::fetchFinished()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    if (!reply) {
+        return;
+    }
+    reply->deleteLater();
+
+    QString origin = reply->property("origin").toString();
+    int redirects = reply->property("redirects").toInt();
+    QUrl redirect = reply->attribute(QNetworkRequest::RedirectionTargetAttribute).toUrl();
+    if (reply->error() == QNetworkReply::NoError && redirect.isValid() && redirects < gMaxRedirects) {
+        fetch(origin, reply->url().resolved(redirect), redirects + 1);
+        return;
+    }
+
+    if (reply->error() != QNetworkReply::NoError) {
+#ifdef DEBUG_LOGS
+        qDebug() << "favicon fetch failed" << reply->url() << reply->errorString();
+#endif
+        fetchFailed(origin, reply->url(), redirects);
+    } else {
+        // Origin stays pending until the icon has been stored.
+        store(origin, reply->url(), redirects, reply->readAll());
+    }
+}
+
+void FaviconCache::iconStored(QString origin, QUrl iconUrl, int redirects, QByteArray hash, QImage image)
+{
+    if (image.isNull()) {
+        fetchFailed(origin, iconUrl, redirects);
+        return;
+    }
+
+    m_pending.remove(origin);
+
+    {
+        QMutexLocker lock(&m_mutex);
+        load();
+        m_origins.insert(origin, hash);
+        m_images.insert(hash, new QImage(image), image.byteCount());
+    }
+
+    if (!m_saveTimer) {
+        m_saveTimer = startTimer(gSaveIndexDelay);
+    }
+    emit faviconAvailable(origin);
+}
+
+// Called with the lock held.
+void FaviconCache::load()
+{
+    if (m_loaded) {
+        return;
+    }
+    m_loaded = true;
+
+    QFile file(QDir(m_directory).absoluteFilePath(gIndexFile));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return;
+    }
+
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        QStringList entry = in.readLine().split(QLatin1Char(' '));
+        if (entry.count() == 2 && QFile::exists(filePath(entry.at(1).toLatin1()))) {
+            m_origins.insert(entry.at(0), entry.at(1).toLatin1());
+        }
+    }
+}
+
+void FaviconCache::saveIndex()
+{
+    QHash<QString, QByteArray> origins;
+    {
+        QMutexLocker lock(&m_mutex);
+        origins = m_origins;
+    }
+
+    QDir dir(m_directory);
+    if (!dir.exists() && !dir.mkpath(m_directory)) {
+        qWarning() << "Can't create directory " + m_directory;
+        return;
+    }
+
+    QFile file(dir.absoluteFilePath(gIndexFile));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "Can't create file " + file.fileName();
+        return;
+    }
+
+    QTextStream out(&file);
+    QHash<QString, QByteArray>::const_iterator it;
+    for (it = origins.constBegin(); it != origins.constEnd(); ++it) {
+        out << it.key() << ' ' << it.value() << '\n';
+    }
+}
+
+void FaviconCache::fetch(const QString &origin, const QUrl &iconUrl, int redirects)
+{
+    if (!m_network) {
+        m_network = new QNetworkAccessManager(this);
+    }
+
+    m_pending.insert(origin);
+    QNetworkRequest request(iconUrl);
+    request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferCache);
+    QNetworkReply *reply = m_network->get(request);
+    reply->setProperty("origin", origin);
+    reply->setProperty("redirects", redirects);
+    connect(reply, SIGNAL(finished()), this, SLOT(fetchFinished()));
+}
+
+void FaviconCache::fetchFailed(const QString &origin, const QUrl &iconUrl, int redirects)
+{
+    m_pending.remove(origin);
+    QUrl defaultIcon(origin + "/favicon.ico");
+    if (iconUrl.isValid() && iconUrl != defaultIcon && redirects == 0) {
+        // Icon given by the page failed, fallback to the default location.
+        fetch(origin, defaultIcon);
+        return;
+    }
+#ifdef DEBUG_LOGS
+    qDebug() << "no favicon for" << origin;
+#endif
+    // Not retried during this session.
+    m_failed.insert(origin);
+}
+
+void FaviconCache::store(const QString &origin, const QUrl &iconUrl, int redirects, const QByteArray &data)
+{
+    m_pending.insert(origin);
+    m_storeThreadPool.start(new FaviconStoreTask(this, origin, iconUrl, redirects, data));
+}
+
+QString FaviconCache::filePath(const QByteArray &hash) const
+{
+    return QString("%1/%2.png").arg(m_directory).arg(QString::fromLatin1(hash));
+}
@@ -0,0 +1,89 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef FAVICONCACHE_H
+#define FAVICONCACHE_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QSet>
+#include <QThreadPool>
+#include <QUrl>
+
+class QNetworkAccessManager;
+class QTimerEvent;
+
+/**
+ * Favicons fetched once per origin. Icons are deduplicated by content hash,
+ * stored as small PNG files, and kept decoded in memory. QML gets them through
+ * the favicon image provider with image://favicon/<hash> urls.
+ *
+ * faviconUrl() is called from the GUI thread, image() from the image provider
+ * thread. Fetched icons are decoded and written on a worker thread, and
+ * faviconAvailable() tells the origin whose icon became available.
+ */
+class FaviconCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FaviconCache(const QString &directory = QString(), QObject *parent = 0);
+    ~FaviconCache();
+
+    static FaviconCache *instance();
+    static QString originKey(const QUrl &url);
+
+    Q_INVOKABLE QString origin(const QString &pageUrl, const QString &iconUrl = QString()) const;
+    Q_INVOKABLE QString faviconUrl(const QString &pageUrl, const QString &iconUrl = QString(), int revision = 0);
+
+    QImage image(const QByteArray &hash);
+    void insert(const QString &origin, const QByteArray &data);
+
+signals:
+    void faviconAvailable(QString origin);
+
+protected:
+    void timerEvent(QTimerEvent *event);
+
+private slots:
+    void fetchFinished();
+    void iconStored(QString origin, QUrl iconUrl, int redirects, QByteArray hash, QImage image);
+
+private:
+    void load();
+    void saveIndex();
+    void fetch(const QString &origin, const QUrl &iconUrl, int redirects = 0);
+    void fetchFailed(const QString &origin, const QUrl &iconUrl, int redirects);
+    void store(const QString &origin, const QUrl &iconUrl, int redirects, const QByteArray &data);
+    QString filePath(const QByteArray &hash) const;
+
+    friend class FaviconStoreTask;
+
+    mutable QMutex m_mutex;
+    QString m_directory;
+    bool m_loaded;
+    // Origin to content hash of the icon.
+    QHash<QString, QByteArray> m_origins;
+    // Decoded icons by content hash, cost is size in bytes.
+    QCache<QByteArray, QImage> m_images;
+
+    QNetworkAccessManager *m_network;
+    QSet<QString> m_pending;
+    QSet<QString> m_failed;
+    QThreadPool m_storeThreadPool;
+    int m_saveTimer;
+};
+
+#endif // FAVICONCACHE_H
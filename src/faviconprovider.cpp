@@ -0,0 +1,32 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "faviconprovider.h"
+#include "faviconcache.h"
+
+FaviconProvider::FaviconProvider()
+    : QQuickImageProvider(QQuickImageProvider::Image)
+{
+}
+
+QImage FaviconProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
+{
+    QImage image = FaviconCache::instance()->image(id.toLatin1());
+    if (size) {
+        *size = image.size();
+    }
+
+    if (!image.isNull() && requestedSize.isValid()
+            && (requestedSize.width() < image.width() || requestedSize.height() < image.height())) {
+        image = image.scaled(requestedSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    return image;
+}
@@ -0,0 +1,29 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef FAVICONPROVIDER_H
+#define FAVICONPROVIDER_H
+
+#include <QQuickImageProvider>
+
+/**
+ * Serves favicons from FaviconCache. Image urls are of form
+ * image://favicon/<content hash>.
+ */
+class FaviconProvider : public QQuickImageProvider
+{
+public:
+    FaviconProvider();
+
+    QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize);
+};
+
+#endif // FAVICONPROVIDER_H
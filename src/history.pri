@@ -3,19 +3,31 @@ SOURCES += \
     $$PWD/declarativetabmodel.cpp \
     $$PWD/dbmanager.cpp \
     $$PWD/dbworker.cpp \
+    $$PWD/bookmarkparser.cpp \
     $$PWD/link.cpp \
     $$PWD/linkvalidator.cpp \
+    $$PWD/thumbnailcache.cpp \
     $$PWD/declarativehistorymodel.cpp \
-    $$PWD/tab.cpp
+    $$PWD/declarativesuggestionmodel.cpp \
+    $$PWD/listdiff.cpp \
+    $$PWD/suggestionindex.cpp \
+    $$PWD/tab.cpp \
+    $$PWD/browsertrace.cpp
 
 # C++ headers
 HEADERS += \
     $$PWD/declarativetabmodel.h \
     $$PWD/dbmanager.h \
     $$PWD/dbworker.h \
+    $$PWD/bookmarkparser.h \
     $$PWD/link.h \
     $$PWD/linkvalidator.h \
+    $$PWD/thumbnailcache.h \
     $$PWD/declarativehistorymodel.h \
-    $$PWD/tab.h
+    $$PWD/declarativesuggestionmodel.h \
+    $$PWD/listdiff.h \
+    $$PWD/suggestionindex.h \
+    $$PWD/tab.h \
+    $$PWD/browsertrace.h
 
 DEFINES += DB_NAME=\\\"sailfish-browser.sqlite\\\"
@@ -22,7 +22,7 @@ Link::Link() :
 }
 
 Link::Link(const Link& l) :
-    m_linkId(l.m_linkId), m_url(l.m_url), m_thumbPath(l.m_thumbPath), m_title(l.m_title)
+    m_linkId(l.m_linkId), m_url(l.m_url), m_thumbPath(l.m_thumbPath), m_thumbPlaceholder(l.m_thumbPlaceholder), m_title(l.m_title)
 {
 }
 
@@ -56,6 +56,16 @@ void Link::setThumbPath(const QString &thumbPath)
     m_thumbPath = thumbPath;
 }
 
+QByteArray Link::thumbPlaceholder() const
+{
+    return m_thumbPlaceholder;
+}
+
+void Link::setThumbPlaceholder(const QByteArray &thumbPlaceholder)
+{
+    m_thumbPlaceholder = thumbPlaceholder;
+}
+
 QString Link::title() const
 {
     return m_title;
@@ -73,7 +83,7 @@ bool Link::isValid() const
 
 bool Link::operator==(const Link &other) const
 {
-    return (m_linkId == other.linkId() && m_url == other.url() && m_thumbPath == other.thumbPath() && m_title == other.title());
+    return (m_linkId == other.linkId() && m_url == other.url() && m_thumbPath == other.thumbPath() && m_thumbPlaceholder == other.thumbPlaceholder() && m_title == other.title());
 }
 
 bool Link::operator!=(const Link &other) const
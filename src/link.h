@@ -13,6 +13,7 @@
 #define LINK_H
 
 #include <QString>
+#include <QByteArray>
 
 class Link
 {
@@ -30,6 +31,9 @@ public:
     QString thumbPath() const;
     void setThumbPath(const QString &thumbPath);
 
+    QByteArray thumbPlaceholder() const;
+    void setThumbPlaceholder(const QByteArray &thumbPlaceholder);
+
     QString title() const;
     void setTitle(const QString &title);
 
@@ -42,6 +46,7 @@ private:
     int m_linkId;
     QString m_url;
     QString m_thumbPath;
+    QByteArray m_thumbPlaceholder;
     QString m_title;
 };
 
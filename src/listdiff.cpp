@@ -0,0 +1,217 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "listdiff.h"
+
+#include <QMultiHash>
+
+// Edit distance after which the differing middle of the lists is replaced as a whole.
+static const int gMaxDiff = 256;
+
+static ListEdit listEdit(ListEdit::Type type, int first, int last)
+{
+    ListEdit edit;
+    edit.type = type;
+    edit.first = first;
+    edit.last = last;
+    return edit;
+}
+
+/**
+ * Myers' O((N+M)D) difference of two lists of keys. Common prefix and suffix are
+ * matched before the search.
+ * @param complete set to false if the lists differ more than gMaxDiff, only the
+ * common prefix and suffix are matched then.
+ * @return for each new row, index of the matching old row in the longest common
+ * subsequence, or -1.
+ */
+QVector<int> ListDiff::commonRows(const QVector<QString> &oldKeys, const QVector<QString> &newKeys, bool *complete)
+{
+    *complete = true;
+    QVector<int> source(newKeys.count(), -1);
+    int prefix = 0;
+    while (prefix < oldKeys.count() && prefix < newKeys.count() && oldKeys.at(prefix) == newKeys.at(prefix)) {
+        source[prefix] = prefix;
+        ++prefix;
+    }
+    int suffix = 0;
+    while (suffix < oldKeys.count() - prefix && suffix < newKeys.count() - prefix
+           && oldKeys.at(oldKeys.count() - 1 - suffix) == newKeys.at(newKeys.count() - 1 - suffix)) {
+        source[newKeys.count() - 1 - suffix] = oldKeys.count() - 1 - suffix;
+        ++suffix;
+    }
+
+    const int n = oldKeys.count() - prefix - suffix;
+    const int m = newKeys.count() - prefix - suffix;
+    if (n == 0 || m == 0) {
+        return source;
+    }
+
+    const int maxD = qMin(n + m, gMaxDiff);
+    const int offset = maxD + 1;
+    QVector<int> v(2 * maxD + 3, 0);
+    // Diagonals -d, -d + 2, ..., d reached in each round d, for backtracking.
+    QVector<QVector<int> > trace;
+    int d = 0;
+    bool found = false;
+    for (; d <= maxD; ++d) {
+        QVector<int> reached;
+        reached.reserve(d + 1);
+        for (int k = -d; k <= d; k += 2) {
+            int x = (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1]))
+                    ? v[offset + k + 1] : v[offset + k - 1] + 1;
+            int y = x - k;
+            while (x < n && y < m && oldKeys.at(prefix + x) == newKeys.at(prefix + y)) {
+                ++x;
+                ++y;
+            }
+            v[offset + k] = x;
+            reached.append(x);
+            if (x >= n && y >= m) {
+                found = true;
+                break;
+            }
+        }
+        if (found) {
+            break;
+        }
+        trace.append(reached);
+    }
+
+    if (!found) {
+        *complete = false;
+        return source;
+    }
+
+    int x = n;
+    int y = m;
+    for (; d >= 0; --d) {
+        int k = x - y;
+        int prevX = 0;
+        int prevY = 0;
+        if (d > 0) {
+            // Diagonal k of round d - 1 is at index (k + d - 1) / 2.
+            const QVector<int> &prev = trace.at(d - 1);
+            bool down = k == -d || (k != d && prev.at((k - 1 + d - 1) / 2) < prev.at((k + 1 + d - 1) / 2));
+            int prevK = down ? k + 1 : k - 1;
+            prevX = prev.at((prevK + d - 1) / 2);
+            prevY = prevX - prevK;
+        }
+        while (x > prevX && y > prevY) {
+            --x;
+            --y;
+            source[prefix + y] = prefix + x;
+        }
+        x = prevX;
+        y = prevY;
+    }
+    return source;
+}
+
+/**
+ * @brief ListDiff::edits
+ * Removals, insertions, and moves that turn the old list into the new one.
+ * Rows removed and inserted again are moves. Lists that differ completely,
+ * like results of an unrelated search, are simply replaced.
+ */
+QList<ListEdit> ListDiff::edits(const QVector<QString> &oldKeys, const QVector<QString> &newKeys)
+{
+    bool complete = true;
+    QVector<int> source = commonRows(oldKeys, newKeys, &complete);
+    // Old rows that end up in the new list, moved rows are not part of the common subsequence.
+    QVector<bool> kept(oldKeys.count(), false);
+    QVector<bool> common(newKeys.count(), false);
+    for (int j = 0; j < source.count(); ++j) {
+        if (source.at(j) >= 0) {
+            kept[source.at(j)] = true;
+            common[j] = true;
+        }
+    }
+
+    if (complete) {
+        QMultiHash<QString, int> removed;
+        for (int i = oldKeys.count() - 1; i >= 0; --i) {
+            if (!kept.at(i)) {
+                removed.insert(oldKeys.at(i), i);
+            }
+        }
+        for (int j = 0; j < source.count(); ++j) {
+            if (source.at(j) < 0) {
+                QMultiHash<QString, int>::iterator it = removed.find(newKeys.at(j));
+                if (it != removed.end()) {
+                    source[j] = it.value();
+                    kept[it.value()] = true;
+                    removed.erase(it);
+                }
+            }
+        }
+    }
+
+    QList<ListEdit> edits;
+    // Old row of each current row while the edits are applied.
+    QVector<int> rows(oldKeys.count());
+    for (int i = 0; i < rows.count(); ++i) {
+        rows[i] = i;
+    }
+
+    // Removed rows, from the end so that earlier indexes stay valid.
+    for (int i = oldKeys.count() - 1; i >= 0; --i) {
+        if (kept.at(i)) {
+            continue;
+        }
+        int last = i;
+        while (i > 0 && !kept.at(i - 1)) {
+            --i;
+        }
+        edits.append(listEdit(ListEdit::Remove, i, last));
+        rows.remove(i, last - i + 1);
+    }
+
+    // Rows before j are in their final place.
+    int j = 0;
+    while (j < newKeys.count()) {
+        if (source.at(j) < 0) {
+            int last = j;
+            while (last + 1 < newKeys.count() && source.at(last + 1) < 0) {
+                ++last;
+            }
+            edits.append(listEdit(ListEdit::Insert, j, last));
+            rows.insert(j, last - j + 1, -1);
+            j = last + 1;
+            continue;
+        }
+
+        if (common.at(j)) {
+            // Rows moving further down are removed, and inserted when reached.
+            while (rows.at(j) != source.at(j)) {
+                int target = source.indexOf(rows.at(j), j + 1);
+                if (target >= 0) {
+                    source[target] = -1;
+                }
+                edits.append(listEdit(ListEdit::Remove, j, j));
+                rows.remove(j);
+            }
+        } else {
+            int from = rows.indexOf(source.at(j), j);
+            if (from < 0) {
+                // Removed above on its way further down.
+                edits.append(listEdit(ListEdit::Insert, j, j));
+                rows.insert(j, -1);
+            } else if (from != j) {
+                edits.append(listEdit(ListEdit::Move, from, j));
+                rows.remove(from);
+                rows.insert(j, source.at(j));
+            }
+        }
+        ++j;
+    }
+    return edits;
+}
@@ -0,0 +1,46 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef LISTDIFF_H
+#define LISTDIFF_H
+
+#include <QList>
+#include <QString>
+#include <QVector>
+
+/**
+ * Row changes that turn one list of keys into another. List models apply
+ * the edits in order with the matching begin and end calls so that views
+ * keep the delegates of the rows that stay.
+ */
+struct ListEdit {
+    enum Type {
+        // Rows first...last are removed.
+        Remove,
+        // Rows first...last of the new list are inserted at the same rows.
+        Insert,
+        // Row first moves up to row last.
+        Move
+    };
+
+    Type type;
+    int first;
+    int last;
+};
+
+namespace ListDiff {
+
+QVector<int> commonRows(const QVector<QString> &oldKeys, const QVector<QString> &newKeys, bool *complete);
+QList<ListEdit> edits(const QVector<QString> &oldKeys, const QVector<QString> &newKeys);
+
+}
+
+#endif // LISTDIFF_H
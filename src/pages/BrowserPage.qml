@@ -25,6 +25,7 @@ Page {
     property alias tabs: webView.tabModel
     property alias favorites: favoriteModel
     property alias history: historyModel
+    property alias suggestions: suggestionModel
     property alias viewLoading: webView.loading
     property alias url: webView.url
     property alias title: webView.title
@@ -96,6 +97,12 @@ Page {
         id: historyModel
     }
 
+    SuggestionModel {
+        id: suggestionModel
+        bookmarkModel: favoriteModel
+        tabModel: webView.tabModel
+    }
+
     Browser.DownloadRemorsePopup { id: downloadPopup }
     Browser.WebView {
         id: webView
@@ -107,7 +114,9 @@ Page {
 
         tabModel.onCountChanged: {
             if (tabModel.count === 0 && browserPage.status === PageStatus.Active) {
-                pageStack.push(Qt.resolvedUrl("TabPage.qml"), {"browserPage" : browserPage, "initialSearchFocus": true })
+                ComponentLoader.whenReady(Qt.resolvedUrl("TabPage.qml"), function(component) {
+                    pageStack.push(component, {"browserPage" : browserPage, "initialSearchFocus": true })
+                })
             }
         }
     }
@@ -125,12 +134,14 @@ Page {
         function openTabPage(focus, newTab, operationType) {
             if (browserPage.status === PageStatus.Active) {
                 webView.captureScreen()
-                pageStack.push(Qt.resolvedUrl("TabPage.qml"),
-                               {
-                                   "browserPage" : browserPage,
-                                   "initialSearchFocus": focus,
-                                   "newTab": newTab
-                               }, operationType)
+                ComponentLoader.whenReady(Qt.resolvedUrl("TabPage.qml"), function(component) {
+                    pageStack.push(component,
+                                   {
+                                       "browserPage" : browserPage,
+                                       "initialSearchFocus": focus,
+                                       "newTab": newTab
+                                   }, operationType)
+                })
             }
         }
 
@@ -305,8 +316,9 @@ Page {
     }
 
     Component.onCompleted: {
+        ComponentLoader.preload(Qt.resolvedUrl("TabPage.qml"))
         if (!WebUtils.firstUseDone) {
-            var component = Qt.createComponent(Qt.resolvedUrl("components/FirstUseOverlay.qml"))
+            var component = ComponentLoader.component(Qt.resolvedUrl("components/FirstUseOverlay.qml"))
             if (component.status == Component.Ready) {
                 firstUseOverlay = component.createObject(browserPage, {"width":browserPage.width, "height":browserPage.heigh, "gestureThreshold" : toolBarContainer.height});
             } else {
@@ -105,7 +105,8 @@ Page {
 
             Component.onCompleted: page.historyHeader = historyHeader
         }
-        model: browserPage.history
+        // Ranked suggestions while typing, plain history for an empty query.
+        model: browserPage.suggestions.filter !== "" ? browserPage.suggestions : browserPage.history
         search: _search
 
         onLoad: page.load(url, title)
@@ -149,6 +150,9 @@ Page {
                     Browser.TabItem {
                         width: page.width/tabsGrid.columns
                         height: width
+                        flickable: favoriteList
+                        // Grid has not positioned the item yet when it is created, the cell is known from the index.
+                        contentTop: favoriteHeader.y + tabsGrid.y + Math.floor(model.index / tabsGrid.columns) * height
                         // activateTab doesn't work inside delagate because this tab is removed (deleted)
                         // from the model and old active tab pushed to first.
                         onClicked: activateTab(model.index)
@@ -216,7 +220,6 @@ Page {
                 anchors.right: parent.right
                 asynchronous: true
                 source: browserPage.thumbnailPath
-                cache: false
                 visible: status !== Image.Error && source !== "" && !page.newTab
             }
 
@@ -312,7 +315,14 @@ Page {
                         page.load(searchField.text)
                     }
 
-                    onTextChanged: if (text != browserPage.url) browserPage.history.search(text)
+                    onTextChanged: {
+                        if (text != browserPage.url) {
+                            browserPage.suggestions.search(text)
+                            if (text === "") {
+                                browserPage.history.search("")
+                            }
+                        }
+                    }
 
                     Binding { target: page; property: "_search"; value: searchField.text }
                     Binding { target: page; property: "_editing"; value: searchField.focus }
@@ -13,10 +13,16 @@ import QtQuick 2.0
 import Sailfish.Silica 1.0
 
 Image {
+    id: root
+
     property string favicon
     property string link
 
-    source: favicon != "" ? favicon : WebUtils.getFaviconForUrl(link)
+    property int _revision
+    readonly property string _origin: FaviconCache.origin(link, favicon)
+
+    // Favicon is fetched once per origin, _revision changes when it becomes available.
+    source: FaviconCache.faviconUrl(link, favicon, _revision)
     height: Theme.iconSizeSmall
     width: Theme.iconSizeSmall
     asynchronous: true
@@ -24,9 +30,20 @@ Image {
     fillMode: Image.PreserveAspectCrop
     clip: true
 
-    onStatusChanged: {
-        if (status == Image.Error) {
-            source = "image://theme/icon-m-region"
+    Image {
+        anchors.fill: parent
+        visible: parent.status !== Image.Ready
+        source: visible ? "image://theme/icon-m-region" : ""
+        fillMode: Image.PreserveAspectFit
+    }
+
+    Connections {
+        // Only images still waiting for their icon listen.
+        target: root.source == "" ? FaviconCache : null
+        onFaviconAvailable: {
+            if (origin === root._origin) {
+                root._revision++
+            }
         }
     }
 }
@@ -21,6 +21,7 @@ Item {
     property bool videoActive
     property bool audioActive
     property bool background
+    readonly property bool batteryPowered: battery.value
 
     property bool _suspendable
     property string _mediaState: "pause"
@@ -101,6 +102,12 @@ Item {
     }
 
 
+    ContextProperty {
+        id: battery
+        key: "Battery.OnBattery"
+        value: false
+    }
+
     ContextProperty {
         id: screenBlanked
         key: "Screen.Blanked"
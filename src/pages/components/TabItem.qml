@@ -16,12 +16,26 @@ import Sailfish.Silica 1.0
 Rectangle {
     id: tabItem
 
+    // Flickable that scrolls the item and the item's top in its content coordinates.
+    // Off-screen items show the placeholder, the full thumbnail is decoded once the
+    // item has been shown.
+    property Flickable flickable
+    property real contentTop
+    readonly property bool inViewport: !flickable
+                                       || (contentTop + height > flickable.contentY
+                                           && contentTop < flickable.contentY + flickable.height)
+    property bool _loadThumbnail
+    readonly property bool _shown: visible && inViewport
+
     signal clicked
 
+    on_ShownChanged: if (_shown) _loadThumbnail = true
+    Component.onCompleted: _loadThumbnail = _shown
+
     color: Theme.rgba(Theme.highlightColor, 0.1)
 
     Column {
-        visible: !thumb.visible
+        visible: !thumb.visible && !placeholder.visible
         anchors {
             topMargin: Theme.paddingMedium
             top: parent.top
@@ -47,13 +61,21 @@ Rectangle {
         }
     }
 
+    Image {
+        id: placeholder
+        anchors.fill: parent
+        source: thumbnailPlaceholder
+        smooth: true
+        visible: !thumb.visible && status === Image.Ready
+    }
+
     Image {
         id: thumb
         anchors.fill: parent
         asynchronous: true
-        source: thumbnailPath
+        source: _loadThumbnail ? thumbnailPath : ""
         sourceSize.width: Screen.width / 2
-        visible: status !== Image.Error && thumbnailPath !== ""
+        visible: status === Image.Ready
 
         RadialGradient {
             source: thumb
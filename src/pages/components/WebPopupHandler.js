@@ -21,6 +21,8 @@ var resourceController
 var tabModel
 // TODO: WebUtils context property. Should be singleton.
 var WebUtils
+// ComponentLoader context property
+var ComponentLoader
 
 // TODO: Handle these per QmlMozView (map of webviews + accepted/rejectedGeolocationUrl)
 var acceptedGeolocationUrl = ""
@@ -51,6 +53,12 @@ function _hideVirtualKeyboard() {
     }
 }
 
+// Context menu is opened on most pages, it is compiled in the background once
+// the first page has been loaded. Dialogs are rare and compiled on first use.
+function preloadComponents() {
+    ComponentLoader.preload(_contextMenuComponentUrl)
+}
+
 function isAcceptedGeolocationUrl(url) {
     var tmpUrl = WebUtils.displayableUrl(url)
     return  acceptedGeolocationUrl === tmpUrl
@@ -81,46 +89,52 @@ function openAuthDialog(input) {
             _authData = null
         }
 
-        var dialog = pageStack.push(_authenticationComponentUrl,
-                                    {
-                                        "hostname": data.text,
-                                        "realm": data.title,
-                                        "username": data.defaultValue,
-                                        "passwordOnly": data.passwordOnly
-                                    })
-        dialog.accepted.connect(function () {
-            webView.sendAsyncMessage("authresponse",
-                                           {
-                                               "winid": winid,
-                                               "accepted": true,
-                                               "username": dialog.username,
-                                               "password": dialog.password
-                                           })
-        })
-        dialog.rejected.connect(function() {
-            webView.sendAsyncMessage("authresponse",
-                                           {"winid": winid, "accepted": false})
+        ComponentLoader.whenReady(_authenticationComponentUrl, function(component) {
+            var dialog = pageStack.push(component,
+                                        {
+                                            "hostname": data.text,
+                                            "realm": data.title,
+                                            "username": data.defaultValue,
+                                            "passwordOnly": data.passwordOnly
+                                        })
+            dialog.accepted.connect(function () {
+                webView.sendAsyncMessage("authresponse",
+                                               {
+                                                   "winid": winid,
+                                                   "accepted": true,
+                                                   "username": dialog.username,
+                                                   "password": dialog.password
+                                               })
+            })
+            dialog.rejected.connect(function() {
+                webView.sendAsyncMessage("authresponse",
+                                               {"winid": winid, "accepted": false})
+            })
         })
     }
 }
 
 function openSelectDialog(data) {
-    var dialog = pageStack.push(_selectComponentUrl,
-                                {
-                                    "options": data.options,
-                                    "multiple": data.multiple,
-                                    "webview": webView.contentItem
-                                })
+    ComponentLoader.whenReady(_selectComponentUrl, function(component) {
+        pageStack.push(component,
+                       {
+                           "options": data.options,
+                           "multiple": data.multiple,
+                           "webview": webView.contentItem
+                       })
+    })
 }
 
 function openPasswordManagerDialog(data) {
-    pageStack.push(_passwordManagerComponentUrl,
-                   {
-                       "webView": webView.contentItem,
-                       "requestId": data.id,
-                       "notificationType": data.name,
-                       "formData": data.formdata
-                   })
+    ComponentLoader.whenReady(_passwordManagerComponentUrl, function(component) {
+        pageStack.push(component,
+                       {
+                           "webView": webView.contentItem,
+                           "requestId": data.id,
+                           "notificationType": data.name,
+                           "formData": data.formdata
+                       })
+    })
 }
 
 function openContextMenu(data) {
@@ -140,24 +154,28 @@ function openContextMenu(data) {
             _hideVirtualKeyboard()
             _contextMenu.show()
         } else {
-            contextMenuComponent = Qt.createComponent(_contextMenuComponentUrl)
-            if (contextMenuComponent.status !== QtQuick.Component.Error) {
-                _contextMenu = contextMenuComponent.createObject(webView.parent,
-                                                        {
-                                                            "linkHref": linkHref,
-                                                            "imageSrc": imageSrc,
-                                                            "linkTitle": linkTitle.trim(),
-                                                            "contentType": contentType,
-                                                            "tabModel": tabModel,
-                                                            "viewId": webView.contentItem.uniqueID()
-                                                        })
+            ComponentLoader.whenReady(_contextMenuComponentUrl, function(component) {
+                // Menu may have been created by an earlier request while compiling.
+                if (!_contextMenu) {
+                    contextMenuComponent = component
+                    _contextMenu = contextMenuComponent.createObject(webView.parent,
+                                                            {
+                                                                "linkHref": linkHref,
+                                                                "imageSrc": imageSrc,
+                                                                "linkTitle": linkTitle.trim(),
+                                                                "contentType": contentType,
+                                                                "tabModel": tabModel,
+                                                                "viewId": webView.contentItem.uniqueID()
+                                                            })
+                    webView.popupActive = Qt.binding(function() { return (_contextMenu.active) })
+                } else {
+                    _contextMenu.linkHref = linkHref
+                    _contextMenu.linkTitle = linkTitle.trim()
+                    _contextMenu.imageSrc = imageSrc
+                }
                 _hideVirtualKeyboard()
-
-                webView.popupActive = Qt.binding(function() { return (_contextMenu.active) })
                 _contextMenu.show()
-            } else {
-                console.log("Can't load BrowserContextMenu.qml")
-            }
+            })
         }
     }
 }
@@ -176,67 +194,72 @@ function openLocationDialog(data) {
                              checkedDontAsk: false,
                              id: data.id })
     } else {
-        var dialog = pageStack.push(_locationComponentUrl, {})
-        dialog.accepted.connect(function() {
-            webView.sendAsyncMessage("embedui:premissions", {
-                                               allow: true,
-                                               checkedDontAsk: false,
-                                               id: data.id })
-            acceptedGeolocationUrl = WebUtils.displayableUrl(url)
-            rejectedGeolocationUrl = ""
-        })
-        dialog.rejected.connect(function() {
-            webView.sendAsyncMessage("embedui:premissions", {
-                                               allow: false,
-                                               checkedDontAsk: false,
-                                               id: data.id })
-            rejectedGeolocationUrl = WebUtils.displayableUrl(url)
-            acceptedGeolocationUrl = ""
+        ComponentLoader.whenReady(_locationComponentUrl, function(component) {
+            var dialog = pageStack.push(component, {})
+            dialog.accepted.connect(function() {
+                webView.sendAsyncMessage("embedui:premissions", {
+                                                   allow: true,
+                                                   checkedDontAsk: false,
+                                                   id: data.id })
+                acceptedGeolocationUrl = WebUtils.displayableUrl(url)
+                rejectedGeolocationUrl = ""
+            })
+            dialog.rejected.connect(function() {
+                webView.sendAsyncMessage("embedui:premissions", {
+                                                   allow: false,
+                                                   checkedDontAsk: false,
+                                                   id: data.id })
+                rejectedGeolocationUrl = WebUtils.displayableUrl(url)
+                acceptedGeolocationUrl = ""
+            })
         })
     }
 }
 
 function openAlert(data) {
     var winid = data.winid
-    var dialog = pageStack.push(_alertComponentUrl,
-                                {"text": data.text})
-    // TODO: also the Async message must be sent when window gets closed
-    dialog.done.connect(function() {
-        webView.sendAsyncMessage("alertresponse", {"winid": winid})
+    ComponentLoader.whenReady(_alertComponentUrl, function(component) {
+        var dialog = pageStack.push(component, {"text": data.text})
+        // TODO: also the Async message must be sent when window gets closed
+        dialog.done.connect(function() {
+            webView.sendAsyncMessage("alertresponse", {"winid": winid})
+        })
     })
 }
 
 function openConfirm(data) {
     var winid = data.winid
-    var dialog = pageStack.push(_confirmComponentUrl,
-                                {"text": data.text})
-    // TODO: also the Async message must be sent when window gets closed
-    dialog.accepted.connect(function() {
-        webView.sendAsyncMessage("confirmresponse",
-                         {"winid": winid, "accepted": true})
-    })
-    dialog.rejected.connect(function() {
-        webView.sendAsyncMessage("confirmresponse",
-                         {"winid": winid, "accepted": false})
+    ComponentLoader.whenReady(_confirmComponentUrl, function(component) {
+        var dialog = pageStack.push(component, {"text": data.text})
+        // TODO: also the Async message must be sent when window gets closed
+        dialog.accepted.connect(function() {
+            webView.sendAsyncMessage("confirmresponse",
+                             {"winid": winid, "accepted": true})
+        })
+        dialog.rejected.connect(function() {
+            webView.sendAsyncMessage("confirmresponse",
+                             {"winid": winid, "accepted": false})
+        })
     })
 }
 
 function openPrompt(data) {
     var winid = data.winid
-    var dialog = pageStack.push(_queryComponentUrl,
-                                {"text": data.text, "value": data.defaultValue})
-    // TODO: also the Async message must be sent when window gets closed
-    dialog.accepted.connect(function() {
-        webView.sendAsyncMessage("promptresponse",
-                         {
-                             "winid": winid,
-                             "accepted": true,
-                             "promptvalue": dialog.value
-                         })
-    })
-    dialog.rejected.connect(function() {
-        webView.sendAsyncMessage("promptresponse",
-                         {"winid": winid, "accepted": false})
+    ComponentLoader.whenReady(_queryComponentUrl, function(component) {
+        var dialog = pageStack.push(component, {"text": data.text, "value": data.defaultValue})
+        // TODO: also the Async message must be sent when window gets closed
+        dialog.accepted.connect(function() {
+            webView.sendAsyncMessage("promptresponse",
+                             {
+                                 "winid": winid,
+                                 "accepted": true,
+                                 "promptvalue": dialog.value
+                             })
+        })
+        dialog.rejected.connect(function() {
+            webView.sendAsyncMessage("promptresponse",
+                             {"winid": winid, "accepted": false})
+        })
     })
 }
 
@@ -246,9 +269,11 @@ function openFilePicker(data) {
         return
     }
 
-    pageStack.push(_uploadFilePickerComponentUrl,
-                   {
-                       "winid": data.winid,
-                       "webView": webViewContainer
-                   })
+    ComponentLoader.whenReady(_uploadFilePickerComponentUrl, function(component) {
+        pageStack.push(component,
+                       {
+                           "winid": data.winid,
+                           "webView": webViewContainer
+                       })
+    })
 }
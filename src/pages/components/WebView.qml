@@ -93,7 +93,9 @@ WebContainer {
     inputPanelHeight: window.pageStack.panelSize
     inputPanelOpenHeight: window.pageStack.imSize
     fullscreenMode: (contentItem && contentItem.chromeGestureEnabled && !contentItem.chrome) || webView.inputPanelVisible || !webView.foreground || (contentItem && contentItem.fullscreen) || firstUseFullscreen
-    _readyToLoad: contentItem && contentItem.viewReady && tabModel.loaded
+    // A requested url is loaded without waiting for the tabs to be restored.
+    _readyToLoad: contentItem && contentItem.viewReady && (tabModel.loaded || tabModel.hasNewTabData)
+    batteryPowered: resourceController.batteryPowered
 
     loading: contentItem ? contentItem.loading : false
     favicon: contentItem ? contentItem.favicon : ""
@@ -207,6 +209,9 @@ WebContainer {
             }
 
             onLoadedChanged: {
+                if (loaded) {
+                    ComponentLoader.pageLoaded()
+                }
                 if (loaded && !userHasDraggedWhileLoading) {
                     container.resetHeight(false)
                     if (resurrectedContentRect) {
@@ -389,5 +394,7 @@ WebContainer {
         PopupHandler.resourceController = resourceController
         PopupHandler.WebUtils = WebUtils
         PopupHandler.tabModel = tabModel
+        PopupHandler.ComponentLoader = ComponentLoader
+        PopupHandler.preloadComponents()
     }
 }
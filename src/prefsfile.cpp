@@ -0,0 +1,171 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "prefsfile.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <qnumeric.h>
+
+static const char *gBegin = "// Begin of sailfish-browser preferences, rewritten on every start.\n";
+static const char *gEnd = "// End of sailfish-browser preferences.\n";
+// Files that start with this were written by older versions as a whole.
+static const char *gLegacyHeader = "// Written by sailfish-browser on every start, do not edit.\n";
+
+PrefsFile::PrefsFile(const QString &path)
+    : m_path(path)
+{
+}
+
+QString PrefsFile::path() const
+{
+    return m_path;
+}
+
+void PrefsFile::setPref(const QString &name, const QVariant &value)
+{
+    m_prefs.insert(name, value);
+}
+
+QMap<QString, QVariant> PrefsFile::prefs() const
+{
+    return m_prefs;
+}
+
+/**
+ * @brief PrefsFile::toByteArray
+ * @return block of user_pref() lines between the begin and end markers.
+ */
+QByteArray PrefsFile::toByteArray() const
+{
+    QByteArray content(gBegin);
+    QMapIterator<QString, QVariant> pref(m_prefs);
+    while (pref.hasNext()) {
+        pref.next();
+        QByteArray value = formatValue(pref.value());
+        if (value.isEmpty()) {
+            qWarning() << Q_FUNC_INFO << "unsupported value of" << pref.key() << pref.value();
+            continue;
+        }
+        content += "user_pref(" + formatValue(pref.key()) + ", " + value + ");\n";
+    }
+    content += gEnd;
+    return content;
+}
+
+/**
+ * @brief PrefsFile::merge
+ * Replaces the block written earlier in the existing content, lines written
+ * by the user or other programs are kept. The block is written last so that
+ * its preferences win.
+ */
+QByteArray PrefsFile::merge(const QByteArray &existing) const
+{
+    QByteArray merged;
+    if (!existing.isEmpty() && !existing.startsWith(gLegacyHeader)) {
+        bool inBlock = false;
+        QList<QByteArray> lines = existing.split('\n');
+        if (existing.endsWith('\n')) {
+            lines.removeLast();
+        }
+        foreach (const QByteArray &line, lines) {
+            if (line + '\n' == gBegin) {
+                inBlock = true;
+            } else if (line + '\n' == gEnd) {
+                inBlock = false;
+            } else if (!inBlock) {
+                merged += line + '\n';
+            }
+        }
+    }
+    return merged + toByteArray();
+}
+
+/**
+ * @brief PrefsFile::save
+ * Merges the preferences to the file unless it already holds them.
+ * @return true if the file on disk holds the preferences.
+ */
+bool PrefsFile::save() const
+{
+    QByteArray existing;
+    QFile file(m_path);
+    if (file.open(QIODevice::ReadOnly)) {
+        existing = file.readAll();
+        file.close();
+    }
+
+    QByteArray content = merge(existing);
+    if (content == existing) {
+        return true;
+    }
+
+    // Lines of the user are not lost if writing fails half way.
+    QDir().mkpath(QFileInfo(m_path).absolutePath());
+    QSaveFile saveFile(m_path);
+    if (!saveFile.open(QIODevice::WriteOnly)
+            || saveFile.write(content) != content.size()
+            || !saveFile.commit()) {
+        qWarning() << Q_FUNC_INFO << "failed to write" << m_path << saveFile.errorString();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief PrefsFile::formatValue
+ * Gecko has no floating point preferences, doubles with an integral value,
+ * like numbers from QML, are written as integers and others as strings that
+ * Gecko parses for float preferences.
+ * @return value as a JavaScript literal of the type Gecko stores it with, or
+ * an empty array for values that can't be stored.
+ */
+QByteArray PrefsFile::formatValue(const QVariant &value)
+{
+    switch (value.userType()) {
+    case QMetaType::Bool:
+        return value.toBool() ? "true" : "false";
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+        return QByteArray::number(value.toLongLong());
+    case QMetaType::Double:
+    case QMetaType::Float: {
+        double number = value.toDouble();
+        if (qIsNaN(number) || qIsInf(number)) {
+            return QByteArray();
+        }
+        if (number >= -2147483648.0 && number <= 2147483647.0 && number == qint32(number)) {
+            return QByteArray::number(qint32(number));
+        }
+        return '"' + QByteArray::number(number, 'g', 9) + '"';
+    }
+    default:
+        break;
+    }
+
+    QByteArray escaped;
+    foreach (QChar c, value.toString()) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c.toLatin1();
+        } else if (c.unicode() < 0x20 || c.unicode() > 0x7e) {
+            escaped += "\\u" + QByteArray::number(c.unicode(), 16).rightJustified(4, '0');
+        } else {
+            escaped += c.toLatin1();
+        }
+    }
+    return '"' + escaped + '"';
+}
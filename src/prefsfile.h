@@ -0,0 +1,48 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef PREFSFILE_H
+#define PREFSFILE_H
+
+#include <QByteArray>
+#include <QMap>
+#include <QString>
+#include <QVariant>
+
+/**
+ * Collects Gecko preferences and writes them as user_pref() lines to a
+ * preference file. The engine reads user.js of its profile when it starts,
+ * so startup preferences written there need no message per preference
+ * once the engine has been initialized. The preferences are kept in a
+ * marked block of their own, other lines of the file are left as they are.
+ */
+class PrefsFile
+{
+public:
+    explicit PrefsFile(const QString &path);
+
+    QString path() const;
+
+    void setPref(const QString &name, const QVariant &value);
+    QMap<QString, QVariant> prefs() const;
+
+    QByteArray toByteArray() const;
+    QByteArray merge(const QByteArray &existing) const;
+    bool save() const;
+
+    static QByteArray formatValue(const QVariant &value);
+
+private:
+    QString m_path;
+    QMap<QString, QVariant> m_prefs;
+};
+
+#endif // PREFSFILE_H
@@ -25,6 +25,7 @@
 #include "qmozcontext.h"
 
 #include "declarativebookmarkmodel.h"
+#include "dbmanager.h"
 #include "declarativewebutils.h"
 #include "browserservice.h"
 #include "downloadmanager.h"
@@ -32,9 +33,15 @@
 #include "closeeventfilter.h"
 #include "declarativetabmodel.h"
 #include "declarativehistorymodel.h"
+#include "declarativesuggestionmodel.h"
 #include "declarativewebcontainer.h"
 #include "declarativewebpage.h"
 #include "declarativewebviewcreator.h"
+#include "tabthumbnailprovider.h"
+#include "faviconcache.h"
+#include "faviconprovider.h"
+#include "browsertrace.h"
+#include "componentloader.h"
 
 #ifdef HAS_BOOSTER
 #include <MDeclarativeCache>
@@ -42,6 +49,13 @@
 
 Q_DECL_EXPORT int main(int argc, char *argv[])
 {
+    QByteArray tracePath = qgetenv("BROWSER_TRACE");
+    if (!tracePath.isEmpty()) {
+        BrowserTrace::setEnabled(true);
+        BrowserTrace::instance()->setOutputPath(QString::fromLocal8Bit(tracePath));
+    }
+    TRACE_INSTANT("main");
+
     // EGL FPS are lower with threaded render loop
     // that's why this workaround.
     // See JB#7358
@@ -51,13 +65,18 @@ Q_DECL_EXPORT int main(int argc, char *argv[])
     // Workaround for https://bugzilla.mozilla.org/show_bug.cgi?id=929879
     setenv("LC_NUMERIC", "C", 1);
     setlocale(LC_NUMERIC, "C");
+    QScopedPointer<QGuiApplication> app;
+    QScopedPointer<QQuickView> view;
+    {
+        TRACE_SPAN("createApplication");
 #ifdef HAS_BOOSTER
-    QScopedPointer<QGuiApplication> app(MDeclarativeCache::qApplication(argc, argv));
-    QScopedPointer<QQuickView> view(MDeclarativeCache::qQuickView());
+        app.reset(MDeclarativeCache::qApplication(argc, argv));
+        view.reset(MDeclarativeCache::qQuickView());
 #else
-    QScopedPointer<QGuiApplication> app(new QGuiApplication(argc, argv));
-    QScopedPointer<QQuickView> view(new QQuickView);
+        app.reset(new QGuiApplication(argc, argv));
+        view.reset(new QQuickView);
 #endif
+    }
     app->setQuitOnLastWindowClosed(false);
 
     // GRE_HOME must be set before QMozContext is initialized.
@@ -71,9 +90,18 @@ Q_DECL_EXPORT int main(int argc, char *argv[])
         setenv("CUSTOM_UA", "Mozilla/5.0 (Maemo; Linux; U; Jolla; Sailfish; Mobile; rv:29.0) Gecko/29.0 Firefox/29.0 SailfishBrowser/1.0", 1);
     }
 
+    // In prestart mode the browser initializes everything hidden and shows
+    // itself only when the first openUrl request arrives.
+    bool prestart = app->arguments().contains("-prestart");
+
     BrowserService *service = new BrowserService(app.data());
     // Handle command line launch
     if (!service->registered()) {
+        if (prestart) {
+            // Already running, nothing to prestart.
+            return 0;
+        }
+
         QDBusMessage message = QDBusMessage::createMethodCall(service->serviceName(), "/",
                                                               service->serviceName(), "openUrl");
         QStringList args;
@@ -93,32 +121,49 @@ Q_DECL_EXPORT int main(int argc, char *argv[])
 
     QString translationPath("/usr/share/translations/");
     QTranslator engineeringEnglish;
-    engineeringEnglish.load("sailfish-browser_eng_en", translationPath);
-    qApp->installTranslator(&engineeringEnglish);
-
     QTranslator translator;
-    translator.load(QLocale(), "sailfish-browser", "-", translationPath);
-    qApp->installTranslator(&translator);
+    {
+        TRACE_SPAN("loadTranslations");
+        engineeringEnglish.load("sailfish-browser_eng_en", translationPath);
+        qApp->installTranslator(&engineeringEnglish);
+
+        translator.load(QLocale(), "sailfish-browser", "-", translationPath);
+        qApp->installTranslator(&translator);
+    }
 
     //% "Browser"
     view->setTitle(qtTrId("sailfish-browser-ap-name"));
 
-    qmlRegisterType<DeclarativeBookmarkModel>("Sailfish.Browser", 1, 0, "BookmarkModel");
-    qmlRegisterType<DeclarativeTabModel>("Sailfish.Browser", 1, 0, "TabModel");
-    qmlRegisterType<DeclarativeHistoryModel>("Sailfish.Browser", 1, 0, "HistoryModel");
-    qmlRegisterType<DeclarativeWebContainer>("Sailfish.Browser", 1, 0, "WebContainer");
-    qmlRegisterType<DeclarativeWebPage>("Sailfish.Browser", 1, 0, "WebPage");
-    qmlRegisterType<DeclarativeWebViewCreator>("Sailfish.Browser", 1, 0, "WebViewCreator");
+    {
+        TRACE_SPAN("registerTypes");
+        qmlRegisterType<DeclarativeBookmarkModel>("Sailfish.Browser", 1, 0, "BookmarkModel");
+        qmlRegisterType<DeclarativeTabModel>("Sailfish.Browser", 1, 0, "TabModel");
+        qmlRegisterType<DeclarativeHistoryModel>("Sailfish.Browser", 1, 0, "HistoryModel");
+        qmlRegisterType<DeclarativeSuggestionModel>("Sailfish.Browser", 1, 0, "SuggestionModel");
+        qmlRegisterType<DeclarativeWebContainer>("Sailfish.Browser", 1, 0, "WebContainer");
+        qmlRegisterType<DeclarativeWebPage>("Sailfish.Browser", 1, 0, "WebPage");
+        qmlRegisterType<DeclarativeWebViewCreator>("Sailfish.Browser", 1, 0, "WebViewCreator");
+    }
 
-    QString componentPath(DEFAULT_COMPONENTS_PATH);
-    QMozContext::GetInstance()->addComponentManifest(componentPath + QString("/components/EmbedLiteBinComponents.manifest"));
-    QMozContext::GetInstance()->addComponentManifest(componentPath + QString("/components/EmbedLiteJSComponents.manifest"));
-    QMozContext::GetInstance()->addComponentManifest(componentPath + QString("/chrome/EmbedLiteJSScripts.manifest"));
-    QMozContext::GetInstance()->addComponentManifest(componentPath + QString("/chrome/EmbedLiteOverrides.manifest"));
+    {
+        TRACE_SPAN("addComponentManifests");
+        QString componentPath(DEFAULT_COMPONENTS_PATH);
+        QMozContext::GetInstance()->addComponentManifest(componentPath + QString("/components/EmbedLiteBinComponents.manifest"));
+        QMozContext::GetInstance()->addComponentManifest(componentPath + QString("/components/EmbedLiteJSComponents.manifest"));
+        QMozContext::GetInstance()->addComponentManifest(componentPath + QString("/chrome/EmbedLiteJSScripts.manifest"));
+        QMozContext::GetInstance()->addComponentManifest(componentPath + QString("/chrome/EmbedLiteOverrides.manifest"));
+    }
 
     app->setApplicationName(QString("sailfish-browser"));
     app->setOrganizationName(QString("org.sailfishos"));
 
+    if (prestart) {
+        // Connected before the request is relayed to QML so that the window
+        // is there when the page reacts to the request.
+        QObject::connect(service, SIGNAL(openUrlRequested(QString)),
+                         view.data(), SLOT(showFullScreen()));
+    }
+
     DeclarativeWebUtils *utils = DeclarativeWebUtils::instance();
     utils->connect(service, SIGNAL(openUrlRequested(QString)),
             utils, SIGNAL(openUrlRequested(QString)));
@@ -126,8 +171,32 @@ Q_DECL_EXPORT int main(int argc, char *argv[])
     utils->clearStartupCacheIfNeeded();
     view->rootContext()->setContextProperty("WebUtils", utils);
     view->rootContext()->setContextProperty("MozContext", QMozContext::GetInstance());
+    // Engine takes ownership of the provider.
+    view->engine()->addImageProvider(QLatin1String("tabthumb"), new TabThumbnailProvider);
+    view->rootContext()->setContextProperty("FaviconCache", FaviconCache::instance());
+    view->engine()->addImageProvider(QLatin1String("favicon"), new FaviconProvider);
 
-    DownloadManager *dlMgr = DownloadManager::instance();
+    ComponentLoader *componentLoader = new ComponentLoader(view->engine(), app.data());
+    componentLoader->setWindow(view.data());
+    view->rootContext()->setContextProperty("ComponentLoader", componentLoader);
+
+    DBManager *dbManager;
+    {
+        TRACE_SPAN("DBManager::instance");
+        dbManager = DBManager::instance();
+    }
+    dbManager->connect(service, SIGNAL(importBookmarksRequested(QString)),
+            dbManager, SLOT(importBookmarks(QString)));
+    service->connect(dbManager, SIGNAL(bookmarkImportProgress(int,int)),
+            service, SIGNAL(bookmarkImportProgress(int,int)));
+    service->connect(dbManager, SIGNAL(bookmarkImportFinished(int)),
+            service, SIGNAL(bookmarkImportFinished(int)));
+
+    DownloadManager *dlMgr;
+    {
+        TRACE_SPAN("DownloadManager::instance");
+        dlMgr = DownloadManager::instance();
+    }
     dlMgr->connect(service, SIGNAL(cancelTransferRequested(int)),
             dlMgr, SLOT(cancelTransfer(int)));
     dlMgr->connect(service, SIGNAL(restartTransferRequested(int)),
@@ -142,26 +211,49 @@ Q_DECL_EXPORT int main(int argc, char *argv[])
     QObject::connect(QMozContext::GetInstance(), SIGNAL(onInitialized()),
                      settingMgr, SLOT(initialize()));
 
+    {
+        // Read by the engine when embedding starts.
+        TRACE_SPAN("saveStartupPrefs");
+        utils->saveStartupPrefs();
+    }
+
+    {
+        TRACE_SPAN("setSource");
 #ifdef USE_RESOURCES
-    view->setSource(QUrl("qrc:///browser.qml"));
+        view->setSource(QUrl("qrc:///browser.qml"));
 #else
-    bool isDesktop = qApp->arguments().contains("-desktop");
+        bool isDesktop = qApp->arguments().contains("-desktop");
 
-    QString path;
-    if (isDesktop) {
-        path = qApp->applicationDirPath() + QDir::separator();
-    } else {
-        path = QString(DEPLOYMENT_PATH);
-    }
-    view->setSource(QUrl::fromLocalFile(path+"browser.qml"));
+        QString path;
+        if (isDesktop) {
+            path = qApp->applicationDirPath() + QDir::separator();
+        } else {
+            path = QString(DEPLOYMENT_PATH);
+        }
+        view->setSource(QUrl::fromLocalFile(path+"browser.qml"));
 #endif
+    }
 
-    view->showFullScreen();
+    if (BrowserTrace::enabled()) {
+        BrowserTrace *trace = BrowserTrace::instance();
+        QObject::connect(view.data(), SIGNAL(frameSwapped()), trace, SLOT(markFirstFrame()));
+        QObject::connect(app.data(), SIGNAL(aboutToQuit()), trace, SLOT(save()));
+        // Engine starts on the first event loop iteration, right after this mark.
+        QTimer::singleShot(0, trace, SLOT(markEmbeddingStarted()));
+        QObject::connect(QMozContext::GetInstance(), SIGNAL(onInitialized()),
+                         trace, SLOT(markEngineInitialized()));
+    }
+
+    if (!prestart) {
+        TRACE_SPAN("showFullScreen");
+        view->showFullScreen();
+    }
 
     // Setup embedding
     QTimer::singleShot(0, QMozContext::GetInstance(), SLOT(runEmbedding()));
+    TRACE_INSTANT("startEventLoop");
 
-    if (qApp->arguments().count() > 1) {
+    if (!prestart && qApp->arguments().count() > 1) {
         emit utils->openUrlRequested(qApp->arguments().last());
     }
 
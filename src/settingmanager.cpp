@@ -13,18 +13,26 @@
 #include "qmozcontext.h"
 #include "settingmanager.h"
 #include "dbmanager.h"
+#include "declarativewebutils.h"
 
 SettingManager::SettingManager(QObject *parent)
     : QObject(parent)
 {
     m_clearPrivateDataConfItem = new MGConfItem("/apps/sailfish-browser/actions/clear_private_data", this);
     m_searchEngineConfItem = new MGConfItem("/apps/sailfish-browser/settings/search_engine", this);
+
+    DeclarativeWebUtils::instance()->startupPrefs()->setPref(QString("browser.search.defaultenginename"),
+                                                           searchEngine());
 }
 
 void SettingManager::initialize()
 {
     clearPrivateData();
-    setSearchEngine();
+    // The search engine is one of the startup preferences, send it only if
+    // those could not be written for the engine.
+    if (!DeclarativeWebUtils::instance()->startupPrefsSaved()) {
+        setSearchEngine();
+    }
 
     connect(m_clearPrivateDataConfItem, SIGNAL(valueChanged()),
             this, SLOT(clearPrivateData()));
@@ -47,6 +55,10 @@ void SettingManager::clearPrivateData()
 
 void SettingManager::setSearchEngine()
 {
-    QVariant searchEngine = m_searchEngineConfItem->value(QVariant(QString("Google")));
-    QMozContext::GetInstance()->setPref(QString("browser.search.defaultenginename"), searchEngine);
+    QMozContext::GetInstance()->setPref(QString("browser.search.defaultenginename"), searchEngine());
+}
+
+QVariant SettingManager::searchEngine() const
+{
+    return m_searchEngineConfItem->value(QVariant(QString("Google")));
 }
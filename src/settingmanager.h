@@ -29,6 +29,8 @@ private slots:
     void setSearchEngine();
 
 private:
+    QVariant searchEngine() const;
+
     MGConfItem *m_clearPrivateDataConfItem;
     MGConfItem *m_searchEngineConfItem;
 };
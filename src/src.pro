@@ -1,4 +1,4 @@
-QT += qml quick dbus concurrent sql
+QT += qml quick dbus concurrent sql network
 # The name of your app
 TARGET = sailfish-browser
 
@@ -62,9 +62,19 @@ SOURCES += \
     browserservice.cpp \
     dbusadaptor.cpp \
     downloadmanager.cpp \
+    transferprogressthrottle.cpp \
+    downloadresumer.cpp \
+    downloadscheduler.cpp \
+    downloadrestartguard.cpp \
     settingmanager.cpp \
     closeeventfilter.cpp \
-    webpages.cpp
+    tabthumbnailprovider.cpp \
+    faviconcache.cpp \
+    faviconprovider.cpp \
+    componentloader.cpp \
+    prefsfile.cpp \
+    webpages.cpp \
+    webpagescheduler.cpp
 
 # C++ headers
 HEADERS += \
@@ -77,9 +87,19 @@ HEADERS += \
     browserservice.h \
     dbusadaptor.h \
     downloadmanager.h \
+    transferprogressthrottle.h \
+    downloadresumer.h \
+    downloadscheduler.h \
+    downloadrestartguard.h \
     settingmanager.h \
     closeeventfilter.h \
-    webpages.h
+    tabthumbnailprovider.h \
+    faviconcache.h \
+    faviconprovider.h \
+    componentloader.h \
+    prefsfile.h \
+    webpages.h \
+    webpagescheduler.h
 
 OTHER_FILES = *.qml \
               pages/*.qml \
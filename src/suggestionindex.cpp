@@ -0,0 +1,412 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "suggestionindex.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QSet>
+#include <qmath.h>
+
+#include <algorithm>
+
+// Entries without any source are dropped once there are more of them than live ones.
+static const int gCompactThreshold = 256;
+// Search checks the latency budget after this many matching terms.
+static const int gBudgetCheckInterval = 128;
+static const qint64 gDay = 24 * 60 * 60;
+
+static bool higherScore(const QPair<qreal, int> &a, const QPair<qreal, int> &b)
+{
+    return a.first > b.first;
+}
+
+static QStringList words(const QString &text)
+{
+    QStringList words;
+    int start = -1;
+    for (int i = 0; i <= text.length(); ++i) {
+        bool letter = i < text.length() && text.at(i).isLetterOrNumber();
+        if (letter && start < 0) {
+            start = i;
+        } else if (!letter && start >= 0) {
+            if (i - start > 1) {
+                words.append(text.mid(start, i - start));
+            }
+            start = -1;
+        }
+    }
+    return words;
+}
+
+SuggestionIndex::SuggestionIndex()
+    : m_sortedTerms(0)
+    , m_deadEntries(0)
+    , m_generation(0)
+{
+}
+
+/**
+ * @brief SuggestionIndex::addHistory
+ * Adds a visit of the url, visits of an already known url are accumulated.
+ */
+void SuggestionIndex::addHistory(const QString &url, const QString &title, int visits, qint64 lastVisit)
+{
+    if (url.isEmpty()) {
+        return;
+    }
+
+    int index = entry(url, title);
+    Entry &e = m_entries[index];
+    if (e.sources == 0) {
+        --m_deadEntries;
+    }
+    e.sources |= History;
+    e.visits += visits;
+    e.lastVisit = qMax(e.lastVisit, lastVisit);
+}
+
+void SuggestionIndex::clearHistory()
+{
+    for (int i = 0; i < m_entries.count(); ++i) {
+        Entry &e = m_entries[i];
+        e.visits = 0;
+        e.lastVisit = 0;
+        removeSource(i, History);
+    }
+    compact();
+}
+
+/**
+ * @brief SuggestionIndex::setItems
+ * Replaces all items of a source. Entries shared with other sources are kept.
+ * @param items pairs of url and title
+ */
+void SuggestionIndex::setItems(Source source, const QList<Item> &items)
+{
+    foreach (int index, m_sourceEntries.value(source)) {
+        removeSource(index, source);
+    }
+
+    QVector<int> entries;
+    entries.reserve(items.count());
+    foreach (const Item &item, items) {
+        if (item.first.isEmpty()) {
+            continue;
+        }
+        int index = entry(item.first, item.second);
+        Entry &e = m_entries[index];
+        if (e.sources == 0) {
+            --m_deadEntries;
+        }
+        e.sources |= source;
+        entries.append(index);
+    }
+    m_sourceEntries.insert(source, entries);
+
+    if (m_deadEntries > gCompactThreshold && m_deadEntries > m_entries.count() / 2) {
+        compact();
+    }
+}
+
+void SuggestionIndex::updateTitle(const QString &url, const QString &title)
+{
+    QHash<QString, int>::const_iterator it = m_urls.constFind(url);
+    if (it != m_urls.constEnd() && m_entries.at(it.value()).title != title) {
+        setTitle(it.value(), title);
+    }
+}
+
+/**
+ * @brief SuggestionIndex::search
+ * Finds entries whose url or title contains all words of the text, the longest
+ * word is looked up from the prefix index. Empty text returns the best ranked
+ * entries.
+ * @param limit maximum number of suggestions
+ * @param budget milliseconds after which no more candidates are collected, 0 for no limit
+ * @param now current time in seconds, for tests
+ */
+QList<SuggestionIndex::Suggestion> SuggestionIndex::search(const QString &text, int limit, int budget, qint64 now)
+{
+    QElapsedTimer timer;
+    timer.start();
+    sortTerms();
+
+    if (now == 0) {
+        now = QDateTime::currentDateTimeUtc().toTime_t();
+    }
+
+    QStringList queryWords = normalizedUrl(text.trimmed()).split(QRegularExpression("\\s+"), QString::SkipEmptyParts);
+    QVector<QPair<qreal, int> > candidates;
+
+    if (queryWords.isEmpty()) {
+        candidates.reserve(m_entries.count() - m_deadEntries);
+        for (int i = 0; i < m_entries.count(); ++i) {
+            if (m_entries.at(i).sources) {
+                candidates.append(qMakePair(score(m_entries.at(i), QString(), now), i));
+            }
+        }
+    } else {
+        QString primary;
+        foreach (const QString &word, queryWords) {
+            if (word.length() > primary.length()) {
+                primary = word;
+            }
+        }
+
+        // Terms of urls are split at punctuation, the whole url is a term as well.
+        QStringList keys;
+        keys << primary;
+        QStringList primaryWords = words(primary);
+        if (!primaryWords.isEmpty() && primaryWords.first() != primary) {
+            keys << primaryWords.first();
+        }
+
+        if (++m_generation == 0) {
+            m_seen.fill(0);
+            m_generation = 1;
+        }
+        m_seen.resize(m_entries.count());
+
+        int checked = 0;
+        bool outOfTime = false;
+        foreach (const QString &key, keys) {
+            Term probe;
+            probe.key = key;
+            QVector<Term>::const_iterator it = std::lower_bound(m_terms.constBegin(), m_terms.constEnd(), probe);
+            for (; it != m_terms.constEnd() && it->key.startsWith(key); ++it) {
+                if (budget > 0 && ++checked % gBudgetCheckInterval == 0 && timer.elapsed() >= budget) {
+                    outOfTime = true;
+                    break;
+                }
+
+                int index = it->entry;
+                if (m_seen.at(index) == m_generation) {
+                    continue;
+                }
+                m_seen[index] = m_generation;
+
+                const Entry &e = m_entries.at(index);
+                if (e.sources && matches(e, queryWords)) {
+                    candidates.append(qMakePair(score(e, primary, now), index));
+                }
+            }
+            if (outOfTime) {
+                break;
+            }
+        }
+    }
+
+    int count = qMin(limit, candidates.count());
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), higherScore);
+
+    QList<Suggestion> suggestions;
+    suggestions.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const Entry &e = m_entries.at(candidates.at(i).second);
+        Suggestion suggestion;
+        suggestion.url = e.url;
+        suggestion.title = e.title;
+        suggestion.sources = e.sources;
+        suggestion.score = candidates.at(i).first;
+        suggestions.append(suggestion);
+    }
+    return suggestions;
+}
+
+int SuggestionIndex::count() const
+{
+    return m_entries.count() - m_deadEntries;
+}
+
+int SuggestionIndex::termCount() const
+{
+    return m_terms.count();
+}
+
+// Lower case url without scheme, leading www., and trailing slash.
+QString SuggestionIndex::normalizedUrl(const QString &url)
+{
+    QString normalized = url.toLower();
+    int scheme = normalized.indexOf(QLatin1String("://"));
+    if (scheme > 0 && scheme < 12) {
+        normalized.remove(0, scheme + 3);
+    }
+    if (normalized.startsWith(QLatin1String("www."))) {
+        normalized.remove(0, 4);
+    }
+    if (normalized.endsWith(QLatin1Char('/'))) {
+        normalized.chop(1);
+    }
+    return normalized;
+}
+
+QStringList SuggestionIndex::terms(const QString &url, const QString &title)
+{
+    QString normalized = normalizedUrl(url);
+    QStringList terms;
+    terms << normalized;
+    terms << words(normalized);
+    terms << words(title.toLower());
+    return terms.toSet().toList();
+}
+
+// Finds or creates the entry of the url. Created entries have no source yet.
+int SuggestionIndex::entry(const QString &url, const QString &title)
+{
+    QHash<QString, int>::const_iterator it = m_urls.constFind(url);
+    if (it != m_urls.constEnd()) {
+        if (!title.isEmpty() && m_entries.at(it.value()).title != title) {
+            setTitle(it.value(), title);
+        }
+        return it.value();
+    }
+
+    Entry e;
+    e.url = url;
+    e.title = title;
+    e.text = normalizedUrl(url) + QLatin1Char(' ') + title.toLower();
+    e.sources = 0;
+    e.visits = 0;
+    e.lastVisit = 0;
+    int index = m_entries.count();
+    m_entries.append(e);
+    m_urls.insert(url, index);
+    ++m_deadEntries;
+    addTerms(index);
+    return index;
+}
+
+// Terms of the old title stay in the index, matches() filters them out.
+void SuggestionIndex::setTitle(int index, const QString &title)
+{
+    Entry &e = m_entries[index];
+    e.title = title;
+    e.text = normalizedUrl(e.url) + QLatin1Char(' ') + title.toLower();
+    foreach (const QString &word, words(e.title.toLower())) {
+        Term term;
+        term.key = word;
+        term.entry = index;
+        m_terms.append(term);
+    }
+}
+
+void SuggestionIndex::addTerms(int index)
+{
+    const Entry &e = m_entries.at(index);
+    foreach (const QString &key, terms(e.url, e.title)) {
+        Term term;
+        term.key = key;
+        term.entry = index;
+        m_terms.append(term);
+    }
+}
+
+void SuggestionIndex::removeSource(int index, Source source)
+{
+    Entry &e = m_entries[index];
+    if (e.sources & source) {
+        e.sources &= ~source;
+        if (e.sources == 0) {
+            ++m_deadEntries;
+        }
+    }
+}
+
+// Terms added since the last search are sorted and merged to the sorted part.
+void SuggestionIndex::sortTerms()
+{
+    if (m_sortedTerms == m_terms.count()) {
+        return;
+    }
+
+    QVector<Term>::iterator middle = m_terms.begin() + m_sortedTerms;
+    std::sort(middle, m_terms.end());
+    std::inplace_merge(m_terms.begin(), middle, m_terms.end());
+    m_sortedTerms = m_terms.count();
+}
+
+// Drops entries without sources and rebuilds the terms.
+void SuggestionIndex::compact()
+{
+    if (m_deadEntries == 0) {
+        return;
+    }
+
+    QVector<Entry> entries;
+    QVector<int> newIndex(m_entries.count(), -1);
+    entries.reserve(m_entries.count() - m_deadEntries);
+    for (int i = 0; i < m_entries.count(); ++i) {
+        if (m_entries.at(i).sources) {
+            newIndex[i] = entries.count();
+            entries.append(m_entries.at(i));
+        }
+    }
+
+    m_entries = entries;
+    m_urls.clear();
+    m_terms.clear();
+    m_sortedTerms = 0;
+    m_deadEntries = 0;
+    m_seen.clear();
+    for (int i = 0; i < m_entries.count(); ++i) {
+        m_urls.insert(m_entries.at(i).url, i);
+        addTerms(i);
+    }
+
+    QHash<int, QVector<int> >::iterator it;
+    for (it = m_sourceEntries.begin(); it != m_sourceEntries.end(); ++it) {
+        QVector<int> remapped;
+        foreach (int index, it.value()) {
+            if (newIndex.at(index) >= 0) {
+                remapped.append(newIndex.at(index));
+            }
+        }
+        it.value() = remapped;
+    }
+}
+
+bool SuggestionIndex::matches(const Entry &entry, const QStringList &words) const
+{
+    foreach (const QString &word, words) {
+        if (!entry.text.contains(word)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Open tabs first, then bookmarks, then history by visits and recency. Urls
+// that start with the typed text and short urls are preferred.
+qreal SuggestionIndex::score(const Entry &entry, const QString &word, qint64 now) const
+{
+    qreal score = 0;
+    if (entry.sources & Tab) {
+        score += 6;
+    }
+    if (entry.sources & Bookmark) {
+        score += 4;
+    }
+    if (entry.sources & History) {
+        score += qLn(1 + entry.visits);
+        qint64 age = now - entry.lastVisit;
+        if (entry.lastVisit > 0 && age < gDay) {
+            score += 2;
+        } else if (entry.lastVisit > 0 && age < 7 * gDay) {
+            score += 1;
+        }
+    }
+    if (!word.isEmpty() && entry.text.startsWith(word)) {
+        score += 3;
+    }
+    return score - entry.url.length() / 100.0;
+}
@@ -0,0 +1,102 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SUGGESTIONINDEX_H
+#define SUGGESTIONINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * In-memory prefix index over history, bookmarks, and open tabs. Every url is
+ * one entry regardless of how many sources it comes from. Entries are found
+ * through a sorted array of terms, words of the title and the url, and ranked
+ * by their sources, visits, and how well they match.
+ *
+ * Not thread safe, owned by the DeclarativeSuggestionModel.
+ */
+class SuggestionIndex
+{
+public:
+    enum Source {
+        History = 0x1,
+        Bookmark = 0x2,
+        Tab = 0x4
+    };
+
+    struct Suggestion {
+        QString url;
+        QString title;
+        int sources;
+        qreal score;
+    };
+
+    typedef QPair<QString, QString> Item;
+
+    SuggestionIndex();
+
+    void addHistory(const QString &url, const QString &title, int visits = 1, qint64 lastVisit = 0);
+    void clearHistory();
+    void setItems(Source source, const QList<Item> &items);
+    void updateTitle(const QString &url, const QString &title);
+
+    QList<Suggestion> search(const QString &text, int limit, int budget = 0, qint64 now = 0);
+
+    int count() const;
+    int termCount() const;
+
+    static QString normalizedUrl(const QString &url);
+    static QStringList terms(const QString &url, const QString &title);
+
+private:
+    struct Entry {
+        QString url;
+        QString title;
+        // Lower case url and title, used to verify all words of a query.
+        QString text;
+        int sources;
+        int visits;
+        qint64 lastVisit;
+    };
+
+    struct Term {
+        QString key;
+        int entry;
+        bool operator<(const Term &other) const { return key < other.key; }
+    };
+
+    int entry(const QString &url, const QString &title);
+    void setTitle(int index, const QString &title);
+    void addTerms(int index);
+    void removeSource(int index, Source source);
+    void sortTerms();
+    void compact();
+    bool matches(const Entry &entry, const QStringList &words) const;
+    qreal score(const Entry &entry, const QString &word, qint64 now) const;
+
+    QVector<Entry> m_entries;
+    QHash<QString, int> m_urls;
+    // Sorted up to m_sortedTerms, terms added after that are merged on the next search.
+    QVector<Term> m_terms;
+    int m_sortedTerms;
+    // Entries of each source other than history, replaced by setItems.
+    QHash<int, QVector<int> > m_sourceEntries;
+    int m_deadEntries;
+    // Marks entries already collected during a search.
+    QVector<quint32> m_seen;
+    quint32 m_generation;
+};
+
+#endif // SUGGESTIONINDEX_H
@@ -71,6 +71,16 @@ void Tab::setThumbnailPath(const QString &thumbnailPath)
     m_currentLink.setThumbPath(thumbnailPath);
 }
 
+QByteArray Tab::thumbnailPlaceholder() const
+{
+    return m_currentLink.thumbPlaceholder();
+}
+
+void Tab::setThumbnailPlaceholder(const QByteArray &thumbnailPlaceholder)
+{
+    m_currentLink.setThumbPlaceholder(thumbnailPlaceholder);
+}
+
 QString Tab::title() const
 {
     return m_currentLink.title();
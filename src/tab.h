@@ -41,6 +41,9 @@ public:
     QString thumbnailPath() const;
     void setThumbnailPath(const QString &thumbnailPath);
 
+    QByteArray thumbnailPlaceholder() const;
+    void setThumbnailPlaceholder(const QByteArray &thumbnailPlaceholder);
+
     QString title() const;
     void setTitle(const QString &title);
 
@@ -0,0 +1,42 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "tabthumbnailprovider.h"
+#include "thumbnailcache.h"
+
+#include <QDebug>
+
+TabThumbnailProvider::TabThumbnailProvider()
+    : QQuickImageProvider(QQuickImageProvider::Image)
+{
+}
+
+QImage TabThumbnailProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
+{
+    // Revision is only there to make QML reload the image.
+    bool ok = false;
+    int tabId = id.section(QLatin1Char('/'), 0, 0).toInt(&ok);
+    if (!ok) {
+        qWarning() << Q_FUNC_INFO << "invalid thumbnail id" << id;
+        return QImage();
+    }
+
+    QImage image = ThumbnailCache::instance()->image(ThumbnailCache::tabKey(tabId));
+    if (size) {
+        *size = image.size();
+    }
+
+    if (!image.isNull() && requestedSize.isValid()
+            && (requestedSize.width() < image.width() || requestedSize.height() < image.height())) {
+        image = image.scaled(requestedSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    return image;
+}
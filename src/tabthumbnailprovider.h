@@ -0,0 +1,29 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef TABTHUMBNAILPROVIDER_H
+#define TABTHUMBNAILPROVIDER_H
+
+#include <QQuickImageProvider>
+
+/**
+ * Serves tab thumbnails from ThumbnailCache. Image urls are of form
+ * image://tabthumb/<tabId>/<revision>.
+ */
+class TabThumbnailProvider : public QQuickImageProvider
+{
+public:
+    TabThumbnailProvider();
+
+    QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize);
+};
+
+#endif // TABTHUMBNAILPROVIDER_H
@@ -0,0 +1,394 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "thumbnailcache.h"
+
+#include <QBuffer>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QMutexLocker>
+#include <QStandardPaths>
+
+static const char * const gThumbnailPattern = "tab-*-thumb.*";
+static const int gDefaultQuality = 85;
+static const qint64 gDefaultBudget = 4 * 1024 * 1024;
+static const int gPlaceholderSize = 32;
+static const int gPlaceholderQuality = 50;
+// Number of decoded thumbnails kept in memory.
+static const int gMaxImages = 8;
+
+Q_GLOBAL_STATIC(ThumbnailCache, gThumbnailCache)
+
+ThumbnailCache::ThumbnailCache(const QString &directory)
+    : m_directory(directory)
+    , m_encoder(JpegEncoder)
+    , m_quality(gDefaultQuality)
+    , m_resolution(MediumResolution)
+    , m_budget(gDefaultBudget)
+    , m_totalSize(0)
+    , m_usageCounter(0)
+    , m_loaded(false)
+{
+    if (m_directory.isEmpty()) {
+        m_directory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    }
+}
+
+ThumbnailCache *ThumbnailCache::instance()
+{
+    return gThumbnailCache();
+}
+
+QString ThumbnailCache::tabKey(int tabId)
+{
+    return QString("tab-%1-thumb").arg(tabId);
+}
+
+QString ThumbnailCache::keyForPath(const QString &path)
+{
+    // Older databases contain absolute paths of png files.
+    return path.isEmpty() ? QString() : QFileInfo(path).completeBaseName();
+}
+
+/**
+ * @brief ThumbnailCache::placeholder
+ * Tiny version of the thumbnail that is small enough to be stored inline to the
+ * database and decoded for all tabs at once.
+ */
+QByteArray ThumbnailCache::placeholder(const QImage &image)
+{
+    QByteArray data;
+    if (image.isNull()) {
+        return data;
+    }
+
+    QImage small = image.scaled(gPlaceholderSize, gPlaceholderSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    if (!small.save(&buffer, "JPG", gPlaceholderQuality)) {
+        qWarning() << Q_FUNC_INFO << "failed to encode placeholder";
+        data.clear();
+    }
+    return data;
+}
+
+QString ThumbnailCache::placeholderUrl(const QByteArray &placeholder)
+{
+    if (placeholder.isEmpty()) {
+        return QString();
+    }
+    return QString("data:image/jpeg;base64,%1").arg(QString::fromLatin1(placeholder.toBase64()));
+}
+
+ThumbnailCache::Encoder ThumbnailCache::encoder() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_encoder;
+}
+
+void ThumbnailCache::setEncoder(Encoder encoder)
+{
+    QMutexLocker lock(&m_mutex);
+    m_encoder = encoder;
+}
+
+int ThumbnailCache::quality() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_quality;
+}
+
+void ThumbnailCache::setQuality(int quality)
+{
+    QMutexLocker lock(&m_mutex);
+    m_quality = qBound(0, quality, 100);
+}
+
+ThumbnailCache::Resolution ThumbnailCache::resolution() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_resolution;
+}
+
+void ThumbnailCache::setResolution(Resolution resolution)
+{
+    QMutexLocker lock(&m_mutex);
+    m_resolution = resolution;
+}
+
+int ThumbnailCache::thumbnailSize(int screenWidth) const
+{
+    switch (resolution()) {
+    case LowResolution:
+        return screenWidth / 4;
+    case MediumResolution:
+        // Size of the tab grid items and the active tab thumbnail of the TabPage.
+        return screenWidth / 2;
+    default:
+        return screenWidth;
+    }
+}
+
+qint64 ThumbnailCache::budget() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_budget;
+}
+
+void ThumbnailCache::setBudget(qint64 bytes)
+{
+    QMutexLocker lock(&m_mutex);
+    m_budget = bytes;
+    load();
+    evict(QString());
+}
+
+qint64 ThumbnailCache::totalSize() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_totalSize;
+}
+
+int ThumbnailCache::count() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_index.count();
+}
+
+/**
+ * @brief ThumbnailCache::store
+ * Encodes the image with the current encoder and stores it with the key. Encoding
+ * is done without holding the lock, only the file write is serialized.
+ * @return absolute path of the stored thumbnail or an empty string on failure.
+ */
+QString ThumbnailCache::store(const QString &key, const QImage &image)
+{
+    if (key.isEmpty() || image.isNull()) {
+        return QString();
+    }
+
+    Encoder encoder = this->encoder();
+    int quality = encoder == JpegEncoder ? this->quality() : -1;
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    if (!image.save(&buffer, encoder == JpegEncoder ? "JPG" : "PNG", quality)) {
+        qWarning() << Q_FUNC_INFO << "failed to encode thumbnail" << key;
+        return QString();
+    }
+
+    QMutexLocker lock(&m_mutex);
+    load();
+    QString fileName = key + (encoder == JpegEncoder ? QStringLiteral(".jpg") : QStringLiteral(".png"));
+    QString path = QDir(m_directory).absoluteFilePath(fileName);
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size()) {
+        qWarning() << Q_FUNC_INFO << "failed to save thumbnail" << path;
+        return QString();
+    }
+    file.close();
+
+    if (m_index.contains(key)) {
+        Entry &old = m_index[key];
+        if (old.fileName != fileName) {
+            removeEntry(key);
+        } else {
+            m_totalSize -= old.bytes;
+        }
+    }
+
+    Entry entry;
+    entry.fileName = fileName;
+    entry.bytes = data.size();
+    entry.lastUsed = ++m_usageCounter;
+    m_index.insert(key, entry);
+    m_totalSize += entry.bytes;
+    evict(key);
+    return path;
+}
+
+/**
+ * @brief ThumbnailCache::path
+ * Resolves key to an absolute path and marks the thumbnail as recently used.
+ * @return empty string if the thumbnail is not in the cache.
+ */
+QString ThumbnailCache::path(const QString &key)
+{
+    QString k = key.contains(QLatin1Char('/')) ? keyForPath(key) : key;
+    QMutexLocker lock(&m_mutex);
+    load();
+    QHash<QString, Entry>::iterator it = m_index.find(k);
+    if (it == m_index.end()) {
+        return QString();
+    }
+    it->lastUsed = ++m_usageCounter;
+    return QDir(m_directory).absoluteFilePath(it->fileName);
+}
+
+bool ThumbnailCache::contains(const QString &key)
+{
+    QMutexLocker lock(&m_mutex);
+    load();
+    return m_index.contains(key);
+}
+
+void ThumbnailCache::remove(const QString &key)
+{
+    QString k = key.contains(QLatin1Char('/')) ? keyForPath(key) : key;
+    QMutexLocker lock(&m_mutex);
+    load();
+    removeEntry(k);
+    m_images.remove(k);
+}
+
+/**
+ * @brief ThumbnailCache::setImage
+ * Keeps the decoded image in memory until it gets pushed out by newer images.
+ * @return revision of the image.
+ */
+int ThumbnailCache::setImage(const QString &key, const QImage &image)
+{
+    QMutexLocker lock(&m_mutex);
+    insertImage(key, image);
+    return ++m_revisions[key];
+}
+
+/**
+ * @brief ThumbnailCache::image
+ * Returns the image from memory or decodes it from disk. Decoding is done
+ * without holding the lock.
+ */
+QImage ThumbnailCache::image(const QString &key)
+{
+    QString path;
+    {
+        QMutexLocker lock(&m_mutex);
+        QHash<QString, CachedImage>::iterator it = m_images.find(key);
+        if (it != m_images.end()) {
+            it->lastUsed = ++m_usageCounter;
+            return it->image;
+        }
+        load();
+        if (!m_index.contains(key)) {
+            return QImage();
+        }
+        path = QDir(m_directory).absoluteFilePath(m_index.value(key).fileName);
+    }
+
+    QImage image(path);
+    if (!image.isNull()) {
+        QMutexLocker lock(&m_mutex);
+        // Newer image may have been set while decoding.
+        if (!m_images.contains(key)) {
+            insertImage(key, image);
+        }
+    }
+    return image;
+}
+
+QString ThumbnailCache::imageUrl(int tabId)
+{
+    QString key = tabKey(tabId);
+    QMutexLocker lock(&m_mutex);
+    load();
+    if (!m_images.contains(key) && !m_index.contains(key)) {
+        return QString();
+    }
+    return QString("image://tabthumb/%1/%2").arg(tabId).arg(m_revisions.value(key));
+}
+
+// Called with the lock held. Builds the index from the cache directory,
+// thumbnails written earlier are treated as less recently used.
+void ThumbnailCache::load()
+{
+    if (m_loaded) {
+        return;
+    }
+    m_loaded = true;
+
+    QDir dir(m_directory);
+    if (!dir.exists() && !dir.mkpath(m_directory)) {
+        qWarning() << "Can't create directory " + m_directory;
+        return;
+    }
+
+    QFileInfoList files = dir.entryInfoList(QStringList() << QLatin1String(gThumbnailPattern),
+                                            QDir::Files, QDir::Time | QDir::Reversed);
+    foreach (const QFileInfo &fileInfo, files) {
+        QString key = fileInfo.completeBaseName();
+        if (m_index.contains(key)) {
+            // Same thumbnail stored with an older encoder.
+            removeEntry(key);
+        }
+        Entry entry;
+        entry.fileName = fileInfo.fileName();
+        entry.bytes = fileInfo.size();
+        entry.lastUsed = ++m_usageCounter;
+        m_index.insert(key, entry);
+        m_totalSize += entry.bytes;
+    }
+    evict(QString());
+}
+
+// Called with the lock held.
+void ThumbnailCache::removeEntry(const QString &key)
+{
+    QHash<QString, Entry>::iterator it = m_index.find(key);
+    if (it != m_index.end()) {
+        m_totalSize -= it->bytes;
+        QFile::remove(QDir(m_directory).absoluteFilePath(it->fileName));
+        m_index.erase(it);
+    }
+}
+
+// Called with the lock held.
+void ThumbnailCache::insertImage(const QString &key, const QImage &image)
+{
+    CachedImage cached;
+    cached.image = image;
+    cached.lastUsed = ++m_usageCounter;
+    m_images.insert(key, cached);
+
+    while (m_images.count() > gMaxImages) {
+        QHash<QString, CachedImage>::iterator oldest = m_images.end();
+        QHash<QString, CachedImage>::iterator it;
+        for (it = m_images.begin(); it != m_images.end(); ++it) {
+            if (it.key() != key && (oldest == m_images.end() || it->lastUsed < oldest->lastUsed)) {
+                oldest = it;
+            }
+        }
+        m_images.erase(oldest);
+    }
+}
+
+// Called with the lock held. Evicts least recently used thumbnails, except keep,
+// until total size fits to the budget.
+void ThumbnailCache::evict(const QString &keep)
+{
+    while (m_totalSize > m_budget && m_index.count() > (m_index.contains(keep) ? 1 : 0)) {
+        QString oldestKey;
+        quint64 oldest = 0;
+        QHash<QString, Entry>::const_iterator it;
+        for (it = m_index.constBegin(); it != m_index.constEnd(); ++it) {
+            if (it.key() != keep && (oldestKey.isEmpty() || it->lastUsed < oldest)) {
+                oldestKey = it.key();
+                oldest = it->lastUsed;
+            }
+        }
+#ifdef DEBUG_LOGS
+        qDebug() << "evict thumbnail:" << oldestKey << m_totalSize << m_budget;
+#endif
+        removeEntry(oldestKey);
+    }
+}
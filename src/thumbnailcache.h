@@ -0,0 +1,113 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef THUMBNAILCACHE_H
+#define THUMBNAILCACHE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QImage>
+
+/**
+ * Size bounded store of encoded tab thumbnails. Thumbnails are addressed
+ * by keys which are stored to the database instead of file paths. Least
+ * recently used thumbnails are evicted once the total size exceeds budget.
+ *
+ * Latest thumbnails are also kept decoded in memory and served to QML through
+ * the tabthumb image provider. Disk acts as a backing store for them.
+ *
+ * Thread safe: thumbnails are stored from the capture worker and resolved
+ * from the database thread and the GUI thread.
+ */
+class ThumbnailCache
+{
+public:
+    enum Encoder {
+        JpegEncoder,
+        PngEncoder
+    };
+
+    // Thumbnail edge length relative to the screen width.
+    enum Resolution {
+        LowResolution,
+        MediumResolution,
+        HighResolution
+    };
+
+    explicit ThumbnailCache(const QString &directory = QString());
+
+    static ThumbnailCache *instance();
+
+    static QString tabKey(int tabId);
+    static QString keyForPath(const QString &path);
+    static QByteArray placeholder(const QImage &image);
+    static QString placeholderUrl(const QByteArray &placeholder);
+
+    Encoder encoder() const;
+    void setEncoder(Encoder encoder);
+
+    int quality() const;
+    void setQuality(int quality);
+
+    Resolution resolution() const;
+    void setResolution(Resolution resolution);
+    int thumbnailSize(int screenWidth) const;
+
+    qint64 budget() const;
+    void setBudget(qint64 bytes);
+    qint64 totalSize() const;
+    int count() const;
+
+    QString store(const QString &key, const QImage &image);
+    QString path(const QString &key);
+    bool contains(const QString &key);
+    void remove(const QString &key);
+
+    int setImage(const QString &key, const QImage &image);
+    QImage image(const QString &key);
+    QString imageUrl(int tabId);
+
+private:
+    struct Entry {
+        QString fileName;
+        qint64 bytes;
+        quint64 lastUsed;
+    };
+
+    struct CachedImage {
+        QImage image;
+        quint64 lastUsed;
+    };
+
+    void load();
+    void removeEntry(const QString &key);
+    void evict(const QString &keep);
+    void insertImage(const QString &key, const QImage &image);
+
+    mutable QMutex m_mutex;
+    QString m_directory;
+    QHash<QString, Entry> m_index;
+    QHash<QString, CachedImage> m_images;
+    // Revision of the latest image per key. Part of the image url so that
+    // QML reloads the image when it changes.
+    QHash<QString, int> m_revisions;
+    Encoder m_encoder;
+    int m_quality;
+    Resolution m_resolution;
+    qint64 m_budget;
+    qint64 m_totalSize;
+    quint64 m_usageCounter;
+    bool m_loaded;
+};
+
+#endif // THUMBNAILCACHE_H
@@ -0,0 +1,123 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "transferprogressthrottle.h"
+
+#include <QTimerEvent>
+
+// Smallest change of progress that is sent right away.
+static const qreal gMinProgressStep = 0.01;
+// Changes smaller than gMinProgressStep are sent after this many milliseconds.
+static const qint64 gMaxUpdateInterval = 500;
+// Due updates are collected for this many milliseconds and sent together.
+static const int gFlushInterval = 100;
+
+TransferProgressThrottle::TransferProgressThrottle(QObject *parent)
+    : QObject(parent)
+    , m_flushTimer(0)
+{
+    m_clock.start();
+}
+
+void TransferProgressThrottle::update(int transferId, qreal progress)
+{
+    QHash<int, Progress>::iterator it = m_transfers.find(transferId);
+    if (it == m_transfers.end()) {
+        Progress initial;
+        initial.sent = -1;
+        initial.sentTime = 0;
+        initial.pending = 0;
+        initial.hasPending = false;
+        it = m_transfers.insert(transferId, initial);
+    }
+
+    if (qFuzzyCompare(1 + progress, 1 + it->sent)) {
+        it->hasPending = false;
+        return;
+    }
+
+    it->pending = progress;
+    it->hasPending = true;
+    if (!m_flushTimer) {
+        m_flushTimer = startTimer(gFlushInterval);
+    }
+}
+
+/**
+ * @brief TransferProgressThrottle::finish
+ * Sends progress held back for the transfer immediately and forgets the transfer.
+ * Must be called before the transfer is finished in the transfer engine.
+ */
+void TransferProgressThrottle::finish(int transferId)
+{
+    QHash<int, Progress>::iterator it = m_transfers.find(transferId);
+    if (it == m_transfers.end()) {
+        return;
+    }
+
+    if (it->hasPending) {
+        send(transferId, *it, m_clock.elapsed());
+    }
+    m_transfers.erase(it);
+}
+
+bool TransferProgressThrottle::hasPending() const
+{
+    foreach (const Progress &progress, m_transfers) {
+        if (progress.hasPending) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void TransferProgressThrottle::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() != m_flushTimer) {
+        return;
+    }
+
+    qint64 now = m_clock.elapsed();
+    bool pending = false;
+    QHash<int, Progress>::iterator it;
+    for (it = m_transfers.begin(); it != m_transfers.end(); ++it) {
+        if (!it->hasPending) {
+            continue;
+        }
+        if (isDue(*it, now)) {
+            send(it.key(), *it, now);
+        } else {
+            pending = true;
+        }
+    }
+
+    // Timer keeps running only while small changes are waiting for their interval.
+    if (!pending) {
+        killTimer(m_flushTimer);
+        m_flushTimer = 0;
+    }
+}
+
+bool TransferProgressThrottle::isDue(const Progress &progress, qint64 now) const
+{
+    return progress.sent < 0
+            || progress.pending >= 1.0
+            || qAbs(progress.pending - progress.sent) >= gMinProgressStep
+            || now - progress.sentTime >= gMaxUpdateInterval;
+}
+
+void TransferProgressThrottle::send(int transferId, Progress &progress, qint64 now)
+{
+    progress.sent = progress.pending;
+    progress.sentTime = now;
+    progress.hasPending = false;
+    emit progressChanged(transferId, progress.sent);
+}
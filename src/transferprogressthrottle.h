@@ -0,0 +1,60 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef TRANSFERPROGRESSTHROTTLE_H
+#define TRANSFERPROGRESSTHROTTLE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+
+class QTimerEvent;
+
+/**
+ * Rate limits progress updates sent to the transfer engine. Progress of a
+ * transfer is passed on when it has advanced by a percent or when the previous
+ * update is older than half a second. Due updates of all transfers are emitted
+ * together on one timer tick so that the transfer engine wakes up once for them.
+ */
+class TransferProgressThrottle : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TransferProgressThrottle(QObject *parent = 0);
+
+    void update(int transferId, qreal progress);
+    void finish(int transferId);
+    bool hasPending() const;
+
+signals:
+    void progressChanged(int transferId, qreal progress);
+
+protected:
+    void timerEvent(QTimerEvent *event);
+
+private:
+    struct Progress {
+        qreal sent;
+        qint64 sentTime;
+        qreal pending;
+        bool hasPending;
+    };
+
+    bool isDue(const Progress &progress, qint64 now) const;
+    void send(int transferId, Progress &progress, qint64 now);
+
+    QHash<int, Progress> m_transfers;
+    QElapsedTimer m_clock;
+    int m_flushTimer;
+};
+
+#endif // TRANSFERPROGRESSTHROTTLE_H
@@ -12,6 +12,7 @@
 #include "webpages.h"
 #include "declarativewebcontainer.h"
 #include "declarativewebpage.h"
+#include "webpagescheduler.h"
 
 #include <QQmlComponent>
 #include <QQmlEngine>
@@ -28,7 +29,10 @@ WebPages::WebPages(QObject *parent)
     : QObject(parent)
     , m_activePage(0)
     , m_count(0)
+    , m_scheduler(new WebPageScheduler(this))
 {
+    connect(m_scheduler, SIGNAL(suspendRequested(int)), this, SLOT(suspendPage(int)));
+    connect(m_scheduler, SIGNAL(virtualizeRequested(int)), this, SIGNAL(virtualizeRequested(int)));
 }
 
 WebPages::~WebPages()
@@ -46,6 +50,7 @@ void WebPages::initialize(DeclarativeWebContainer *webContainer, QQmlComponent *
     if (!m_webContainer || !m_webPageComponent) {
         m_webContainer = webContainer;
         m_webPageComponent = webPageComponent;
+        schedule();
     }
 }
 
@@ -129,6 +134,7 @@ void WebPages::release(int tabId, bool virtualize)
     dumpPages();
 #endif
     if (pageEntry) {
+        m_scheduler->remove(tabId);
         --m_count;
         DeclarativeWebPage *activeWebPage = m_activePage && m_activePage->webPage ? m_activePage->webPage : 0;
         if (m_count == 0 || (activeWebPage && activeWebPage->tabId() == tabId)) {
@@ -151,6 +157,18 @@ void WebPages::release(int tabId, bool virtualize)
 #endif
 }
 
+/**
+ * @brief WebPages::postponeVirtualize
+ * Keeps a page whose virtualization was requested but could not be done yet
+ * scheduled, the request is repeated later.
+ */
+void WebPages::postponeVirtualize(int tabId)
+{
+    if (m_activePages.contains(tabId)) {
+        m_scheduler->add(tabId);
+    }
+}
+
 int WebPages::parentTabId(int tabId) const
 {
     WebPageEntry *pageEntry = m_activePages.value(tabId, 0);
@@ -168,20 +186,33 @@ int WebPages::parentTabId(int tabId) const
     return 0;
 }
 
+void WebPages::schedule()
+{
+    if (m_webContainer) {
+        m_scheduler->setBatteryPowered(m_webContainer->batteryPowered());
+        m_scheduler->setBackground(m_webContainer->background());
+    }
+}
+
+void WebPages::suspendPage(int tabId)
+{
+    WebPageEntry *pageEntry = m_activePages.value(tabId, 0);
+    if (pageEntry && pageEntry->webPage) {
+        if (pageEntry->webPage->loading()) {
+            pageEntry->webPage->stop();
+        }
+        pageEntry->webPage->suspendView();
+    }
+}
+
 void WebPages::updateActivePage(WebPageEntry *webPageEntry, bool resurrect)
 {
     DeclarativeWebPage * activeWebPage = 0;
     if (m_activePage && (activeWebPage = m_activePage->webPage)) {
+        delete m_activePage->cssContentRect;
         m_activePage->cssContentRect = new QRectF(activeWebPage->contentRect());
         activeWebPage->setVisible(false);
-
-        // Allow subpending only current active is not creator (parent).
-        if (webPageEntry->webPage->parentId() != (int)activeWebPage->uniqueID()) {
-             if (activeWebPage->loading()) {
-                 activeWebPage->stop();
-             }
-             activeWebPage->suspendView();
-        }
+        m_scheduler->deactivate(activeWebPage->tabId());
     }
 
     m_activePage = webPageEntry;
@@ -196,6 +227,8 @@ void WebPages::updateActivePage(WebPageEntry *webPageEntry, bool resurrect)
     if (activeWebPage) {
         activeWebPage->resumeView();
         activeWebPage->setVisible(true);
+        m_scheduler->activate(activeWebPage->tabId());
+        m_scheduler->setKeptAlive(parentTabId(activeWebPage->tabId()));
     }
 }
 
@@ -208,6 +241,7 @@ void WebPages::dumpPages() const
         WebPageEntry *pageEntry = pages.value();
         qDebug() << "tabId: " << pages.key() << "page: " << pageEntry->webPage
                  << "title:" << (pageEntry->webPage ? pageEntry->webPage->title() : "VIEW NOT ALIVE!")
+                 << "stage:" << m_scheduler->stage(pages.key())
                  << "cssContentRect:" << pageEntry->cssContentRect;
     }
     qDebug() << "---- end ------";
@@ -19,6 +19,7 @@
 class QQmlComponent;
 class DeclarativeWebContainer;
 class DeclarativeWebPage;
+class WebPageScheduler;
 
 struct WebPageActivationData {
     WebPageActivationData(DeclarativeWebPage *webPage, bool activated)
@@ -44,9 +45,19 @@ public:
 
     WebPageActivationData page(int tabId, int parentId = 0);
     void release(int tabId, bool virtualize = false);
+    void postponeVirtualize(int tabId);
     int parentTabId(int tabId) const;
     void dumpPages() const;
 
+public slots:
+    void schedule();
+
+signals:
+    void virtualizeRequested(int tabId);
+
+private slots:
+    void suspendPage(int tabId);
+
 private:
     struct WebPageEntry {
         WebPageEntry(DeclarativeWebPage *webPage, QRectF *cssContentRect);
@@ -64,6 +75,7 @@ private:
     QMap<int, WebPageEntry*> m_activePages;
     WebPageEntry *m_activePage;
     int m_count;
+    WebPageScheduler *m_scheduler;
 };
 
 #endif
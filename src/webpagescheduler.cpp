@@ -0,0 +1,257 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "webpagescheduler.h"
+
+#include <QFile>
+#include <QList>
+#include <QMapIterator>
+#include <QThread>
+#include <QTimerEvent>
+
+// Idle times (ms) after which an inactive page is moved to the next stage.
+static const int gSuspendTimeout = 4000;
+static const int gVirtualizeTimeout = 10 * 60 * 1000;
+// Idle times are divided by this for each of battery power, high cpu load, and background.
+static const int gPowerSaveDivisor = 4;
+
+WebPageScheduler::WebPageScheduler(QObject *parent)
+    : QObject(parent)
+    , m_keptAlive(0)
+    , m_suspendTimeout(gSuspendTimeout)
+    , m_virtualizeTimeout(gVirtualizeTimeout)
+    , m_loadAverageFile(QStringLiteral("/proc/loadavg"))
+    , m_batteryPowered(false)
+    , m_background(false)
+    , m_timer(0)
+{
+}
+
+void WebPageScheduler::setTimeouts(int suspendTimeout, int virtualizeTimeout)
+{
+    m_suspendTimeout = suspendTimeout;
+    m_virtualizeTimeout = virtualizeTimeout;
+    schedule();
+}
+
+void WebPageScheduler::setLoadAverageFile(const QString &fileName)
+{
+    m_loadAverageFile = fileName;
+}
+
+void WebPageScheduler::setBatteryPowered(bool batteryPowered)
+{
+    if (m_batteryPowered != batteryPowered) {
+        m_batteryPowered = batteryPowered;
+        schedule();
+    }
+}
+
+void WebPageScheduler::setBackground(bool background)
+{
+    if (m_background != background) {
+        m_background = background;
+        schedule();
+    }
+}
+
+/**
+ * @brief WebPageScheduler::activate
+ * Active page is painted and never idles.
+ */
+void WebPageScheduler::activate(int tabId)
+{
+    if (m_pages.remove(tabId)) {
+        schedule();
+    }
+}
+
+/**
+ * @brief WebPageScheduler::deactivate
+ * Hidden page is not painted anymore, it is suspended once it has been idle long enough.
+ */
+void WebPageScheduler::deactivate(int tabId)
+{
+    IdlePage page;
+    page.stage = Throttled;
+    page.idleTime.start();
+    page.retry = false;
+    m_pages.insert(tabId, page);
+    schedule();
+}
+
+/**
+ * @brief WebPageScheduler::add
+ * Hands back a page that could not be virtualized when requested. The page stays
+ * suspended and virtualization is requested again after another suspend timeout.
+ */
+void WebPageScheduler::add(int tabId)
+{
+    IdlePage page;
+    page.stage = Suspended;
+    page.idleTime.start();
+    page.retry = true;
+    m_pages.insert(tabId, page);
+    schedule();
+}
+
+void WebPageScheduler::remove(int tabId)
+{
+    activate(tabId);
+}
+
+/**
+ * @brief WebPageScheduler::setKeptAlive
+ * Creator (parent) of the active page is kept alive so that it can still script its child.
+ */
+void WebPageScheduler::setKeptAlive(int tabId)
+{
+    if (m_keptAlive != tabId) {
+        m_keptAlive = tabId;
+        schedule();
+    }
+}
+
+WebPageScheduler::Stage WebPageScheduler::stage(int tabId) const
+{
+    return m_pages.contains(tabId) ? m_pages.value(tabId).stage : Active;
+}
+
+void WebPageScheduler::timerEvent(QTimerEvent *event)
+{
+    if (m_timer == event->timerId()) {
+        killTimer(m_timer);
+        m_timer = 0;
+        updateStages();
+    }
+}
+
+void WebPageScheduler::updateStages()
+{
+    int factor = powerSaveFactor();
+    bool loadRead = false;
+    bool highLoad = false;
+    QList<int> suspend;
+    QList<int> virtualize;
+
+    QMutableMapIterator<int, IdlePage> pages(m_pages);
+    while (pages.hasNext()) {
+        pages.next();
+        if (pages.key() == m_keptAlive) {
+            continue;
+        }
+
+        IdlePage &page = pages.value();
+        qint64 idle = page.idleTime.elapsed();
+        if (page.stage == Throttled && deadlineReached(idle, m_suspendTimeout / factor, &loadRead, &highLoad)) {
+            page.stage = Suspended;
+            suspend << pages.key();
+        }
+
+        if (page.stage == Suspended && deadlineReached(idle, virtualizeTimeout(page) / factor, &loadRead, &highLoad)) {
+            virtualize << pages.key();
+            pages.remove();
+        }
+    }
+
+    schedule();
+
+    // Receivers release pages, thus emit only after iterating.
+    foreach (int tabId, suspend) {
+        emit suspendRequested(tabId);
+    }
+    foreach (int tabId, virtualize) {
+        emit virtualizeRequested(tabId);
+    }
+}
+
+int WebPageScheduler::virtualizeTimeout(const IdlePage &page) const
+{
+    return page.retry ? m_suspendTimeout : m_virtualizeTimeout;
+}
+
+/**
+ * @brief WebPageScheduler::deadlineReached
+ * Deadline is reached after the full idle time, or after the idle time shortened
+ * for high cpu load if the load is high. Load is read at most once per update.
+ */
+bool WebPageScheduler::deadlineReached(qint64 idle, int deadline, bool *loadRead, bool *highLoad) const
+{
+    if (idle >= deadline) {
+        return true;
+    }
+    if (idle < deadline / gPowerSaveDivisor) {
+        return false;
+    }
+    if (!*loadRead) {
+        *highLoad = highCpuLoad();
+        *loadRead = true;
+    }
+    return *highLoad;
+}
+
+/**
+ * @brief WebPageScheduler::schedule
+ * Restarts the timer for the nearest deadline. A page past its shortened deadline
+ * had the load checked then and waits for the full idle time.
+ */
+void WebPageScheduler::schedule()
+{
+    if (m_timer) {
+        killTimer(m_timer);
+        m_timer = 0;
+    }
+
+    int factor = powerSaveFactor();
+    qint64 next = -1;
+    QMapIterator<int, IdlePage> pages(m_pages);
+    while (pages.hasNext()) {
+        pages.next();
+        if (pages.key() == m_keptAlive) {
+            continue;
+        }
+
+        const IdlePage &page = pages.value();
+        qint64 idle = page.idleTime.elapsed();
+        int deadline = (page.stage == Throttled ? m_suspendTimeout : virtualizeTimeout(page)) / factor;
+        int shortened = deadline / gPowerSaveDivisor;
+        qint64 remaining = idle < shortened ? shortened - idle : qMax<qint64>(0, deadline - idle);
+        if (next < 0 || remaining < next) {
+            next = remaining;
+        }
+    }
+
+    if (next >= 0) {
+        m_timer = startTimer(next);
+    }
+}
+
+int WebPageScheduler::powerSaveFactor() const
+{
+    int factor = 1;
+    if (m_batteryPowered) {
+        factor *= gPowerSaveDivisor;
+    }
+    if (m_background) {
+        factor *= gPowerSaveDivisor;
+    }
+    return factor;
+}
+
+bool WebPageScheduler::highCpuLoad() const
+{
+    QFile loadAvg(m_loadAverageFile);
+    if (loadAvg.open(QIODevice::ReadOnly)) {
+        // First field is the one minute load average.
+        return loadAvg.readLine().split(' ').value(0).toFloat() > QThread::idealThreadCount();
+    }
+    return false;
+}
@@ -0,0 +1,88 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef WEBPAGESCHEDULER_H
+#define WEBPAGESCHEDULER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QString>
+
+class QTimerEvent;
+
+/**
+ * Moves inactive pages from throttled (hidden) to suspended and from suspended
+ * to virtualized based on how long they have been idle. Idle times are shortened
+ * when running on battery, under high cpu load, or when the browser is in
+ * background. A single timer runs until the next deadline, cpu load is read only
+ * when a deadline that it can shorten has been reached.
+ */
+class WebPageScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Stage {
+        Active,
+        Throttled,
+        Suspended
+    };
+
+    explicit WebPageScheduler(QObject *parent = 0);
+
+    void setTimeouts(int suspendTimeout, int virtualizeTimeout);
+    void setLoadAverageFile(const QString &fileName);
+
+    void setBatteryPowered(bool batteryPowered);
+    void setBackground(bool background);
+
+    void activate(int tabId);
+    void deactivate(int tabId);
+    void add(int tabId);
+    void remove(int tabId);
+    void setKeptAlive(int tabId);
+    Stage stage(int tabId) const;
+
+signals:
+    void suspendRequested(int tabId);
+    void virtualizeRequested(int tabId);
+
+protected:
+    void timerEvent(QTimerEvent *event);
+
+private:
+    struct IdlePage {
+        Stage stage;
+        QElapsedTimer idleTime;
+        // Handed back after a refused virtualization.
+        bool retry;
+    };
+
+    void updateStages();
+    int virtualizeTimeout(const IdlePage &page) const;
+    bool deadlineReached(qint64 idle, int deadline, bool *loadRead, bool *highLoad) const;
+    void schedule();
+    int powerSaveFactor() const;
+    bool highCpuLoad() const;
+
+    // Inactive live pages by tab id.
+    QMap<int, IdlePage> m_pages;
+    int m_keptAlive;
+    int m_suspendTimeout;
+    int m_virtualizeTimeout;
+    QString m_loadAverageFile;
+    bool m_batteryPowered;
+    bool m_background;
+    int m_timer;
+};
+
+#endif // WEBPAGESCHEDULER_H
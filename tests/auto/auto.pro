@@ -1,9 +1,25 @@
 # TODO: Change this to subdirs once we get first C++ test
 TEMPLATE = subdirs
 
-SUBDIRS += tst_declarativehistorymodel \
+SUBDIRS += tst_bookmarkparser \
+    tst_browsertrace \
+    tst_componentloader \
+    tst_declarativebookmarkmodel \
+    tst_declarativehistorymodel \
+    tst_declarativesuggestionmodel \
     tst_declarativetabmodel \
+    tst_downloadrestartguard \
+    tst_downloadresumer \
+    tst_downloadscheduler \
+    tst_faviconcache \
     tst_linkvalidator \
+    tst_listdiff \
+    tst_prefsfile \
+    tst_suggestionindex \
+    tst_tabitem \
+    tst_thumbnailcache \
+    tst_transferprogressthrottle \
+    tst_webpagescheduler \
     tst_webview
 
 OTHER_FILES += \
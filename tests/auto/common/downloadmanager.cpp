@@ -24,3 +24,8 @@ DownloadManager *DownloadManager::instance()
     }
     return s_singleton;
 }
+
+void DownloadManager::setPageLoading(bool loading)
+{
+    Q_UNUSED(loading)
+}
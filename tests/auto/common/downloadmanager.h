@@ -21,6 +21,9 @@ class DownloadManager : public QObject
 public:
     static DownloadManager *instance();
 
+public slots:
+    void setPageLoading(bool loading);
+
 signals:
     void downloadStarted();
 
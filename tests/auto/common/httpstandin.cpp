@@ -0,0 +1,167 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "httpstandin.h"
+
+#include <QTcpSocket>
+#include <QTimerEvent>
+
+static const int gChunkInterval = 10;
+
+HttpStandIn::HttpStandIn()
+    : supportsRanges(true)
+    , cutAfter(0)
+    , chunkSize(0)
+    , bodyBytesSent(0)
+    , activeCount(0)
+    , maxActiveCount(0)
+    , m_chunkTimer(0)
+{
+    for (int i = 0; i < 100000; ++i) {
+        content.append(char('a' + i % 26));
+    }
+    etag = "\"v1\"";
+    connect(this, SIGNAL(newConnection()), this, SLOT(acceptConnection()));
+    listen(QHostAddress::LocalHost);
+}
+
+QUrl HttpStandIn::url() const
+{
+    return QUrl(QString("http://127.0.0.1:%1/file.bin").arg(serverPort()));
+}
+
+void HttpStandIn::acceptConnection()
+{
+    while (hasPendingConnections()) {
+        QTcpSocket *socket = nextPendingConnection();
+        connect(socket, SIGNAL(readyRead()), this, SLOT(readRequest()));
+        connect(socket, SIGNAL(disconnected()), this, SLOT(socketDisconnected()));
+    }
+}
+
+void HttpStandIn::readRequest()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+    QByteArray buffer = socket->property("buffer").toByteArray() + socket->readAll();
+    socket->setProperty("buffer", buffer);
+    if (!buffer.contains("\r\n\r\n") || m_responses.contains(socket)) {
+        return;
+    }
+
+    QHash<QByteArray, QByteArray> headers;
+    QList<QByteArray> lines = buffer.left(buffer.indexOf("\r\n\r\n")).split('\n');
+    for (int i = 1; i < lines.count(); ++i) {
+        int colon = lines.at(i).indexOf(':');
+        if (colon > 0) {
+            headers.insert(lines.at(i).left(colon).trimmed().toLower(), lines.at(i).mid(colon + 1).trimmed());
+        }
+    }
+    requests.append(headers);
+
+    QByteArray range = headers.value("range");
+    QByteArray ifRange = headers.value("if-range");
+    qint64 start = -1;
+    if (supportsRanges && range.startsWith("bytes=") && range.endsWith("-")
+            && (ifRange.isEmpty() || ifRange == etag)) {
+        start = range.mid(6, range.length() - 7).toLongLong();
+    }
+
+    QByteArray header;
+    Response response;
+    if (start >= content.size()) {
+        header = "HTTP/1.1 416 Requested Range Not Satisfiable\r\n"
+                "Content-Range: bytes */" + QByteArray::number(content.size()) + "\r\n"
+                "Content-Length: 0\r\n";
+    } else if (start >= 0) {
+        response.body = content.mid(start);
+        header = "HTTP/1.1 206 Partial Content\r\n"
+                "Content-Range: bytes " + QByteArray::number(start) + "-"
+                + QByteArray::number(content.size() - 1) + "/" + QByteArray::number(content.size()) + "\r\n"
+                "Content-Length: " + QByteArray::number(response.body.size()) + "\r\n";
+    } else {
+        response.body = content;
+        header = "HTTP/1.1 200 OK\r\n"
+                "Content-Length: " + QByteArray::number(response.body.size()) + "\r\n";
+    }
+    header += "ETag: " + etag + "\r\n"
+            "Accept-Ranges: " + QByteArray(supportsRanges ? "bytes" : "none") + "\r\n"
+            "Connection: close\r\n\r\n";
+
+    response.cut = cutAfter > 0 && cutAfter < response.body.size();
+    if (response.cut) {
+        response.body.truncate(cutAfter);
+    }
+
+    socket->write(header);
+    m_responses.insert(socket, response);
+    ++activeCount;
+    maxActiveCount = qMax(maxActiveCount, activeCount);
+
+    if (chunkSize > 0) {
+        if (!m_chunkTimer) {
+            m_chunkTimer = startTimer(gChunkInterval);
+        }
+    } else {
+        send(socket, response.body);
+        close(socket, response.cut);
+    }
+}
+
+void HttpStandIn::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() != m_chunkTimer) {
+        return;
+    }
+
+    foreach (QTcpSocket *socket, m_responses.keys()) {
+        Response &response = m_responses[socket];
+        QByteArray chunk = response.body.left(chunkSize);
+        response.body.remove(0, chunk.size());
+        send(socket, chunk);
+        if (response.body.isEmpty()) {
+            close(socket, response.cut);
+        }
+    }
+
+    if (m_responses.isEmpty()) {
+        killTimer(m_chunkTimer);
+        m_chunkTimer = 0;
+    }
+}
+
+void HttpStandIn::socketDisconnected()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+    if (m_responses.remove(socket)) {
+        --activeCount;
+    }
+    socket->deleteLater();
+}
+
+void HttpStandIn::send(QTcpSocket *socket, const QByteArray &data)
+{
+    socket->write(data);
+    bodyBytesSent += data.size();
+}
+
+void HttpStandIn::close(QTcpSocket *socket, bool abort)
+{
+    if (m_responses.remove(socket)) {
+        --activeCount;
+    }
+    if (abort) {
+        socket->flush();
+        socket->waitForBytesWritten(1000);
+        socket->abort();
+    } else {
+        socket->disconnectFromHost();
+    }
+}
@@ -0,0 +1,68 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef HTTPSTANDIN_H
+#define HTTPSTANDIN_H
+
+#include <QTcpServer>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QUrl>
+
+class QTcpSocket;
+class QTimerEvent;
+
+// Minimal HTTP/1.1 server serving one resource with range support.
+class HttpStandIn : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    HttpStandIn();
+
+    QUrl url() const;
+
+    QByteArray content;
+    QByteArray etag;
+    bool supportsRanges;
+    // Connection is dropped after this many bytes of body, 0 sends everything.
+    int cutAfter;
+    // Body is sent in chunks of this many bytes every 10 ms, 0 sends it at once.
+    int chunkSize;
+    qint64 bodyBytesSent;
+    // Responses being sent and the largest number of them at the same time.
+    int activeCount;
+    int maxActiveCount;
+    QList<QHash<QByteArray, QByteArray> > requests;
+
+protected:
+    void timerEvent(QTimerEvent *event);
+
+private slots:
+    void acceptConnection();
+    void readRequest();
+    void socketDisconnected();
+
+private:
+    void send(QTcpSocket *socket, const QByteArray &data);
+    void close(QTcpSocket *socket, bool abort);
+
+    struct Response {
+        QByteArray body;
+        bool cut;
+    };
+
+    QHash<QTcpSocket *, Response> m_responses;
+    int m_chunkTimer;
+};
+
+#endif // HTTPSTANDIN_H
@@ -0,0 +1,7 @@
+# Local HTTP server for download tests.
+QT += network
+
+SOURCES += ../common/httpstandin.cpp
+HEADERS += ../common/httpstandin.h
+
+INCLUDEPATH += ../common
@@ -0,0 +1,109 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QtTest>
+#include <QTemporaryFile>
+#include "bookmarkparser.h"
+
+class tst_bookmarkparser : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void parseJson();
+    void parseHtml();
+    void invalid();
+    void detectFormat();
+};
+
+void tst_bookmarkparser::parseJson()
+{
+    bool ok = false;
+    QVariantList bookmarks = BookmarkParser::parseJson(
+                "[{\"url\": \"http://jolla.com/\", \"title\": \"Jolla\", \"favicon\": \"icon.png\"},"
+                " {\"title\": \"No url\"}, 42,"
+                " {\"url\": \"http://sailfishos.org/\", \"title\": \"Sailfish\"}]", &ok);
+    QVERIFY(ok);
+    QCOMPARE(bookmarks.count(), 2);
+    QVariantMap first = bookmarks.at(0).toMap();
+    QCOMPARE(first.value("url").toString(), QString("http://jolla.com/"));
+    QCOMPARE(first.value("title").toString(), QString("Jolla"));
+    QCOMPARE(first.value("favicon").toString(), QString("icon.png"));
+    QCOMPARE(bookmarks.at(1).toMap().value("url").toString(), QString("http://sailfishos.org/"));
+}
+
+void tst_bookmarkparser::parseHtml()
+{
+    bool ok = false;
+    QVariantList bookmarks = BookmarkParser::parseHtml(
+                "<!DOCTYPE NETSCAPE-Bookmark-file-1>\n"
+                "<TITLE>Bookmarks</TITLE>\n"
+                "<DL><p>\n"
+                "    <DT><H3 ADD_DATE=\"1\">Folder</H3>\n"
+                "    <DL><p>\n"
+                "        <DT><A HREF=\"http://example.com/?a=1&amp;b=2\" ICON_URI=\"http://example.com/icon.ico\" ICON=\"data:x\">Tom &amp; Jerry &#228;</A>\n"
+                "        <DT><a href=\"javascript:void(0)\">Bookmarklet</a>\n"
+                "    </DL><p>\n"
+                "    <DT><A HREF=\"http://example.com/?a=1&amp;b=2\">Duplicate</A>\n"
+                "    <DT><A LAST_VISIT=\"0\" HREF=\"http://empty.example.com/\"></A>\n"
+                "</DL><p>\n", &ok);
+    QVERIFY(ok);
+    QCOMPARE(bookmarks.count(), 2);
+
+    QVariantMap first = bookmarks.at(0).toMap();
+    QCOMPARE(first.value("url").toString(), QString("http://example.com/?a=1&b=2"));
+    QCOMPARE(first.value("title").toString(), QString::fromUtf8("Tom & Jerry \xc3\xa4"));
+    QCOMPARE(first.value("favicon").toString(), QString("http://example.com/icon.ico"));
+
+    // Title falls back to the url.
+    QVariantMap second = bookmarks.at(1).toMap();
+    QCOMPARE(second.value("url").toString(), QString("http://empty.example.com/"));
+    QCOMPARE(second.value("title").toString(), QString("http://empty.example.com/"));
+}
+
+void tst_bookmarkparser::invalid()
+{
+    bool ok = true;
+    QVERIFY(BookmarkParser::parseJson("{\"url\": \"http://jolla.com/\"}", &ok).isEmpty());
+    QVERIFY(!ok);
+
+    ok = true;
+    QVERIFY(BookmarkParser::parseHtml("Just some text", &ok).isEmpty());
+    QVERIFY(!ok);
+
+    ok = true;
+    QVERIFY(BookmarkParser::parse("/nonexistent/bookmarks.json", &ok).isEmpty());
+    QVERIFY(!ok);
+}
+
+void tst_bookmarkparser::detectFormat()
+{
+    QTemporaryFile json;
+    QVERIFY(json.open());
+    json.write("\n  [{\"url\": \"http://jolla.com/\", \"title\": \"Jolla\"}]\n");
+    json.close();
+
+    QTemporaryFile html;
+    QVERIFY(html.open());
+    html.write("<DL><DT><A HREF=\"http://jolla.com/\">Jolla</A></DL>");
+    html.close();
+
+    bool ok = false;
+    QCOMPARE(BookmarkParser::parse(json.fileName(), &ok).count(), 1);
+    QVERIFY(ok);
+    ok = false;
+    QCOMPARE(BookmarkParser::parse(html.fileName(), &ok).count(), 1);
+    QVERIFY(ok);
+}
+
+QTEST_APPLESS_MAIN(tst_bookmarkparser)
+
+#include "tst_bookmarkparser.moc"
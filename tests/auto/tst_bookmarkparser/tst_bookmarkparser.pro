@@ -0,0 +1,4 @@
+TARGET = tst_bookmarkparser
+include(../test_common.pri)
+
+SOURCES += tst_bookmarkparser.cpp
@@ -0,0 +1,184 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QThread>
+#include "browsertrace.h"
+
+class TraceThread : public QThread
+{
+public:
+    void run()
+    {
+        TRACE_SPAN("worker");
+    }
+};
+
+class tst_browsertrace : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void recordSpan();
+    void disabled();
+    void ringBuffer();
+    void chromeTrace();
+    void threads();
+    void save();
+    void engineInitialization();
+};
+
+void tst_browsertrace::init()
+{
+    BrowserTrace::setEnabled(true);
+    BrowserTrace::instance()->clear();
+}
+
+void tst_browsertrace::cleanup()
+{
+    BrowserTrace::setEnabled(false);
+    BrowserTrace::instance()->setOutputPath(QString());
+}
+
+void tst_browsertrace::recordSpan()
+{
+    {
+        TRACE_SPAN("outer");
+        QTest::qSleep(5);
+        TRACE_INSTANT("mark");
+    }
+
+    QVector<BrowserTrace::Event> events = BrowserTrace::instance()->events();
+    QCOMPARE(events.count(), 2);
+    QCOMPARE(QByteArray(events.at(0).name), QByteArray("mark"));
+    QCOMPARE(events.at(0).duration, qint64(-1));
+    QCOMPARE(QByteArray(events.at(1).name), QByteArray("outer"));
+    QVERIFY(events.at(1).duration >= 5000);
+    QVERIFY(events.at(1).start <= events.at(0).start);
+}
+
+void tst_browsertrace::disabled()
+{
+    BrowserTrace::setEnabled(false);
+    {
+        TRACE_SPAN("ignored");
+        TRACE_INSTANT("ignored");
+    }
+    QVERIFY(BrowserTrace::instance()->events().isEmpty());
+}
+
+void tst_browsertrace::ringBuffer()
+{
+    BrowserTrace trace(3);
+    const char *names[] = { "a", "b", "c", "d", "e" };
+    for (int i = 0; i < 5; ++i) {
+        trace.span(names[i], i, 1);
+    }
+
+    QVector<BrowserTrace::Event> events = trace.events();
+    QCOMPARE(events.count(), 3);
+    QCOMPARE(QByteArray(events.at(0).name), QByteArray("c"));
+    QCOMPARE(QByteArray(events.at(1).name), QByteArray("d"));
+    QCOMPARE(QByteArray(events.at(2).name), QByteArray("e"));
+
+    trace.clear();
+    QVERIFY(trace.events().isEmpty());
+}
+
+void tst_browsertrace::chromeTrace()
+{
+    BrowserTrace trace;
+    trace.span("phase", 100, 250);
+    trace.instant("ready");
+
+    QJsonParseError error;
+    QJsonDocument document = QJsonDocument::fromJson(trace.toChromeTrace(), &error);
+    QCOMPARE(error.error, QJsonParseError::NoError);
+
+    QJsonArray events = document.object().value("traceEvents").toArray();
+    QCOMPARE(events.count(), 2);
+
+    QJsonObject span = events.at(0).toObject();
+    QCOMPARE(span.value("name").toString(), QString("phase"));
+    QCOMPARE(span.value("ph").toString(), QString("X"));
+    QCOMPARE(span.value("ts").toDouble(), 100.0);
+    QCOMPARE(span.value("dur").toDouble(), 250.0);
+    QCOMPARE(span.value("tid").toDouble(), 0.0);
+
+    QJsonObject instant = events.at(1).toObject();
+    QCOMPARE(instant.value("name").toString(), QString("ready"));
+    QCOMPARE(instant.value("ph").toString(), QString("i"));
+    QVERIFY(!instant.contains("dur"));
+}
+
+void tst_browsertrace::threads()
+{
+    TRACE_INSTANT("main");
+    TraceThread thread;
+    thread.start();
+    QVERIFY(thread.wait(5000));
+
+    QVector<BrowserTrace::Event> events = BrowserTrace::instance()->events();
+    QCOMPARE(events.count(), 2);
+    QVERIFY(events.at(0).thread != events.at(1).thread);
+
+    QJsonDocument document = QJsonDocument::fromJson(BrowserTrace::instance()->toChromeTrace());
+    QJsonArray json = document.object().value("traceEvents").toArray();
+    QCOMPARE(json.at(0).toObject().value("tid").toDouble(), 0.0);
+    QCOMPARE(json.at(1).toObject().value("tid").toDouble(), 1.0);
+}
+
+void tst_browsertrace::save()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    BrowserTrace *trace = BrowserTrace::instance();
+    QVERIFY(!trace->save());
+
+    TRACE_INSTANT("saved");
+    QString path = dir.path() + "/trace.json";
+    trace->setOutputPath(path);
+    QVERIFY(trace->save());
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), trace->toChromeTrace());
+}
+
+void tst_browsertrace::engineInitialization()
+{
+    BrowserTrace *trace = BrowserTrace::instance();
+    trace->markEmbeddingStarted();
+    QTest::qSleep(5);
+    trace->markEngineInitialized();
+
+    QVector<BrowserTrace::Event> events = trace->events();
+    QCOMPARE(events.count(), 2);
+    QCOMPARE(QByteArray(events.at(0).name), QByteArray("runEmbedding"));
+    QCOMPARE(QByteArray(events.at(1).name), QByteArray("engineInitialization"));
+    QVERIFY(events.at(1).start <= events.at(0).start);
+    QVERIFY(events.at(1).duration >= 5000);
+
+    // Initialized again without a start, e.g. a late connection.
+    trace->markEngineInitialized();
+    QCOMPARE(QByteArray(trace->events().last().name), QByteArray("engineInitialized"));
+}
+
+QTEST_APPLESS_MAIN(tst_browsertrace)
+#include "tst_browsertrace.moc"
@@ -0,0 +1,4 @@
+TARGET = tst_browsertrace
+include(../test_common.pri)
+
+SOURCES += tst_browsertrace.cpp
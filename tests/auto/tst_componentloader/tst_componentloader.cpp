@@ -0,0 +1,164 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QtTest>
+#include <QQmlComponent>
+#include <QQmlEngine>
+#include <QTemporaryDir>
+#include "componentloader.h"
+
+class tst_componentloader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void loadOnFirstUse();
+    void preloadAfterFirstPageLoad();
+    void preloadAlreadyLoaded();
+    void useWhilePreloading();
+    void whenReadyFailed();
+
+private:
+    QUrl writeComponent(const QString &name, const QByteArray &content = QByteArray());
+    QJSValue readyCallback(QJSValue result);
+
+    QTemporaryDir *dir;
+    QQmlEngine *engine;
+    ComponentLoader *loader;
+};
+
+void tst_componentloader::init()
+{
+    dir = new QTemporaryDir;
+    QVERIFY(dir->isValid());
+    engine = new QQmlEngine;
+    loader = new ComponentLoader(engine);
+}
+
+void tst_componentloader::cleanup()
+{
+    delete loader;
+    delete engine;
+    delete dir;
+}
+
+void tst_componentloader::loadOnFirstUse()
+{
+    QUrl url = writeComponent("Dialog.qml");
+
+    QQmlComponent *component = loader->component(url);
+    QVERIFY(component);
+    QVERIFY(component->isReady());
+    QCOMPARE(loader->component(url), component);
+    QCOMPARE(loader->loadedBeforeFirstFrame(), QStringList() << "Dialog.qml");
+
+    loader->firstFrameSwapped();
+    QVERIFY(loader->firstFrameShown());
+
+    loader->component(writeComponent("Later.qml"));
+    QCOMPARE(loader->loadedBeforeFirstFrame(), QStringList() << "Dialog.qml");
+}
+
+void tst_componentloader::preloadAfterFirstPageLoad()
+{
+    QUrl first = writeComponent("First.qml");
+    QUrl second = writeComponent("Second.qml");
+    loader->preload(first);
+    loader->preload(second);
+
+    // Nothing is compiled before the first frame.
+    QTest::qWait(200);
+    QCOMPARE(loader->findChildren<QQmlComponent *>().count(), 0);
+
+    // Nor while the first page is loading.
+    loader->firstFrameSwapped();
+    QTest::qWait(200);
+    QCOMPARE(loader->findChildren<QQmlComponent *>().count(), 0);
+
+    loader->pageLoaded();
+    QTRY_COMPARE(loader->findChildren<QQmlComponent *>().count(), 2);
+
+    QQmlComponent *component = loader->findChildren<QQmlComponent *>().first();
+    QTRY_VERIFY(component->isReady());
+    QVERIFY(loader->loadedBeforeFirstFrame().isEmpty());
+
+    QObject *object = loader->component(first)->create();
+    QVERIFY(object);
+    delete object;
+}
+
+void tst_componentloader::preloadAlreadyLoaded()
+{
+    QUrl url = writeComponent("Dialog.qml");
+    QQmlComponent *component = loader->component(url);
+    loader->preload(url);
+    loader->firstFrameSwapped();
+    loader->pageLoaded();
+
+    QTest::qWait(200);
+    QCOMPARE(loader->findChildren<QQmlComponent *>().count(), 1);
+    QCOMPARE(loader->component(url), component);
+}
+
+void tst_componentloader::useWhilePreloading()
+{
+    QUrl url = writeComponent("Dialog.qml");
+    loader->firstFrameSwapped();
+    loader->pageLoaded();
+    loader->preload(url);
+    QTRY_COMPARE(loader->findChildren<QQmlComponent *>().count(), 1);
+
+    // Component compiled in the background is handed out once it is ready.
+    QQmlComponent *component = loader->component(url);
+    QJSValue result = engine->newObject();
+    loader->whenReady(url, readyCallback(result));
+    loader->whenReady(url, readyCallback(result));
+    QTRY_COMPARE(result.property("calls").toInt(), 2);
+    QVERIFY(component->isReady());
+    QCOMPARE(result.property("component").toQObject(), static_cast<QObject *>(component));
+    QCOMPARE(loader->component(url), component);
+    QCOMPARE(loader->findChildren<QQmlComponent *>().count(), 1);
+
+    // Ready component is handed out right away.
+    loader->whenReady(url, readyCallback(result));
+    QCOMPARE(result.property("calls").toInt(), 3);
+}
+
+void tst_componentloader::whenReadyFailed()
+{
+    QUrl url = writeComponent("Broken.qml", "import QtQml 2.0\nQtObject { property int value: }\n");
+    QJSValue result = engine->newObject();
+    loader->whenReady(url, readyCallback(result));
+    QVERIFY(loader->component(url)->isError());
+    QVERIFY(result.property("calls").isUndefined());
+}
+
+QUrl tst_componentloader::writeComponent(const QString &name, const QByteArray &content)
+{
+    QFile file(dir->path() + "/" + name);
+    file.open(QIODevice::WriteOnly);
+    file.write(content.isEmpty() ? QByteArray("import QtQml 2.0\nQtObject { property int value: 1 }\n") : content);
+    return QUrl::fromLocalFile(file.fileName());
+}
+
+// Callback that counts its calls and stores the component in result.
+QJSValue tst_componentloader::readyCallback(QJSValue result)
+{
+    QJSValue factory = engine->evaluate("(function (result) { return function (component) {"
+                                        " result.calls = (result.calls || 0) + 1; result.component = component } })");
+    return factory.call(QJSValueList() << result);
+}
+
+QTEST_GUILESS_MAIN(tst_componentloader)
+#include "tst_componentloader.moc"
@@ -0,0 +1,6 @@
+TARGET = tst_componentloader
+include(../test_common.pri)
+
+SOURCES += tst_componentloader.cpp \
+    ../../../src/componentloader.cpp
+HEADERS += ../../../src/componentloader.h
@@ -0,0 +1,264 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QtTest>
+#include <QQmlEngine>
+#include <QQuickView>
+#include <QTemporaryFile>
+
+#include "declarativebookmarkmodel.h"
+#include "dbmanager.h"
+#include "testobject.h"
+
+static const QByteArray QML_SNIPPET = \
+        "import QtQuick 2.0\n" \
+        "import Sailfish.Browser 1.0\n" \
+        "Item {\n" \
+        "   width: 100; height: 100\n" \
+        "   property alias bookmarkModel: model\n" \
+        "   BookmarkModel { id: model }\n" \
+        "}\n";
+
+class tst_declarativebookmarkmodel : public TestObject
+{
+    Q_OBJECT
+
+public:
+    tst_declarativebookmarkmodel();
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void addBookmarks();
+    void updateBookmark();
+    void removeBookmark();
+    void importBookmarks();
+    void exportBookmarks();
+    void importFile();
+    void removeBeforeLoad();
+    void reload();
+
+private:
+    QStringList urls() const;
+    QVariantMap bookmark(const QString &url, const QString &title) const;
+
+    DeclarativeBookmarkModel *bookmarkModel;
+    QStringList initialUrls;
+};
+
+tst_declarativebookmarkmodel::tst_declarativebookmarkmodel()
+    : TestObject(QML_SNIPPET)
+{
+    bookmarkModel = TestObject::model<DeclarativeBookmarkModel>("bookmarkModel");
+}
+
+void tst_declarativebookmarkmodel::initTestCase()
+{
+    QVERIFY(bookmarkModel);
+
+    if (!bookmarkModel->m_loaded) {
+        QSignalSpy countChangedSpy(bookmarkModel, SIGNAL(countChanged()));
+        QVERIFY(countChangedSpy.wait());
+    }
+    QVERIFY(bookmarkModel->m_loaded);
+    // Default bookmarks may have been imported.
+    initialUrls = urls();
+}
+
+void tst_declarativebookmarkmodel::cleanupTestCase()
+{
+    foreach (const QString &url, urls()) {
+        bookmarkModel->removeBookmark(url);
+    }
+    QCOMPARE(bookmarkModel->rowCount(), 0);
+
+    // Wait for event loop of db manager
+    QTest::qWait(500);
+    QString dbFileName = QString("%1/%2")
+            .arg(QStandardPaths::writableLocation(QStandardPaths::DataLocation))
+            .arg(QLatin1String(DB_NAME));
+    QFile dbFile(dbFileName);
+    QVERIFY(dbFile.remove());
+}
+
+void tst_declarativebookmarkmodel::addBookmarks()
+{
+    QSignalSpy rowsInsertedSpy(bookmarkModel, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    bookmarkModel->addBookmark("http://one.example.com/", "One", "");
+    bookmarkModel->addBookmark("http://two.example.com/", "Two", "");
+    bookmarkModel->addBookmark("http://three.example.com/", "Three", "");
+
+    QCOMPARE(rowsInsertedSpy.count(), 3);
+    QStringList expected = initialUrls;
+    expected << "http://one.example.com/" << "http://two.example.com/" << "http://three.example.com/";
+    QCOMPARE(urls(), expected);
+    QVERIFY(bookmarkModel->contains("http://two.example.com/"));
+}
+
+void tst_declarativebookmarkmodel::updateBookmark()
+{
+    QSignalSpy dataChangedSpy(bookmarkModel, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)));
+    int count = bookmarkModel->rowCount();
+    bookmarkModel->addBookmark("http://one.example.com/", "One updated", "");
+
+    // Same url is not added twice.
+    QCOMPARE(bookmarkModel->rowCount(), count);
+    QCOMPARE(dataChangedSpy.count(), 1);
+    int row = urls().indexOf("http://one.example.com/");
+    QCOMPARE(bookmarkModel->data(bookmarkModel->index(row), DeclarativeBookmarkModel::TitleRole).toString(),
+             QString("One updated"));
+}
+
+void tst_declarativebookmarkmodel::removeBookmark()
+{
+    QStringList expected = urls();
+    bookmarkModel->removeBookmark("http://two.example.com/");
+    expected.removeAll("http://two.example.com/");
+
+    QVERIFY(!bookmarkModel->contains("http://two.example.com/"));
+    QCOMPARE(urls(), expected);
+    // Rows after the removed one are still addressable by url.
+    for (int i = 0; i < expected.count(); ++i) {
+        QCOMPARE(bookmarkModel->m_rows.value(expected.at(i)), i);
+    }
+}
+
+void tst_declarativebookmarkmodel::importBookmarks()
+{
+    QSignalSpy resetSpy(bookmarkModel, SIGNAL(modelReset()));
+    QSignalSpy rowsInsertedSpy(bookmarkModel, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    QSignalSpy countChangedSpy(bookmarkModel, SIGNAL(countChanged()));
+
+    QVariantList bookmarks;
+    // Already in the model.
+    bookmarks << bookmark("http://one.example.com/", "One");
+    for (int i = 0; i < 100; ++i) {
+        bookmarks << bookmark(QString("http://import%1.example.com/").arg(i), QString("Import %1").arg(i));
+    }
+
+    int count = bookmarkModel->rowCount();
+    QCOMPARE(bookmarkModel->importBookmarks(bookmarks), 100);
+    QCOMPARE(bookmarkModel->rowCount(), count + 100);
+    QCOMPARE(resetSpy.count(), 1);
+    QCOMPARE(rowsInsertedSpy.count(), 0);
+    QCOMPARE(countChangedSpy.count(), 1);
+    QCOMPARE(urls().last(), QString("http://import99.example.com/"));
+}
+
+void tst_declarativebookmarkmodel::exportBookmarks()
+{
+    QVariantList exported = bookmarkModel->exportBookmarks();
+    QCOMPARE(exported.count(), bookmarkModel->rowCount());
+    for (int i = 0; i < exported.count(); ++i) {
+        QVariantMap item = exported.at(i).toMap();
+        QModelIndex index = bookmarkModel->index(i);
+        QCOMPARE(item.value("url").toString(), bookmarkModel->data(index, DeclarativeBookmarkModel::UrlRole).toString());
+        QCOMPARE(item.value("title").toString(), bookmarkModel->data(index, DeclarativeBookmarkModel::TitleRole).toString());
+    }
+}
+
+void tst_declarativebookmarkmodel::importFile()
+{
+    // Let pending changes to be saved before the import.
+    QTest::qWait(500);
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.write("<!DOCTYPE NETSCAPE-Bookmark-file-1>\n<DL><p>\n");
+    // Already in the model, updated in place.
+    file.write("<DT><A HREF=\"http://one.example.com/\">One imported</A>\n");
+    for (int i = 0; i < 450; ++i) {
+        file.write(QString("<DT><A HREF=\"http://file%1.example.com/\" ADD_DATE=\"0\">File %1</A>\n").arg(i).toUtf8());
+    }
+    file.write("</DL><p>\n");
+    file.close();
+
+    QSignalSpy progressSpy(DBManager::instance(), SIGNAL(bookmarkImportProgress(int,int)));
+    QSignalSpy finishedSpy(DBManager::instance(), SIGNAL(bookmarkImportFinished(int)));
+    QSignalSpy rowsInsertedSpy(bookmarkModel, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    int count = bookmarkModel->rowCount();
+    DBManager::instance()->importBookmarks(file.fileName());
+    waitSignals(finishedSpy, 1);
+
+    QCOMPARE(finishedSpy.at(0).at(0).toInt(), 451);
+    // Stored and merged in batches.
+    QCOMPARE(progressSpy.count(), 3);
+    QCOMPARE(progressSpy.last().at(0).toInt(), 451);
+    QCOMPARE(progressSpy.last().at(1).toInt(), 451);
+    QCOMPARE(rowsInsertedSpy.count(), 3);
+    QCOMPARE(bookmarkModel->rowCount(), count + 450);
+    QCOMPARE(urls().last(), QString("http://file449.example.com/"));
+    int row = urls().indexOf("http://one.example.com/");
+    QCOMPARE(bookmarkModel->data(bookmarkModel->index(row), DeclarativeBookmarkModel::TitleRole).toString(),
+             QString("One imported"));
+}
+
+void tst_declarativebookmarkmodel::removeBeforeLoad()
+{
+    DeclarativeBookmarkModel early;
+    QString removed("http://removed.example.com/");
+    QString stored("http://stored.example.com/");
+    early.addBookmark(removed, "Removed", QString());
+    early.removeBookmark(removed);
+    QCOMPARE(early.rowCount(), 0);
+
+    // Saved before the initial load arrives, which still has the removed row.
+    early.save();
+    QVERIFY(early.m_removedUrls.contains(removed));
+    early.bookmarksAvailable(QVariantList() << bookmark(removed, "Removed") << bookmark(stored, "Stored"));
+
+    QCOMPARE(early.rowCount(), 1);
+    QCOMPARE(early.data(early.index(0), DeclarativeBookmarkModel::UrlRole).toString(), stored);
+    QVERIFY(early.m_removedUrls.isEmpty());
+}
+
+void tst_declarativebookmarkmodel::reload()
+{
+    // Let pending changes to be saved.
+    QTest::qWait(500);
+
+    DeclarativeBookmarkModel reloaded;
+    QSignalSpy countChangedSpy(&reloaded, SIGNAL(countChanged()));
+    reloaded.componentComplete();
+    waitSignals(countChangedSpy, 1);
+
+    // Order is preserved over save and load.
+    QCOMPARE(reloaded.exportBookmarks(), bookmarkModel->exportBookmarks());
+}
+
+QStringList tst_declarativebookmarkmodel::urls() const
+{
+    QStringList list;
+    for (int i = 0; i < bookmarkModel->rowCount(); ++i) {
+        list << bookmarkModel->data(bookmarkModel->index(i), DeclarativeBookmarkModel::UrlRole).toString();
+    }
+    return list;
+}
+
+QVariantMap tst_declarativebookmarkmodel::bookmark(const QString &url, const QString &title) const
+{
+    QVariantMap item;
+    item.insert("url", url);
+    item.insert("title", title);
+    item.insert("favicon", QString());
+    return item;
+}
+
+int main(int argc, char *argv[])
+{
+    QGuiApplication app(argc, argv);
+    app.setAttribute(Qt::AA_Use96Dpi, true);
+    qmlRegisterType<DeclarativeBookmarkModel>("Sailfish.Browser", 1, 0, "BookmarkModel");
+    tst_declarativebookmarkmodel testcase;
+    return QTest::qExec(&testcase, argc, argv);
+}
+#include "tst_declarativebookmarkmodel.moc"
@@ -0,0 +1,10 @@
+TARGET = tst_declarativebookmarkmodel
+include(../test_common.pri)
+include(../common/testobject.pri)
+
+SOURCES += tst_declarativebookmarkmodel.cpp \
+    ../../../src/declarativebookmarkmodel.cpp \
+    ../../../src/bookmark.cpp
+
+HEADERS += ../../../src/declarativebookmarkmodel.h \
+    ../../../src/bookmark.h
@@ -18,6 +18,8 @@
 #include "declarativehistorymodel.h"
 #include "testobject.h"
 
+Q_DECLARE_METATYPE(QList<Link>)
+
 static const QByteArray QML_SNIPPET = \
         "import QtQuick 2.0\n" \
         "import Sailfish.Browser 1.0\n" \
@@ -48,9 +50,16 @@ private slots:
     void sortedHistoryEntries_data();
     void sortedHistoryEntries();
 
+    void updateModelSignals_data();
+    void updateModelSignals();
+    void updateTitle();
+    void updateTitleBenchmark();
+
     void cleanupTestCase();
 
 private:
+    QList<Link> links(int count, const QString &prefix = QString("http://example.com/%1")) const;
+
     DeclarativeHistoryModel *historyModel;
     DeclarativeTabModel *tabModel;
 };
@@ -181,6 +190,105 @@ void tst_declarativehistorymodel::sortedHistoryEntries()
     }
 }
 
+void tst_declarativehistorymodel::updateModelSignals_data()
+{
+    QTest::addColumn<QList<Link> >("newLinks");
+    QTest::addColumn<int>("inserted");
+    QTest::addColumn<int>("removed");
+    QTest::addColumn<int>("moved");
+    QTest::addColumn<int>("changed");
+
+    QList<Link> current = links(500);
+    QList<Link> list = current;
+    list.prepend(Link(0, "http://new.example.com/", "", "New"));
+    QTest::newRow("insertFirst") << list << 1 << 0 << 0 << 0;
+
+    list = current;
+    list.removeAt(250);
+    QTest::newRow("remove") << list << 0 << 1 << 0 << 0;
+
+    list = current;
+    list.move(400, 10);
+    QTest::newRow("moveUp") << list << 0 << 0 << 1 << 0;
+
+    list = current;
+    list[20].setTitle("Changed");
+    QTest::newRow("titleChanged") << list << 0 << 0 << 0 << 1;
+
+    list = current;
+    list.removeAt(100);
+    list.insert(300, Link(0, "http://new.example.com/", "", "New"));
+    list[400].setTitle("Changed");
+    QTest::newRow("mixed") << list << 1 << 1 << 0 << 1;
+
+    // Unrelated search results replace the rows in one go.
+    QTest::newRow("replace") << links(500, QString("http://other.example.com/%1")) << 1 << 1 << 0 << 0;
+}
+
+void tst_declarativehistorymodel::updateModelSignals()
+{
+    QFETCH(QList<Link>, newLinks);
+    QFETCH(int, inserted);
+    QFETCH(int, removed);
+    QFETCH(int, moved);
+    QFETCH(int, changed);
+
+    DeclarativeHistoryModel model;
+    model.updateModel(links(500));
+    QCOMPARE(model.rowCount(), 500);
+
+    QSignalSpy insertedSpy(&model, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    QSignalSpy removedSpy(&model, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+    QSignalSpy movedSpy(&model, SIGNAL(rowsMoved(QModelIndex,int,int,QModelIndex,int)));
+    QSignalSpy changedSpy(&model, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)));
+    model.updateModel(newLinks);
+
+    QCOMPARE(insertedSpy.count(), inserted);
+    QCOMPARE(removedSpy.count(), removed);
+    QCOMPARE(movedSpy.count(), moved);
+    QCOMPARE(changedSpy.count(), changed);
+    QCOMPARE(model.m_links, newLinks);
+}
+
+void tst_declarativehistorymodel::updateTitle()
+{
+    DeclarativeHistoryModel model;
+    QList<Link> list = links(10);
+    // Same url with different titles is listed twice.
+    list.append(Link(0, "http://example.com/3", "", "Another title"));
+    model.updateModel(list);
+
+    QSignalSpy changedSpy(&model, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)));
+    model.updateTitle("http://example.com/3", "New title");
+    QCOMPARE(changedSpy.count(), 2);
+    QCOMPARE(model.data(model.index(3), DeclarativeHistoryModel::TitleRole).toString(), QString("New title"));
+    QCOMPARE(model.data(model.index(10), DeclarativeHistoryModel::TitleRole).toString(), QString("New title"));
+
+    model.updateTitle("http://example.com/3", "New title");
+    model.updateTitle("http://unknown.example.com/", "New title");
+    QCOMPARE(changedSpy.count(), 2);
+
+    // Rows follow the model updates.
+    list.removeFirst();
+    model.updateModel(list);
+    model.updateTitle("http://example.com/5", "Moved");
+    QCOMPARE(model.data(model.index(4), DeclarativeHistoryModel::TitleRole).toString(), QString("Moved"));
+}
+
+// Title update of one page with 50000 rows in the model.
+void tst_declarativehistorymodel::updateTitleBenchmark()
+{
+    DeclarativeHistoryModel model;
+    model.updateModel(links(50000));
+    QCOMPARE(model.rowCount(), 50000);
+
+    int i = 0;
+    QBENCHMARK {
+        model.updateTitle("http://example.com/25000", (++i % 2) ? "Loading" : "Loaded");
+    }
+    QVERIFY(model.m_links.at(25000).title() == "Loading" || model.m_links.at(25000).title() == "Loaded");
+}
+
 void tst_declarativehistorymodel::cleanupTestCase()
 {
     tabModel->clear();
@@ -195,6 +303,15 @@ void tst_declarativehistorymodel::cleanupTestCase()
     QVERIFY(dbFile.remove());
 }
 
+QList<Link> tst_declarativehistorymodel::links(int count, const QString &prefix) const
+{
+    QList<Link> list;
+    for (int i = 0; i < count; ++i) {
+        list.append(Link(0, prefix.arg(i), "", QString("Title %1").arg(i)));
+    }
+    return list;
+}
+
 int main(int argc, char *argv[])
 {
     QGuiApplication app(argc, argv);
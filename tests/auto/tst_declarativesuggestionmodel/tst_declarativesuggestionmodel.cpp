@@ -0,0 +1,123 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QtTest>
+#include <QStandardPaths>
+#include "declarativesuggestionmodel.h"
+
+class tst_declarativesuggestionmodel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void emptyFilter();
+    void visitedLinkIsSuggested();
+    void titleChangeIsShown();
+    void rowsKeptWhileTyping();
+    void cleanupTestCase();
+
+private:
+    QStringList urls(const DeclarativeSuggestionModel &model) const;
+};
+
+QStringList tst_declarativesuggestionmodel::urls(const DeclarativeSuggestionModel &model) const
+{
+    QStringList list;
+    for (int i = 0; i < model.rowCount(); ++i) {
+        list << model.data(model.index(i), DeclarativeSuggestionModel::UrlRole).toString();
+    }
+    return list;
+}
+
+void tst_declarativesuggestionmodel::emptyFilter()
+{
+    DeclarativeSuggestionModel model;
+    QSignalSpy filterSpy(&model, SIGNAL(filterChanged()));
+    QMetaObject::invokeMethod(&model, "linkVisited", Q_ARG(QString, "http://example.com/"), Q_ARG(QString, "Example"));
+
+    // History list shows the unranked history for an empty query.
+    model.search("");
+    QCOMPARE(model.rowCount(), 0);
+    QVERIFY(filterSpy.isEmpty());
+
+    model.search("exa");
+    QCOMPARE(model.filter(), QString("exa"));
+    QCOMPARE(filterSpy.count(), 1);
+    QCOMPARE(model.rowCount(), 1);
+
+    model.search("  ");
+    QCOMPARE(model.rowCount(), 0);
+}
+
+void tst_declarativesuggestionmodel::visitedLinkIsSuggested()
+{
+    DeclarativeSuggestionModel model;
+    model.search("jolla");
+    QCOMPARE(model.rowCount(), 0);
+
+    QSignalSpy countSpy(&model, SIGNAL(countChanged()));
+    QMetaObject::invokeMethod(&model, "linkVisited", Q_ARG(QString, "http://jolla.com/"), Q_ARG(QString, "Jolla"));
+    QTRY_COMPARE(model.rowCount(), 1);
+    QCOMPARE(countSpy.count(), 1);
+    QCOMPARE(urls(model), QStringList() << "http://jolla.com/");
+}
+
+void tst_declarativesuggestionmodel::titleChangeIsShown()
+{
+    DeclarativeSuggestionModel model;
+    QMetaObject::invokeMethod(&model, "linkVisited", Q_ARG(QString, "http://jolla.com/"), Q_ARG(QString, "Loading"));
+    model.search("jolla");
+    QCOMPARE(model.rowCount(), 1);
+
+    QSignalSpy changedSpy(&model, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)));
+    QMetaObject::invokeMethod(&model, "updateTitle", Q_ARG(QString, "http://jolla.com/"), Q_ARG(QString, "Jolla"));
+    QTRY_COMPARE(changedSpy.count(), 1);
+    QCOMPARE(model.data(model.index(0), DeclarativeSuggestionModel::TitleRole).toString(), QString("Jolla"));
+}
+
+void tst_declarativesuggestionmodel::rowsKeptWhileTyping()
+{
+    DeclarativeSuggestionModel model;
+    // Distinct visit counts keep the ranking stable.
+    for (int i = 0; i < 10; ++i) {
+        for (int visit = 0; visit <= i; ++visit) {
+            QMetaObject::invokeMethod(&model, "linkVisited", Q_ARG(QString, QString("http://example.com/page%1").arg(i)),
+                                      Q_ARG(QString, QString("Page %1").arg(i)));
+        }
+    }
+    QMetaObject::invokeMethod(&model, "linkVisited", Q_ARG(QString, "http://example.org/"), Q_ARG(QString, "Other"));
+    model.search("example");
+    QCOMPARE(model.rowCount(), 11);
+
+    // Narrowing the query removes the rows that no longer match, the rest are untouched.
+    QSignalSpy removedSpy(&model, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+    QSignalSpy insertedSpy(&model, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    QSignalSpy changedSpy(&model, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)));
+    model.search("example.com");
+    QCOMPARE(model.rowCount(), 10);
+    QCOMPARE(removedSpy.count(), 1);
+    QVERIFY(insertedSpy.isEmpty());
+    QVERIFY(changedSpy.isEmpty());
+    QVERIFY(!urls(model).contains("http://example.org/"));
+}
+
+void tst_declarativesuggestionmodel::cleanupTestCase()
+{
+    // Wait for event loop of db manager
+    QTest::qWait(1000);
+    QString dbFileName = QString("%1/%2")
+            .arg(QStandardPaths::writableLocation(QStandardPaths::DataLocation))
+            .arg(QLatin1String(DB_NAME));
+    QFile::remove(dbFileName);
+}
+
+QTEST_GUILESS_MAIN(tst_declarativesuggestionmodel)
+#include "tst_declarativesuggestionmodel.moc"
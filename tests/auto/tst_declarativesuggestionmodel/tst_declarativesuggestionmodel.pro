@@ -0,0 +1,4 @@
+TARGET = tst_declarativesuggestionmodel
+include(../test_common.pri)
+
+SOURCES += tst_declarativesuggestionmodel.cpp
@@ -72,6 +72,8 @@ private slots:
     void newTabData();
     void resetNewTabData();
 
+    void tabOpenedBeforeRestore();
+
     void clear();
 
 private:
@@ -548,6 +550,40 @@ void tst_declarativetabmodel::resetNewTabData()
     QVERIFY(!tabModel->newTabPreviousPage());
 }
 
+void tst_declarativetabmodel::tabOpenedBeforeRestore()
+{
+    QList<Tab> restoredTabs = tabModel->tabs();
+    restoredTabs.prepend(tabModel->activeTab());
+
+    // Not created from QML, the tabs are not requested from the database.
+    DeclarativeTabModel model;
+    QVERIFY(!model.loaded());
+    QSignalSpy loadedSpy(&model, SIGNAL(loadedChanged()));
+    QSignalSpy activeTabChangedSpy(&model, SIGNAL(activeTabChanged(int,int)));
+
+    // Link launch opens its tab before the previous session is restored.
+    QString url("http://www.example.com/");
+    model.addTab(url, "Example");
+    QCOMPARE(activeTabChangedSpy.count(), 1);
+    int openedTabId = model.activeTab().tabId();
+
+    // The opened tab may already be in the database when the tabs get listed.
+    QList<Tab> availableTabs = restoredTabs;
+    availableTabs.append(model.activeTab());
+    model.tabsAvailable(availableTabs);
+
+    QCOMPARE(loadedSpy.count(), 1);
+    QCOMPARE(activeTabChangedSpy.count(), 1);
+    QCOMPARE(model.activeTab().tabId(), openedTabId);
+    QCOMPARE(model.activeTab().url(), url);
+    QCOMPARE(model.count(), restoredTabs.count() + 1);
+    QCOMPARE(model.rowCount(), restoredTabs.count());
+    // Previously active tab is next to the opened one.
+    QCOMPARE(model.tabs().at(0).tabId(), restoredTabs.at(0).tabId());
+
+    DBManager::instance()->removeTab(openedTabId);
+}
+
 void tst_declarativetabmodel::clear()
 {
     QVERIFY(tabModel->count() > 0);
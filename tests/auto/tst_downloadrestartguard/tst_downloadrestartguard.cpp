@@ -0,0 +1,213 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QtTest>
+#include <QNetworkAccessManager>
+#include <QTemporaryDir>
+#include "downloadrestartguard.h"
+#include "downloadresumer.h"
+#include "httpstandin.h"
+
+class tst_downloadrestartguard : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void geckoRestartThenResume();
+    void geckoRestartOfRunningResumer();
+    void timeoutReleasesDownloads();
+    void timeoutWaitsForCancel();
+    void discard();
+
+private:
+    bool download(DownloadResumer &resumer);
+    void writePartial(int bytes);
+    void geckoRestart();
+    QByteArray fileContent(const QString &fileName) const;
+
+    QTemporaryDir *dir;
+    QString path;
+    HttpStandIn *server;
+    QNetworkAccessManager *network;
+};
+
+void tst_downloadrestartguard::init()
+{
+    dir = new QTemporaryDir;
+    path = dir->path() + "/file.bin";
+    server = new HttpStandIn;
+    QVERIFY(server->isListening());
+    network = new QNetworkAccessManager;
+}
+
+void tst_downloadrestartguard::cleanup()
+{
+    delete network;
+    delete server;
+    delete dir;
+}
+
+bool tst_downloadrestartguard::download(DownloadResumer &resumer)
+{
+    QSignalSpy finishedSpy(&resumer, SIGNAL(finished(bool)));
+    resumer.start();
+    if (finishedSpy.isEmpty() && !finishedSpy.wait(5000)) {
+        return false;
+    }
+    return finishedSpy.first().at(0).toBool();
+}
+
+void tst_downloadrestartguard::writePartial(int bytes)
+{
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(server->content.left(bytes));
+}
+
+// Gecko writes the restarted download from the first byte.
+void tst_downloadrestartguard::geckoRestart()
+{
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write(QByteArray(100, 'x'));
+}
+
+QByteArray tst_downloadrestartguard::fileContent(const QString &fileName) const
+{
+    QFile file(fileName);
+    file.open(QIODevice::ReadOnly);
+    return file.readAll();
+}
+
+void tst_downloadrestartguard::geckoRestartThenResume()
+{
+    writePartial(30000);
+
+    DownloadRestartGuard guard;
+    QSignalSpy cancelSpy(&guard, SIGNAL(cancelRequested(qulonglong)));
+    QSignalSpy resumeSpy(&guard, SIGNAL(resumeRequested(QString)));
+    guard.hold(path);
+    QVERIFY(guard.isHeld(path));
+    QVERIFY(!QFile::exists(path));
+    QCOMPARE(fileContent(DownloadRestartGuard::partialPath(path)).size(), 30000);
+
+    // dl-start of Gecko's restart.
+    geckoRestart();
+    guard.cancelRestart(7, path);
+    QCOMPARE(cancelSpy.count(), 1);
+    QCOMPARE(cancelSpy.first().at(0).toULongLong(), qulonglong(7));
+    QVERIFY(guard.isCanceling(7));
+    QVERIFY(resumeSpy.isEmpty());
+
+    // Gecko removes the file of a canceled download before dl-cancel.
+    QFile::remove(path);
+    guard.restartFinished(7);
+    QVERIFY(!guard.isCanceling(7));
+    QVERIFY(!guard.isHeld(path));
+    QCOMPARE(resumeSpy.count(), 1);
+    QCOMPARE(resumeSpy.first().at(0).toString(), path);
+    QVERIFY(fileContent(path) == server->content.left(30000));
+    QVERIFY(!QFile::exists(DownloadRestartGuard::partialPath(path)));
+
+    DownloadResumer resumer(server->url(), path, network);
+    resumer.setExpectedSize(server->content.size());
+    resumer.setValidators(server->etag, QString());
+    QVERIFY(download(resumer));
+    QCOMPARE(server->requests.count(), 1);
+    QCOMPARE(server->requests.first().value("range"), QByteArray("bytes=30000-"));
+    QCOMPARE(resumer.resumedFrom(), qint64(30000));
+    QVERIFY(fileContent(path) == server->content);
+}
+
+void tst_downloadrestartguard::geckoRestartOfRunningResumer()
+{
+    writePartial(10000);
+    server->chunkSize = 1000;
+
+    DownloadResumer resumer(server->url(), path, network);
+    resumer.setExpectedSize(server->content.size());
+    resumer.setValidators(server->etag, QString());
+    resumer.start();
+    QTRY_VERIFY(resumer.received() > 12000);
+
+    // Gecko restarts the download late, the resumer stops writing until it has been canceled.
+    DownloadRestartGuard guard;
+    QSignalSpy resumeSpy(&guard, SIGNAL(resumeRequested(QString)));
+    resumer.pause();
+    QTRY_COMPARE(server->activeCount, 0);
+    guard.hold(path);
+    geckoRestart();
+    guard.cancelRestart(8, path);
+    QFile::remove(path);
+    guard.restartFinished(8);
+    QCOMPARE(resumeSpy.count(), 1);
+
+    qint64 received = fileContent(path).size();
+    QVERIFY(received > 12000);
+    server->chunkSize = 0;
+    QVERIFY(download(resumer));
+    QCOMPARE(resumer.resumedFrom(), received);
+    QVERIFY(fileContent(path) == server->content);
+}
+
+void tst_downloadrestartguard::timeoutReleasesDownloads()
+{
+    writePartial(30000);
+
+    DownloadRestartGuard guard;
+    guard.setTimeout(50);
+    QSignalSpy resumeSpy(&guard, SIGNAL(resumeRequested(QString)));
+    guard.hold(path);
+    guard.startTimeout();
+    QVERIFY(resumeSpy.wait(1000));
+    QCOMPARE(resumeSpy.first().at(0).toString(), path);
+    QVERIFY(!guard.isHeld(path));
+    QVERIFY(fileContent(path) == server->content.left(30000));
+}
+
+void tst_downloadrestartguard::timeoutWaitsForCancel()
+{
+    writePartial(30000);
+
+    DownloadRestartGuard guard;
+    guard.setTimeout(50);
+    QSignalSpy resumeSpy(&guard, SIGNAL(resumeRequested(QString)));
+    guard.hold(path);
+    guard.cancelRestart(9, path);
+    geckoRestart();
+    guard.startTimeout();
+    QTest::qWait(200);
+    QVERIFY(resumeSpy.isEmpty());
+    QVERIFY(guard.isHeld(path));
+
+    guard.restartFinished(9);
+    QCOMPARE(resumeSpy.count(), 1);
+    QVERIFY(fileContent(path) == server->content.left(30000));
+}
+
+void tst_downloadrestartguard::discard()
+{
+    writePartial(30000);
+
+    DownloadRestartGuard guard;
+    guard.hold(path);
+    QVERIFY(guard.hasHeld());
+    guard.discard(path);
+    QVERIFY(!guard.hasHeld());
+    QVERIFY(!QFile::exists(path));
+    QVERIFY(!QFile::exists(DownloadRestartGuard::partialPath(path)));
+}
+
+QTEST_GUILESS_MAIN(tst_downloadrestartguard)
+#include "tst_downloadrestartguard.moc"
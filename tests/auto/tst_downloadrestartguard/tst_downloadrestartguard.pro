@@ -0,0 +1,9 @@
+TARGET = tst_downloadrestartguard
+include(../test_common.pri)
+include(../common/httpstandin.pri)
+
+SOURCES += tst_downloadrestartguard.cpp \
+    ../../../src/downloadrestartguard.cpp \
+    ../../../src/downloadresumer.cpp
+HEADERS += ../../../src/downloadrestartguard.h \
+    ../../../src/downloadresumer.h
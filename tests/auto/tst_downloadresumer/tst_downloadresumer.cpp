@@ -0,0 +1,271 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QtTest>
+#include <QNetworkAccessManager>
+#include <QTemporaryDir>
+#include "downloadresumer.h"
+#include "httpstandin.h"
+
+class tst_downloadresumer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void fullDownload();
+    void resumePartial();
+    void resumeAfterInterruption();
+    void changedResource();
+    void rangeNotSupported();
+    void alreadyComplete();
+    void partialWithoutValidator();
+    void sizeWithoutValidator();
+    void bandwidthLimit();
+    void pauseAndResume();
+
+private:
+    bool download(DownloadResumer &resumer);
+    void writePartial(int bytes);
+    QByteArray fileContent() const;
+
+    QTemporaryDir *dir;
+    QString path;
+    HttpStandIn *server;
+    QNetworkAccessManager *network;
+};
+
+void tst_downloadresumer::init()
+{
+    dir = new QTemporaryDir;
+    path = dir->path() + "/file.bin";
+    server = new HttpStandIn;
+    QVERIFY(server->isListening());
+    network = new QNetworkAccessManager;
+}
+
+void tst_downloadresumer::cleanup()
+{
+    delete network;
+    delete server;
+    delete dir;
+}
+
+bool tst_downloadresumer::download(DownloadResumer &resumer)
+{
+    QSignalSpy finishedSpy(&resumer, SIGNAL(finished(bool)));
+    resumer.start();
+    if (finishedSpy.isEmpty() && !finishedSpy.wait(5000)) {
+        return false;
+    }
+    return finishedSpy.first().at(0).toBool();
+}
+
+void tst_downloadresumer::writePartial(int bytes)
+{
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(server->content.left(bytes));
+}
+
+QByteArray tst_downloadresumer::fileContent() const
+{
+    QFile file(path);
+    file.open(QIODevice::ReadOnly);
+    return file.readAll();
+}
+
+void tst_downloadresumer::fullDownload()
+{
+    DownloadResumer resumer(server->url(), path, network);
+    QSignalSpy progressSpy(&resumer, SIGNAL(progress(qint64,qint64)));
+    QVERIFY(download(resumer));
+
+    QCOMPARE(server->requests.count(), 1);
+    QVERIFY(!server->requests.first().contains("range"));
+    QCOMPARE(server->requests.first().value("accept-encoding"), QByteArray("identity"));
+    QVERIFY(fileContent() == server->content);
+    QCOMPARE(resumer.resumedFrom(), qint64(0));
+    QCOMPARE(resumer.received(), qint64(server->content.size()));
+    QCOMPARE(resumer.size(), qint64(server->content.size()));
+    QCOMPARE(resumer.etag(), QString(server->etag));
+    QVERIFY(!progressSpy.isEmpty());
+    QCOMPARE(progressSpy.last().at(0).toLongLong(), qint64(server->content.size()));
+}
+
+void tst_downloadresumer::resumePartial()
+{
+    writePartial(30000);
+
+    DownloadResumer resumer(server->url(), path, network);
+    resumer.setExpectedSize(server->content.size());
+    resumer.setValidators(server->etag, QString());
+    QVERIFY(download(resumer));
+
+    QCOMPARE(server->requests.count(), 1);
+    QCOMPARE(server->requests.first().value("range"), QByteArray("bytes=30000-"));
+    QCOMPARE(server->requests.first().value("if-range"), server->etag);
+    QCOMPARE(server->bodyBytesSent, qint64(server->content.size() - 30000));
+    QCOMPARE(resumer.resumedFrom(), qint64(30000));
+    QVERIFY(fileContent() == server->content);
+}
+
+void tst_downloadresumer::resumeAfterInterruption()
+{
+    server->cutAfter = 40000;
+    qint64 received = 0;
+    QString etag;
+    {
+        DownloadResumer resumer(server->url(), path, network);
+        QVERIFY(!download(resumer));
+        received = resumer.received();
+        etag = resumer.etag();
+    }
+    QVERIFY(received > 0);
+    QVERIFY(received <= 40000);
+    QCOMPARE(QFileInfo(path).size(), received);
+    QCOMPARE(etag, QString(server->etag));
+
+    // Relaunch with what the registry recorded.
+    server->cutAfter = 0;
+    server->bodyBytesSent = 0;
+    DownloadResumer resumer(server->url(), path, network);
+    resumer.setExpectedSize(server->content.size());
+    resumer.setValidators(etag, QString());
+    QVERIFY(download(resumer));
+
+    QCOMPARE(server->requests.count(), 2);
+    QCOMPARE(server->requests.last().value("range"), QByteArray("bytes=" + QByteArray::number(received) + "-"));
+    QCOMPARE(server->bodyBytesSent, server->content.size() - received);
+    QVERIFY(fileContent() == server->content);
+}
+
+void tst_downloadresumer::changedResource()
+{
+    writePartial(30000);
+    server->etag = "\"v2\"";
+    server->content[0] = 'X';
+
+    DownloadResumer resumer(server->url(), path, network);
+    resumer.setExpectedSize(server->content.size());
+    resumer.setValidators("\"v1\"", QString());
+    QVERIFY(download(resumer));
+
+    QCOMPARE(server->requests.count(), 1);
+    QCOMPARE(server->requests.first().value("if-range"), QByteArray("\"v1\""));
+    QCOMPARE(server->bodyBytesSent, qint64(server->content.size()));
+    QCOMPARE(resumer.etag(), QString("\"v2\""));
+    QVERIFY(fileContent() == server->content);
+}
+
+void tst_downloadresumer::rangeNotSupported()
+{
+    writePartial(30000);
+    server->supportsRanges = false;
+
+    DownloadResumer resumer(server->url(), path, network);
+    resumer.setExpectedSize(server->content.size());
+    resumer.setValidators(server->etag, QString());
+    QVERIFY(download(resumer));
+
+    QCOMPARE(server->bodyBytesSent, qint64(server->content.size()));
+    QVERIFY(fileContent() == server->content);
+}
+
+void tst_downloadresumer::alreadyComplete()
+{
+    writePartial(server->content.size());
+
+    DownloadResumer resumer(server->url(), path, network);
+    resumer.setExpectedSize(server->content.size());
+    resumer.setValidators(server->etag, QString());
+    QVERIFY(download(resumer));
+
+    QCOMPARE(server->bodyBytesSent, qint64(0));
+    QVERIFY(fileContent() == server->content);
+}
+
+void tst_downloadresumer::partialWithoutValidator()
+{
+    // Neither size nor validator to check the partial content against.
+    writePartial(30000);
+
+    DownloadResumer resumer(server->url(), path, network);
+    QVERIFY(download(resumer));
+
+    QCOMPARE(server->requests.count(), 1);
+    QVERIFY(!server->requests.first().contains("range"));
+    QVERIFY(fileContent() == server->content);
+}
+
+void tst_downloadresumer::sizeWithoutValidator()
+{
+    // Partial content of the same size may still be of another version.
+    writePartial(30000);
+
+    DownloadResumer resumer(server->url(), path, network);
+    resumer.setExpectedSize(server->content.size());
+    resumer.setValidators("W/\"weak\"", QString());
+    QVERIFY(download(resumer));
+
+    QCOMPARE(server->requests.count(), 1);
+    QVERIFY(!server->requests.first().contains("range"));
+    QCOMPARE(resumer.resumedFrom(), qint64(0));
+    QVERIFY(fileContent() == server->content);
+}
+
+void tst_downloadresumer::bandwidthLimit()
+{
+    DownloadResumer resumer(server->url(), path, network);
+    resumer.setBandwidthLimit(200000);
+
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY(download(resumer));
+
+    // 100000 bytes in slices of 20000 bytes every 100 ms.
+    QVERIFY(timer.elapsed() >= 350);
+    QVERIFY(fileContent() == server->content);
+}
+
+void tst_downloadresumer::pauseAndResume()
+{
+    server->chunkSize = 2000;
+
+    DownloadResumer resumer(server->url(), path, network);
+    resumer.setExpectedSize(server->content.size());
+    QSignalSpy finishedSpy(&resumer, SIGNAL(finished(bool)));
+    resumer.start();
+    QTRY_VERIFY(resumer.received() >= 20000);
+
+    resumer.pause();
+    QVERIFY(resumer.isPaused());
+    QTRY_COMPARE(server->activeCount, 0);
+    qint64 received = resumer.received();
+    QVERIFY(received < server->content.size());
+    QCOMPARE(QFileInfo(path).size(), received);
+    QTest::qWait(100);
+    QVERIFY(finishedSpy.isEmpty());
+
+    resumer.start();
+    QVERIFY(!resumer.isPaused());
+    QVERIFY(finishedSpy.wait(5000));
+    QVERIFY(finishedSpy.first().at(0).toBool());
+
+    QCOMPARE(server->requests.count(), 2);
+    QCOMPARE(server->requests.last().value("range"), QByteArray("bytes=" + QByteArray::number(received) + "-"));
+    QVERIFY(fileContent() == server->content);
+}
+
+QTEST_GUILESS_MAIN(tst_downloadresumer)
+#include "tst_downloadresumer.moc"
@@ -0,0 +1,7 @@
+TARGET = tst_downloadresumer
+include(../test_common.pri)
+include(../common/httpstandin.pri)
+
+SOURCES += tst_downloadresumer.cpp \
+    ../../../src/downloadresumer.cpp
+HEADERS += ../../../src/downloadresumer.h
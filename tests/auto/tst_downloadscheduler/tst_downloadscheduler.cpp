@@ -0,0 +1,327 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QtTest>
+#include <QNetworkAccessManager>
+#include <QTemporaryDir>
+#include "downloadresumer.h"
+#include "downloadscheduler.h"
+#include "httpstandin.h"
+
+class tst_downloadscheduler : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void concurrencyLimit();
+    void priorityOrder();
+    void pauseWhilePageLoading();
+    void shortPageLoad();
+    void pageKeepsLoading();
+    void changeMaxActive();
+    void removeQueued();
+    void notPausable();
+    void scheduledDownloads();
+
+    // Drives the resumers as DownloadManager does.
+    void pauseDownload(QString key);
+    void resumeDownload(QString key);
+    void downloadFinished(bool success);
+
+private:
+    QStringList signalKeys(QSignalSpy &spy) const;
+
+    DownloadScheduler *scheduler;
+    QHash<QString, DownloadResumer *> resumers;
+    int succeeded;
+};
+
+void tst_downloadscheduler::init()
+{
+    scheduler = new DownloadScheduler;
+    succeeded = 0;
+}
+
+void tst_downloadscheduler::cleanup()
+{
+    qDeleteAll(resumers);
+    resumers.clear();
+    delete scheduler;
+}
+
+QStringList tst_downloadscheduler::signalKeys(QSignalSpy &spy) const
+{
+    QStringList keys;
+    for (int i = 0; i < spy.count(); ++i) {
+        keys << spy.at(i).at(0).toString();
+    }
+    spy.clear();
+    return keys;
+}
+
+void tst_downloadscheduler::concurrencyLimit()
+{
+    QSignalSpy pauseSpy(scheduler, SIGNAL(pauseRequested(QString)));
+    QSignalSpy resumeSpy(scheduler, SIGNAL(resumeRequested(QString)));
+    QCOMPARE(scheduler->maxActive(), 2);
+
+    scheduler->add("a");
+    scheduler->add("b");
+    QVERIFY(pauseSpy.isEmpty());
+    scheduler->add("c");
+    scheduler->add("d");
+    scheduler->add("a");
+    QCOMPARE(signalKeys(pauseSpy), QStringList() << "c" << "d");
+    QCOMPARE(scheduler->activeCount(), 2);
+    QCOMPARE(scheduler->queuedCount(), 2);
+    QVERIFY(scheduler->isActive("a"));
+    QVERIFY(!scheduler->isActive("c"));
+
+    scheduler->remove("a");
+    QCOMPARE(signalKeys(resumeSpy), QStringList() << "c");
+    scheduler->remove("b");
+    QCOMPARE(signalKeys(resumeSpy), QStringList() << "d");
+    scheduler->remove("c");
+    scheduler->remove("d");
+    QVERIFY(resumeSpy.isEmpty());
+    QVERIFY(pauseSpy.isEmpty());
+    QCOMPARE(scheduler->activeCount(), 0);
+    QVERIFY(!scheduler->contains("a"));
+}
+
+void tst_downloadscheduler::priorityOrder()
+{
+    QSignalSpy resumeSpy(scheduler, SIGNAL(resumeRequested(QString)));
+    scheduler->setMaxActive(1);
+
+    scheduler->add("running");
+    scheduler->add("resumed1", -1);
+    scheduler->add("new1");
+    scheduler->add("resumed2", -1);
+    scheduler->add("urgent", 5);
+    scheduler->add("new2");
+
+    QStringList order;
+    QString current = "running";
+    while (!current.isEmpty()) {
+        scheduler->remove(current);
+        QStringList resumed = signalKeys(resumeSpy);
+        current = resumed.isEmpty() ? QString() : resumed.first();
+        if (!current.isEmpty()) {
+            order << current;
+        }
+    }
+    QCOMPARE(order, QStringList() << "urgent" << "new1" << "new2" << "resumed1" << "resumed2");
+}
+
+void tst_downloadscheduler::pauseWhilePageLoading()
+{
+    QSignalSpy pauseSpy(scheduler, SIGNAL(pauseRequested(QString)));
+    QSignalSpy resumeSpy(scheduler, SIGNAL(resumeRequested(QString)));
+    scheduler->add("a");
+    scheduler->add("b");
+    scheduler->add("c");
+    QCOMPARE(signalKeys(pauseSpy), QStringList() << "c");
+
+    scheduler->setPaused(true);
+    QVERIFY(scheduler->paused());
+    QCOMPARE(signalKeys(pauseSpy).toSet(), QSet<QString>() << "a" << "b");
+    QCOMPARE(scheduler->activeCount(), 0);
+
+    // Downloads started during the page load wait too.
+    scheduler->add("d");
+    QCOMPARE(signalKeys(pauseSpy), QStringList() << "d");
+    scheduler->setPaused(true);
+    QVERIFY(pauseSpy.isEmpty());
+
+    // Paused downloads continue in their original order.
+    scheduler->setPaused(false);
+    QCOMPARE(signalKeys(resumeSpy), QStringList() << "a" << "b");
+    QCOMPARE(scheduler->queuedCount(), 2);
+}
+
+void tst_downloadscheduler::shortPageLoad()
+{
+    QSignalSpy pauseSpy(scheduler, SIGNAL(pauseRequested(QString)));
+    scheduler->setPauseDelay(200);
+    scheduler->add("a");
+
+    scheduler->setPageLoading(true);
+    QVERIFY(!scheduler->paused());
+    scheduler->setPageLoading(false);
+    QTest::qWait(300);
+    QVERIFY(!scheduler->paused());
+    QVERIFY(pauseSpy.isEmpty());
+
+    scheduler->setPageLoading(true);
+    QTRY_VERIFY(scheduler->paused());
+    QCOMPARE(signalKeys(pauseSpy), QStringList() << "a");
+}
+
+void tst_downloadscheduler::pageKeepsLoading()
+{
+    QSignalSpy pauseSpy(scheduler, SIGNAL(pauseRequested(QString)));
+    QSignalSpy resumeSpy(scheduler, SIGNAL(resumeRequested(QString)));
+    scheduler->setPauseDelay(0);
+    scheduler->setMaxPause(200);
+    scheduler->add("a");
+
+    scheduler->setPageLoading(true);
+    QTRY_VERIFY(scheduler->paused());
+    QCOMPARE(signalKeys(pauseSpy), QStringList() << "a");
+
+    // Page that never finishes loading does not stall the downloads.
+    QTRY_VERIFY(!scheduler->paused());
+    QCOMPARE(signalKeys(resumeSpy), QStringList() << "a");
+    scheduler->setPageLoading(true);
+    QTest::qWait(100);
+    QVERIFY(!scheduler->paused());
+
+    // Next page load pauses again.
+    scheduler->setPageLoading(false);
+    QVERIFY(resumeSpy.isEmpty());
+    scheduler->setPageLoading(true);
+    QTRY_VERIFY(scheduler->paused());
+    scheduler->setPageLoading(false);
+    QVERIFY(!scheduler->paused());
+    QCOMPARE(signalKeys(resumeSpy), QStringList() << "a");
+}
+
+void tst_downloadscheduler::changeMaxActive()
+{
+    QSignalSpy pauseSpy(scheduler, SIGNAL(pauseRequested(QString)));
+    QSignalSpy resumeSpy(scheduler, SIGNAL(resumeRequested(QString)));
+    scheduler->setMaxActive(4);
+    scheduler->add("a");
+    scheduler->add("b");
+    scheduler->add("c");
+
+    scheduler->setMaxActive(1);
+    QCOMPARE(signalKeys(pauseSpy), QStringList() << "c" << "b");
+    QVERIFY(scheduler->isActive("a"));
+
+    scheduler->setMaxActive(0);
+    QCOMPARE(scheduler->maxActive(), 1);
+
+    scheduler->setMaxActive(3);
+    QCOMPARE(signalKeys(resumeSpy), QStringList() << "b" << "c");
+}
+
+void tst_downloadscheduler::removeQueued()
+{
+    QSignalSpy resumeSpy(scheduler, SIGNAL(resumeRequested(QString)));
+    scheduler->setMaxActive(1);
+    scheduler->add("a");
+    scheduler->add("b");
+    scheduler->add("c");
+
+    scheduler->remove("b");
+    QVERIFY(resumeSpy.isEmpty());
+    scheduler->remove("a");
+    QCOMPARE(signalKeys(resumeSpy), QStringList() << "c");
+}
+
+void tst_downloadscheduler::notPausable()
+{
+    QSignalSpy pauseSpy(scheduler, SIGNAL(pauseRequested(QString)));
+    QSignalSpy resumeSpy(scheduler, SIGNAL(resumeRequested(QString)));
+    scheduler->add("a", 0, false);
+    scheduler->add("b");
+    scheduler->add("c", 0, false);
+    // Over the limit when added, queued even if not pausable.
+    QCOMPARE(signalKeys(pauseSpy), QStringList() << "c");
+
+    // Running download that is not pausable keeps running.
+    scheduler->setPaused(true);
+    QCOMPARE(signalKeys(pauseSpy), QStringList() << "b");
+    QVERIFY(scheduler->isActive("a"));
+
+    scheduler->setMaxActive(1);
+    QVERIFY(pauseSpy.isEmpty());
+    scheduler->remove("a");
+    QVERIFY(resumeSpy.isEmpty());
+
+    scheduler->setPaused(false);
+    QCOMPARE(signalKeys(resumeSpy), QStringList() << "b");
+    QVERIFY(scheduler->isActive("b"));
+    QCOMPARE(scheduler->queuedCount(), 1);
+}
+
+void tst_downloadscheduler::scheduledDownloads()
+{
+    HttpStandIn server;
+    QVERIFY(server.isListening());
+    server.chunkSize = 2000;
+    QTemporaryDir dir;
+    QNetworkAccessManager network;
+
+    connect(scheduler, SIGNAL(pauseRequested(QString)), this, SLOT(pauseDownload(QString)));
+    connect(scheduler, SIGNAL(resumeRequested(QString)), this, SLOT(resumeDownload(QString)));
+
+    for (int i = 0; i < 4; ++i) {
+        QString path = dir.path() + QString("/file%1.bin").arg(i);
+        DownloadResumer *resumer = new DownloadResumer(server.url(), path, &network);
+        resumer->setExpectedSize(server.content.size());
+        connect(resumer, SIGNAL(finished(bool)), this, SLOT(downloadFinished(bool)));
+        resumers.insert(path, resumer);
+        scheduler->add(path);
+        if (scheduler->isActive(path)) {
+            resumer->start();
+        }
+    }
+
+    QTRY_COMPARE(server.activeCount, 2);
+
+    // Page starts loading in the foreground.
+    scheduler->setPaused(true);
+    QTRY_COMPARE(server.activeCount, 0);
+    QTest::qWait(100);
+    QCOMPARE(succeeded, 0);
+
+    scheduler->setPaused(false);
+    QTRY_COMPARE_WITH_TIMEOUT(succeeded, 4, 10000);
+    QCOMPARE(server.maxActiveCount, 2);
+    QCOMPARE(scheduler->activeCount(), 0);
+    QCOMPARE(scheduler->queuedCount(), 0);
+
+    foreach (const QString &path, resumers.keys()) {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QVERIFY(file.readAll() == server.content);
+    }
+    // Paused downloads continued from where they were.
+    QVERIFY(server.bodyBytesSent < 5 * server.content.size());
+}
+
+void tst_downloadscheduler::pauseDownload(QString key)
+{
+    resumers.value(key)->pause();
+}
+
+void tst_downloadscheduler::resumeDownload(QString key)
+{
+    resumers.value(key)->start();
+}
+
+void tst_downloadscheduler::downloadFinished(bool success)
+{
+    DownloadResumer *resumer = qobject_cast<DownloadResumer *>(sender());
+    if (success) {
+        ++succeeded;
+    }
+    scheduler->remove(resumer->targetPath());
+}
+
+QTEST_GUILESS_MAIN(tst_downloadscheduler)
+#include "tst_downloadscheduler.moc"
@@ -0,0 +1,9 @@
+TARGET = tst_downloadscheduler
+include(../test_common.pri)
+include(../common/httpstandin.pri)
+
+SOURCES += tst_downloadscheduler.cpp \
+    ../../../src/downloadresumer.cpp \
+    ../../../src/downloadscheduler.cpp
+HEADERS += ../../../src/downloadresumer.h \
+    ../../../src/downloadscheduler.h
@@ -0,0 +1,8 @@
+TARGET = tst_faviconcache
+include(../test_common.pri)
+
+QT += network
+
+SOURCES += tst_faviconcache.cpp \
+    ../../../src/faviconcache.cpp
+HEADERS += ../../../src/faviconcache.h
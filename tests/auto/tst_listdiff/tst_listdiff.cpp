@@ -0,0 +1,161 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QtTest>
+#include "listdiff.h"
+
+Q_DECLARE_METATYPE(QVector<QString>)
+
+class tst_listdiff : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void edits_data();
+    void edits();
+    void randomLists();
+    void commonRowsBenchmark();
+
+private:
+    QVector<QString> apply(QVector<QString> keys, const QVector<QString> &newKeys, const QList<ListEdit> &edits) const;
+    QVector<QString> keys(int count, const QString &prefix = QString("http://example.com/%1")) const;
+};
+
+// Applies the edits as a list model does.
+QVector<QString> tst_listdiff::apply(QVector<QString> keys, const QVector<QString> &newKeys, const QList<ListEdit> &edits) const
+{
+    foreach (const ListEdit &edit, edits) {
+        if (edit.type == ListEdit::Remove) {
+            keys.remove(edit.first, edit.last - edit.first + 1);
+        } else if (edit.type == ListEdit::Insert) {
+            for (int row = edit.first; row <= edit.last; ++row) {
+                keys.insert(row, newKeys.at(row));
+            }
+        } else {
+            QString key = keys.at(edit.first);
+            keys.remove(edit.first);
+            keys.insert(edit.last, key);
+        }
+    }
+    return keys;
+}
+
+QVector<QString> tst_listdiff::keys(int count, const QString &prefix) const
+{
+    QVector<QString> list;
+    for (int i = 0; i < count; ++i) {
+        list.append(prefix.arg(i));
+    }
+    return list;
+}
+
+void tst_listdiff::edits_data()
+{
+    QTest::addColumn<QVector<QString> >("newKeys");
+    QTest::addColumn<int>("inserted");
+    QTest::addColumn<int>("removed");
+    QTest::addColumn<int>("moved");
+
+    QVector<QString> current = keys(500);
+    QVector<QString> list = current;
+    list.prepend("http://new.example.com/");
+    QTest::newRow("insertFirst") << list << 1 << 0 << 0;
+
+    list = current;
+    list.remove(250);
+    QTest::newRow("remove") << list << 0 << 1 << 0;
+
+    list = current;
+    list.insert(10, list.at(400));
+    list.remove(401);
+    QTest::newRow("moveUp") << list << 0 << 0 << 1;
+
+    list = current;
+    list.insert(401, list.at(10));
+    list.remove(10);
+    QTest::newRow("moveDown") << list << 1 << 1 << 0;
+
+    QTest::newRow("same") << current << 0 << 0 << 0;
+    QTest::newRow("clear") << QVector<QString>() << 0 << 1 << 0;
+
+    // Unrelated search results replace the rows in one go.
+    QTest::newRow("replace") << keys(500, QString("http://other.example.com/%1")) << 1 << 1 << 0;
+}
+
+void tst_listdiff::edits()
+{
+    QFETCH(QVector<QString>, newKeys);
+    QFETCH(int, inserted);
+    QFETCH(int, removed);
+    QFETCH(int, moved);
+
+    QVector<QString> oldKeys = keys(500);
+    QList<ListEdit> edits = ListDiff::edits(oldKeys, newKeys);
+    int counts[3] = { 0, 0, 0 };
+    foreach (const ListEdit &edit, edits) {
+        ++counts[edit.type];
+    }
+    QCOMPARE(counts[ListEdit::Insert], inserted);
+    QCOMPARE(counts[ListEdit::Remove], removed);
+    QCOMPARE(counts[ListEdit::Move], moved);
+    QCOMPARE(apply(oldKeys, newKeys, edits), newKeys);
+}
+
+// Shuffled, shortened, and extended lists with duplicate keys end up as the new list.
+void tst_listdiff::randomLists()
+{
+    qsrand(42);
+    for (int round = 0; round < 500; ++round) {
+        QVector<QString> oldKeys;
+        QVector<QString> newKeys;
+        int oldCount = qrand() % 40;
+        int newCount = qrand() % 40;
+        for (int i = 0; i < oldCount; ++i) {
+            oldKeys.append(QString::number(qrand() % 30));
+        }
+        for (int i = 0; i < newCount; ++i) {
+            newKeys.append(QString::number(qrand() % 30));
+        }
+        QCOMPARE(apply(oldKeys, newKeys, ListDiff::edits(oldKeys, newKeys)), newKeys);
+
+        bool complete = false;
+        QVector<int> source = ListDiff::commonRows(oldKeys, newKeys, &complete);
+        QVERIFY(complete);
+        int previous = -1;
+        for (int j = 0; j < source.count(); ++j) {
+            if (source.at(j) >= 0) {
+                QCOMPARE(newKeys.at(j), oldKeys.at(source.at(j)));
+                QVERIFY(source.at(j) > previous);
+                previous = source.at(j);
+            }
+        }
+    }
+}
+
+// Middle of 1000 rows differs by 200 edits.
+void tst_listdiff::commonRowsBenchmark()
+{
+    QVector<QString> oldKeys = keys(1000);
+    QVector<QString> newKeys = oldKeys;
+    for (int i = 0; i < 100; ++i) {
+        newKeys.remove(100 + i * 7);
+        newKeys.insert(101 + i * 7, QString("http://new.example.com/%1").arg(i));
+    }
+
+    bool complete = false;
+    QBENCHMARK {
+        ListDiff::commonRows(oldKeys, newKeys, &complete);
+    }
+    QVERIFY(complete);
+}
+
+QTEST_APPLESS_MAIN(tst_listdiff)
+#include "tst_listdiff.moc"
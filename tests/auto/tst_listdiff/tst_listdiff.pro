@@ -0,0 +1,4 @@
+TARGET = tst_listdiff
+include(../test_common.pri)
+
+SOURCES += tst_listdiff.cpp
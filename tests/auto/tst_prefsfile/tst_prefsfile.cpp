@@ -0,0 +1,168 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QtTest>
+#include <QTemporaryDir>
+#include "prefsfile.h"
+
+class tst_prefsfile : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void formatValue_data();
+    void formatValue();
+    void content();
+    void unsupportedValue();
+    void save();
+    void saveUnchanged();
+    void keepUserPrefs();
+    void replaceLegacyFile();
+};
+
+void tst_prefsfile::formatValue_data()
+{
+    QTest::addColumn<QVariant>("value");
+    QTest::addColumn<QByteArray>("expected");
+
+    QTest::newRow("true") << QVariant(true) << QByteArray("true");
+    QTest::newRow("false") << QVariant(false) << QByteArray("false");
+    QTest::newRow("int") << QVariant(800) << QByteArray("800");
+    QTest::newRow("negative") << QVariant(-2) << QByteArray("-2");
+    QTest::newRow("string") << QVariant(QString("certerror")) << QByteArray("\"certerror\"");
+    QTest::newRow("float string") << QVariant(QString("0.13f")) << QByteArray("\"0.13f\"");
+    QTest::newRow("quotes") << QVariant(QString("a \"b\" \\c")) << QByteArray("\"a \\\"b\\\" \\\\c\"");
+    QTest::newRow("unicode") << QVariant(QString::fromUtf8("/home/nemo/Lataukset/\xc3\xa4")) << QByteArray("\"/home/nemo/Lataukset/\\u00e4\"");
+    QTest::newRow("newline") << QVariant(QString("a\nb")) << QByteArray("\"a\\u000ab\"");
+    QTest::newRow("integral double") << QVariant(32.0) << QByteArray("32");
+    QTest::newRow("negative double") << QVariant(-2.0) << QByteArray("-2");
+    QTest::newRow("double") << QVariant(0.13) << QByteArray("\"0.13\"");
+    QTest::newRow("large double") << QVariant(1e12) << QByteArray("\"1e+12\"");
+    QTest::newRow("float") << QVariant(0.5f) << QByteArray("\"0.5\"");
+    QTest::newRow("nan") << QVariant(qQNaN()) << QByteArray();
+    QTest::newRow("infinity") << QVariant(qInf()) << QByteArray();
+}
+
+void tst_prefsfile::formatValue()
+{
+    QFETCH(QVariant, value);
+    QFETCH(QByteArray, expected);
+
+    QCOMPARE(PrefsFile::formatValue(value), expected);
+}
+
+void tst_prefsfile::content()
+{
+    PrefsFile prefs("user.js");
+    prefs.setPref("keyword.enabled", true);
+    prefs.setPref("intl.accept_languages", QString("fi-FI,fi"));
+    prefs.setPref("keyword.enabled", false);
+
+    QList<QByteArray> lines = prefs.toByteArray().split('\n');
+    QVERIFY(lines.takeFirst().startsWith("// Begin"));
+    QCOMPARE(lines.at(0), QByteArray("user_pref(\"intl.accept_languages\", \"fi-FI,fi\");"));
+    QCOMPARE(lines.at(1), QByteArray("user_pref(\"keyword.enabled\", false);"));
+    QVERIFY(lines.at(2).startsWith("// End"));
+    QCOMPARE(lines.count(), 4);
+}
+
+void tst_prefsfile::unsupportedValue()
+{
+    PrefsFile prefs("user.js");
+    prefs.setPref("embedlite.zoomMargin", qQNaN());
+    prefs.setPref("keyword.enabled", true);
+
+    QByteArray content = prefs.toByteArray();
+    QVERIFY(!content.contains("embedlite.zoomMargin"));
+    QVERIFY(content.contains("user_pref(\"keyword.enabled\", true);"));
+}
+
+void tst_prefsfile::save()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    // The profile does not exist on first start.
+    PrefsFile prefs(dir.path() + "/profile/user.js");
+    prefs.setPref("embedlite.zoomMargin", 14);
+    QVERIFY(prefs.save());
+
+    QFile file(prefs.path());
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), prefs.toByteArray());
+    file.close();
+
+    prefs.setPref("embedlite.zoomMargin", 16);
+    QVERIFY(prefs.save());
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QVERIFY(file.readAll().contains("user_pref(\"embedlite.zoomMargin\", 16);"));
+}
+
+void tst_prefsfile::saveUnchanged()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    PrefsFile prefs(dir.path() + "/user.js");
+    prefs.setPref("geo.wifi.scan", false);
+    QVERIFY(prefs.save());
+
+    QFileInfo before(prefs.path());
+    QTest::qSleep(1100);
+    QVERIFY(prefs.save());
+    QFileInfo after(prefs.path());
+    QCOMPARE(after.lastModified(), before.lastModified());
+}
+
+void tst_prefsfile::keepUserPrefs()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    QFile file(dir.path() + "/user.js");
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("// My tweaks\nuser_pref(\"browser.cache.disk.capacity\", 1000);\n");
+    file.close();
+
+    PrefsFile prefs(file.fileName());
+    prefs.setPref("embedlite.zoomMargin", 14);
+    QVERIFY(prefs.save());
+
+    // User edits the file between starts.
+    QVERIFY(file.open(QIODevice::Append));
+    file.write("user_pref(\"general.useragent.locale\", \"fi\");\n");
+    file.close();
+
+    prefs.setPref("embedlite.zoomMargin", 16);
+    QVERIFY(prefs.save());
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QByteArray content = file.readAll();
+    QCOMPARE(content, QByteArray("// My tweaks\n"
+                                 "user_pref(\"browser.cache.disk.capacity\", 1000);\n"
+                                 "user_pref(\"general.useragent.locale\", \"fi\");\n")
+             + prefs.toByteArray());
+    QCOMPARE(content.count("embedlite.zoomMargin"), 1);
+}
+
+void tst_prefsfile::replaceLegacyFile()
+{
+    PrefsFile prefs("user.js");
+    prefs.setPref("geo.wifi.scan", false);
+
+    QByteArray legacy("// Written by sailfish-browser on every start, do not edit.\n"
+                      "user_pref(\"geo.wifi.scan\", true);\n");
+    QCOMPARE(prefs.merge(legacy), prefs.toByteArray());
+    QCOMPARE(prefs.merge(QByteArray()), prefs.toByteArray());
+    QCOMPARE(prefs.merge(prefs.toByteArray()), prefs.toByteArray());
+}
+
+QTEST_APPLESS_MAIN(tst_prefsfile)
+#include "tst_prefsfile.moc"
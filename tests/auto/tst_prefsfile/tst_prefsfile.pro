@@ -0,0 +1,6 @@
+TARGET = tst_prefsfile
+include(../test_common.pri)
+
+SOURCES += tst_prefsfile.cpp \
+    ../../../src/prefsfile.cpp
+HEADERS += ../../../src/prefsfile.h
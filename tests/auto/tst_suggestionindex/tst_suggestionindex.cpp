@@ -0,0 +1,239 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QtTest>
+#include "suggestionindex.h"
+
+static const qint64 gNow = 1400000000;
+
+class tst_suggestionindex : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void terms();
+    void prefixMatch();
+    void allWords();
+    void rankSources();
+    void rankVisits();
+    void replaceItems();
+    void updateTitle();
+    void clearHistory();
+    void emptySearch();
+
+    void keystroke_data();
+    void keystroke();
+
+private:
+    QStringList urls(const QList<SuggestionIndex::Suggestion> &suggestions) const;
+    void populate(SuggestionIndex &index, int historyCount, int bookmarkCount, int tabCount) const;
+};
+
+void tst_suggestionindex::terms()
+{
+    QCOMPARE(SuggestionIndex::normalizedUrl("https://www.Example.com/"), QString("example.com"));
+    QCOMPARE(SuggestionIndex::normalizedUrl("example.com/path"), QString("example.com/path"));
+
+    QStringList terms = SuggestionIndex::terms("http://en.wikipedia.org/wiki/Sailfish_OS", "Sailfish OS - Wikipedia");
+    QVERIFY(terms.contains("en.wikipedia.org/wiki/sailfish_os"));
+    QVERIFY(terms.contains("wikipedia"));
+    QVERIFY(terms.contains("sailfish"));
+    QVERIFY(terms.contains("os"));
+    // Single characters are not indexed.
+    QVERIFY(!terms.contains("-"));
+    QCOMPARE(terms.count(terms.first()), 1);
+}
+
+void tst_suggestionindex::prefixMatch()
+{
+    SuggestionIndex index;
+    index.addHistory("http://en.wikipedia.org/wiki/Jolla", "Jolla - Wikipedia", 1, gNow);
+    index.addHistory("http://jolla.com/", "Jolla", 1, gNow);
+    index.addHistory("http://sailfishos.org/", "Sailfish OS", 1, gNow);
+
+    QCOMPARE(urls(index.search("jol", 10, 0, gNow)).count(), 2);
+    QCOMPARE(urls(index.search("wiki", 10, 0, gNow)), QStringList() << "http://en.wikipedia.org/wiki/Jolla");
+    QCOMPARE(urls(index.search("en.wikipedia.org/wi", 10, 0, gNow)), QStringList() << "http://en.wikipedia.org/wiki/Jolla");
+    QCOMPARE(urls(index.search("wikipedia.org", 10, 0, gNow)), QStringList() << "http://en.wikipedia.org/wiki/Jolla");
+    QCOMPARE(urls(index.search("http://www.sailfish", 10, 0, gNow)), QStringList() << "http://sailfishos.org/");
+    QVERIFY(index.search("nokia", 10, 0, gNow).isEmpty());
+
+    // Typed host wins over a title match.
+    QCOMPARE(urls(index.search("jolla", 10, 0, gNow)).first(), QString("http://jolla.com/"));
+}
+
+void tst_suggestionindex::allWords()
+{
+    SuggestionIndex index;
+    index.addHistory("http://example.com/sailfish", "Sailfish browser", 1, gNow);
+    index.addHistory("http://example.com/other", "Other browser", 1, gNow);
+
+    QCOMPARE(urls(index.search("browser sail", 10, 0, gNow)), QStringList() << "http://example.com/sailfish");
+    QCOMPARE(urls(index.search("browser", 10, 0, gNow)).count(), 2);
+}
+
+void tst_suggestionindex::rankSources()
+{
+    SuggestionIndex index;
+    index.addHistory("http://history.example.com/", "Example history", 3, gNow);
+    index.setItems(SuggestionIndex::Bookmark, QList<SuggestionIndex::Item>()
+                   << qMakePair(QString("http://bookmark.example.com/"), QString("Example bookmark")));
+    index.setItems(SuggestionIndex::Tab, QList<SuggestionIndex::Item>()
+                   << qMakePair(QString("http://tab.example.com/"), QString("Example tab")));
+
+    QList<SuggestionIndex::Suggestion> suggestions = index.search("example", 10, 0, gNow);
+    QCOMPARE(urls(suggestions), QStringList() << "http://tab.example.com/"
+             << "http://bookmark.example.com/" << "http://history.example.com/");
+    QCOMPARE(suggestions.at(0).sources, int(SuggestionIndex::Tab));
+
+    // Url in several sources is one suggestion.
+    index.addHistory("http://tab.example.com/", "Example tab", 1, gNow);
+    suggestions = index.search("example", 10, 0, gNow);
+    QCOMPARE(suggestions.count(), 3);
+    QCOMPARE(suggestions.at(0).sources, int(SuggestionIndex::Tab | SuggestionIndex::History));
+
+    QCOMPARE(index.search("example", 2, 0, gNow).count(), 2);
+}
+
+void tst_suggestionindex::rankVisits()
+{
+    SuggestionIndex index;
+    index.addHistory("http://old.example.com/", "Old", 1, gNow - 30 * 24 * 3600);
+    index.addHistory("http://recent.example.com/", "Recent", 1, gNow - 3600);
+    index.addHistory("http://frequent.example.com/", "Frequent", 50, gNow - 30 * 24 * 3600);
+
+    QCOMPARE(urls(index.search("example", 10, 0, gNow)), QStringList() << "http://frequent.example.com/"
+             << "http://recent.example.com/" << "http://old.example.com/");
+}
+
+void tst_suggestionindex::replaceItems()
+{
+    SuggestionIndex index;
+    QList<SuggestionIndex::Item> tabs;
+    tabs << qMakePair(QString("http://one.example.com/"), QString("One"))
+         << qMakePair(QString("http://two.example.com/"), QString("Two"));
+    index.setItems(SuggestionIndex::Tab, tabs);
+    QCOMPARE(index.count(), 2);
+
+    tabs.removeFirst();
+    index.setItems(SuggestionIndex::Tab, tabs);
+    QCOMPARE(index.count(), 1);
+    QCOMPARE(urls(index.search("example", 10, 0, gNow)), QStringList() << "http://two.example.com/");
+
+    // Many replacements do not grow the index without bounds.
+    for (int i = 0; i < 1000; ++i) {
+        tabs.clear();
+        tabs << qMakePair(QString("http://page%1.example.com/").arg(i), QString("Page %1").arg(i));
+        index.setItems(SuggestionIndex::Tab, tabs);
+    }
+    QCOMPARE(index.count(), 1);
+    QVERIFY(index.termCount() < 2000);
+    QCOMPARE(urls(index.search("page", 10, 0, gNow)), QStringList() << "http://page999.example.com/");
+}
+
+void tst_suggestionindex::updateTitle()
+{
+    SuggestionIndex index;
+    index.addHistory("http://example.com/", "Loading", 1, gNow);
+    index.updateTitle("http://example.com/", "Sailfish");
+
+    QCOMPARE(urls(index.search("sailfish", 10, 0, gNow)), QStringList() << "http://example.com/");
+    QVERIFY(index.search("loading", 10, 0, gNow).isEmpty());
+    QCOMPARE(index.search("sailfish", 10, 0, gNow).first().title, QString("Sailfish"));
+}
+
+void tst_suggestionindex::clearHistory()
+{
+    SuggestionIndex index;
+    index.addHistory("http://history.example.com/", "History", 1, gNow);
+    index.setItems(SuggestionIndex::Bookmark, QList<SuggestionIndex::Item>()
+                   << qMakePair(QString("http://bookmark.example.com/"), QString("Bookmark")));
+    index.addHistory("http://bookmark.example.com/", "Bookmark", 1, gNow);
+
+    index.clearHistory();
+    QCOMPARE(index.count(), 1);
+    QList<SuggestionIndex::Suggestion> suggestions = index.search("example", 10, 0, gNow);
+    QCOMPARE(urls(suggestions), QStringList() << "http://bookmark.example.com/");
+    QCOMPARE(suggestions.first().sources, int(SuggestionIndex::Bookmark));
+}
+
+void tst_suggestionindex::emptySearch()
+{
+    SuggestionIndex index;
+    populate(index, 100, 10, 2);
+    QList<SuggestionIndex::Suggestion> suggestions = index.search("", 5, 0, gNow);
+    QCOMPARE(suggestions.count(), 5);
+    QCOMPARE(suggestions.first().sources & SuggestionIndex::Tab, int(SuggestionIndex::Tab));
+}
+
+void tst_suggestionindex::keystroke_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::newRow("1 character") << "s";
+    QTest::newRow("3 characters") << "sai";
+    QTest::newRow("word") << "sailfish";
+    QTest::newRow("url") << "site42.example.com/pa";
+    QTest::newRow("two words") << "page sail";
+    QTest::newRow("no match") << "zzzz";
+}
+
+// Cost of one keystroke with 20000 history entries, 500 bookmarks, and 20 tabs.
+void tst_suggestionindex::keystroke()
+{
+    QFETCH(QString, text);
+
+    SuggestionIndex index;
+    populate(index, 20000, 500, 20);
+    // Sort pending terms outside of the measurement.
+    index.search(QString(), 1);
+
+    QList<SuggestionIndex::Suggestion> suggestions;
+    QBENCHMARK {
+        suggestions = index.search(text, 20, 0, gNow);
+    }
+    QVERIFY(suggestions.count() <= 20);
+}
+
+QStringList tst_suggestionindex::urls(const QList<SuggestionIndex::Suggestion> &suggestions) const
+{
+    QStringList urls;
+    foreach (const SuggestionIndex::Suggestion &suggestion, suggestions) {
+        urls << suggestion.url;
+    }
+    return urls;
+}
+
+void tst_suggestionindex::populate(SuggestionIndex &index, int historyCount, int bookmarkCount, int tabCount) const
+{
+    static const char * const words[] = { "sailfish", "jolla", "browser", "news", "mail", "weather", "maps", "music" };
+    for (int i = 0; i < historyCount; ++i) {
+        index.addHistory(QString("http://site%1.example.com/page/%2").arg(i % 500).arg(i),
+                         QString("Page %1 %2 %3").arg(i).arg(words[i % 8]).arg(words[(i / 8) % 8]),
+                         1 + i % 7, gNow - i * 60);
+    }
+
+    QList<SuggestionIndex::Item> bookmarks;
+    for (int i = 0; i < bookmarkCount; ++i) {
+        bookmarks << qMakePair(QString("http://bookmark%1.example.com/").arg(i),
+                               QString("Bookmark %1 %2").arg(i).arg(words[i % 8]));
+    }
+    index.setItems(SuggestionIndex::Bookmark, bookmarks);
+
+    QList<SuggestionIndex::Item> tabs;
+    for (int i = 0; i < tabCount; ++i) {
+        tabs << qMakePair(QString("http://site%1.example.com/page/%1").arg(i), QString("Tab %1").arg(i));
+    }
+    index.setItems(SuggestionIndex::Tab, tabs);
+}
+
+QTEST_APPLESS_MAIN(tst_suggestionindex)
+
+#include "tst_suggestionindex.moc"
@@ -0,0 +1,4 @@
+TARGET = tst_suggestionindex
+include(../test_common.pri)
+
+SOURCES += tst_suggestionindex.cpp
@@ -0,0 +1,128 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QtTest>
+#include <QImage>
+#include <QQmlContext>
+#include <QQuickItem>
+#include <QQuickView>
+#include <QTemporaryDir>
+
+static bool itemAbove(QQuickItem *a, QQuickItem *b)
+{
+    return a->y() < b->y();
+}
+
+// Repeater delegates are found through the item tree, they have no QObject parent.
+static void findItems(QQuickItem *item, const QString &name, QList<QQuickItem *> &items)
+{
+    foreach (QQuickItem *child, item->childItems()) {
+        if (child->objectName() == name) {
+            items.append(child);
+        }
+        findItems(child, name, items);
+    }
+}
+
+class tst_tabitem : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void offScreenTabsUsePlaceholder();
+    void scrolledTabsLoadThumbnail();
+
+private:
+    QList<QQuickItem *> tabItems() const;
+    QUrl thumbnailSource(QQuickItem *tabItem) const;
+
+    QTemporaryDir *dir;
+    QQuickView *view;
+    QUrl thumbnail;
+    QUrl placeholder;
+};
+
+void tst_tabitem::init()
+{
+    dir = new QTemporaryDir;
+    QVERIFY(dir->isValid());
+    QImage image(64, 64, QImage::Format_RGB32);
+    image.fill(Qt::red);
+    QVERIFY(image.save(dir->path() + "/thumbnail.png"));
+    QVERIFY(image.scaled(4, 4).save(dir->path() + "/placeholder.png"));
+    thumbnail = QUrl::fromLocalFile(dir->path() + "/thumbnail.png");
+    placeholder = QUrl::fromLocalFile(dir->path() + "/placeholder.png");
+
+    view = new QQuickView;
+    view->rootContext()->setContextProperty("thumbnail", thumbnail);
+    view->rootContext()->setContextProperty("placeholder", placeholder);
+    view->setSource(QUrl("qrc:///tst_tabitem.qml"));
+    QCOMPARE(view->status(), QQuickView::Ready);
+    view->show();
+    QVERIFY(QTest::qWaitForWindowExposed(view));
+    QTRY_COMPARE(tabItems().count(), 8);
+}
+
+void tst_tabitem::cleanup()
+{
+    delete view;
+    delete dir;
+}
+
+QList<QQuickItem *> tst_tabitem::tabItems() const
+{
+    QList<QQuickItem *> items;
+    findItems(view->rootObject(), QString("tabItem"), items);
+    qSort(items.begin(), items.end(), itemAbove);
+    return items;
+}
+
+// Source of the full thumbnail image, the placeholder image has a source of its own.
+QUrl tst_tabitem::thumbnailSource(QQuickItem *tabItem) const
+{
+    QUrl source;
+    foreach (QQuickItem *child, tabItem->childItems()) {
+        if (child->inherits("QQuickImage") && child->property("asynchronous").toBool()) {
+            source = child->property("source").toUrl();
+        }
+    }
+    return source;
+}
+
+void tst_tabitem::offScreenTabsUsePlaceholder()
+{
+    QList<QQuickItem *> items = tabItems();
+    for (int i = 0; i < items.count(); ++i) {
+        bool onScreen = i < 2;
+        QCOMPARE(items.at(i)->property("inViewport").toBool(), onScreen);
+        QCOMPARE(items.at(i)->property("_loadThumbnail").toBool(), onScreen);
+        QCOMPARE(thumbnailSource(items.at(i)), onScreen ? thumbnail : QUrl());
+    }
+}
+
+void tst_tabitem::scrolledTabsLoadThumbnail()
+{
+    QList<QQuickItem *> items = tabItems();
+    view->rootObject()->setProperty("contentY", 400);
+
+    // Thumbnails once shown stay loaded.
+    for (int i = 0; i < items.count(); ++i) {
+        bool loaded = i < 4;
+        QCOMPARE(items.at(i)->property("_loadThumbnail").toBool(), loaded);
+        QCOMPARE(thumbnailSource(items.at(i)), loaded ? thumbnail : QUrl());
+    }
+}
+
+QTEST_MAIN(tst_tabitem)
+#include "tst_tabitem.moc"
@@ -0,0 +1,8 @@
+TARGET = tst_tabitem
+include(../test_common.pri)
+
+SOURCES += tst_tabitem.cpp
+
+OTHER_FILES = *.qml
+
+RESOURCES = tst_tabitem.qrc
@@ -0,0 +1,49 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+import QtQuick 2.0
+import Sailfish.Silica 1.0
+
+// Column of tabs in a flickable that shows two of them at a time, laid out like the tab grid of TabPage.
+SilicaFlickable {
+    id: tabView
+
+    width: 400
+    height: 400
+    contentHeight: tabColumn.height
+
+    ListModel {
+        id: tabModel
+        Component.onCompleted: {
+            for (var i = 0; i < 8; ++i) {
+                append({ "title": "Tab " + i, "url": "http://example.com/" + i,
+                         "thumbnailPath": thumbnail, "thumbnailPlaceholder": placeholder })
+            }
+        }
+    }
+
+    Column {
+        id: tabColumn
+
+        width: tabView.width
+
+        Repeater {
+            model: tabModel
+            TabItem {
+                objectName: "tabItem"
+                width: tabColumn.width
+                height: 200
+                flickable: tabView
+                contentTop: model.index * height
+            }
+        }
+    }
+}
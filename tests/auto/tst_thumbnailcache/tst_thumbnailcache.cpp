@@ -0,0 +1,238 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QtTest>
+#include <QImage>
+#include <QLinearGradient>
+#include <QPainter>
+#include <QTemporaryDir>
+#include "thumbnailcache.h"
+
+class tst_thumbnailcache : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_thumbnailcache(QObject *parent = 0);
+
+private slots:
+    void keys();
+    void storeAndReload();
+    void evictLeastRecentlyUsed();
+    void changeEncoder();
+    void remove();
+    void placeholder();
+    void memoryImages();
+
+    void encode_data();
+    void encode();
+
+private:
+    QImage thumbnail(int size) const;
+};
+
+
+tst_thumbnailcache::tst_thumbnailcache(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void tst_thumbnailcache::keys()
+{
+    QCOMPARE(ThumbnailCache::tabKey(3), QString("tab-3-thumb"));
+    QCOMPARE(ThumbnailCache::keyForPath("/home/user/.cache/tab-3-thumb.png"), QString("tab-3-thumb"));
+    QCOMPARE(ThumbnailCache::keyForPath("tab-3-thumb"), QString("tab-3-thumb"));
+    QVERIFY(ThumbnailCache::keyForPath(QString()).isEmpty());
+}
+
+void tst_thumbnailcache::storeAndReload()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    ThumbnailCache cache(dir.path());
+    QString path = cache.store(ThumbnailCache::tabKey(1), thumbnail(270));
+    QVERIFY(QFile::exists(path));
+    QVERIFY(path.endsWith(".jpg"));
+    QCOMPARE(cache.path(ThumbnailCache::tabKey(1)), path);
+    QCOMPARE(cache.path(path), path);
+    QCOMPARE(cache.count(), 1);
+    QCOMPARE(cache.totalSize(), QFileInfo(path).size());
+
+    // New instance builds the index from the directory.
+    ThumbnailCache reloaded(dir.path());
+    QVERIFY(reloaded.contains(ThumbnailCache::tabKey(1)));
+    QCOMPARE(reloaded.path(ThumbnailCache::tabKey(1)), path);
+    QCOMPARE(reloaded.totalSize(), cache.totalSize());
+    QVERIFY(reloaded.path(ThumbnailCache::tabKey(2)).isEmpty());
+}
+
+void tst_thumbnailcache::evictLeastRecentlyUsed()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    ThumbnailCache cache(dir.path());
+    QString first = cache.store(ThumbnailCache::tabKey(1), thumbnail(270));
+    qint64 size = cache.totalSize();
+    QVERIFY(size > 0);
+    cache.setBudget(size * 2 + size / 2);
+
+    cache.store(ThumbnailCache::tabKey(2), thumbnail(270));
+    // Touch the first one so that the second is the least recently used.
+    QCOMPARE(cache.path(ThumbnailCache::tabKey(1)), first);
+    cache.store(ThumbnailCache::tabKey(3), thumbnail(270));
+
+    QCOMPARE(cache.count(), 2);
+    QVERIFY(cache.contains(ThumbnailCache::tabKey(1)));
+    QVERIFY(!cache.contains(ThumbnailCache::tabKey(2)));
+    QVERIFY(cache.contains(ThumbnailCache::tabKey(3)));
+    QVERIFY(cache.totalSize() <= cache.budget());
+    QCOMPARE(QDir(dir.path()).entryList(QDir::Files).count(), 2);
+
+    // Just stored thumbnail is kept even if it alone exceeds the budget.
+    cache.setBudget(1);
+    QCOMPARE(cache.count(), 0);
+    cache.store(ThumbnailCache::tabKey(4), thumbnail(270));
+    QCOMPARE(cache.count(), 1);
+    QVERIFY(cache.contains(ThumbnailCache::tabKey(4)));
+}
+
+void tst_thumbnailcache::changeEncoder()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    ThumbnailCache cache(dir.path());
+    QString jpeg = cache.store(ThumbnailCache::tabKey(1), thumbnail(270));
+    cache.setEncoder(ThumbnailCache::PngEncoder);
+    QString png = cache.store(ThumbnailCache::tabKey(1), thumbnail(270));
+
+    QVERIFY(png.endsWith(".png"));
+    QVERIFY(!QFile::exists(jpeg));
+    QVERIFY(QFile::exists(png));
+    QCOMPARE(cache.count(), 1);
+    QCOMPARE(cache.totalSize(), QFileInfo(png).size());
+}
+
+void tst_thumbnailcache::remove()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    ThumbnailCache cache(dir.path());
+    QString path = cache.store(ThumbnailCache::tabKey(1), thumbnail(270));
+    cache.remove(path);
+    QVERIFY(!QFile::exists(path));
+    QCOMPARE(cache.count(), 0);
+    QCOMPARE(cache.totalSize(), qint64(0));
+}
+
+void tst_thumbnailcache::placeholder()
+{
+    QByteArray data = ThumbnailCache::placeholder(thumbnail(270));
+    QVERIFY(!data.isEmpty());
+    // Small enough to be stored inline to the database.
+    QVERIFY(data.size() < 2048);
+
+    QImage image = QImage::fromData(data);
+    QCOMPARE(image.size(), QSize(32, 32));
+
+    QVERIFY(ThumbnailCache::placeholderUrl(data).startsWith("data:image/jpeg;base64,"));
+    QVERIFY(ThumbnailCache::placeholderUrl(QByteArray()).isEmpty());
+    QVERIFY(ThumbnailCache::placeholder(QImage()).isEmpty());
+}
+
+void tst_thumbnailcache::memoryImages()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    ThumbnailCache cache(dir.path());
+    QVERIFY(cache.imageUrl(1).isEmpty());
+
+    QImage image = thumbnail(270);
+    QCOMPARE(cache.setImage(ThumbnailCache::tabKey(1), image), 1);
+    QCOMPARE(cache.imageUrl(1), QString("image://tabthumb/1/1"));
+    QCOMPARE(cache.image(ThumbnailCache::tabKey(1)), image);
+    // Not written to disk before stored.
+    QCOMPARE(cache.count(), 0);
+
+    QCOMPARE(cache.setImage(ThumbnailCache::tabKey(1), image), 2);
+    QCOMPARE(cache.imageUrl(1), QString("image://tabthumb/1/2"));
+
+    // Only latest images are kept in memory, older ones are decoded from disk.
+    QString path = cache.store(ThumbnailCache::tabKey(1), image);
+    for (int tabId = 2; tabId < 20; ++tabId) {
+        cache.setImage(ThumbnailCache::tabKey(tabId), image);
+    }
+    QImage decoded = cache.image(ThumbnailCache::tabKey(1));
+    QCOMPARE(decoded.size(), image.size());
+    QCOMPARE(decoded, QImage(path));
+
+    cache.remove(ThumbnailCache::tabKey(19));
+    QVERIFY(cache.image(ThumbnailCache::tabKey(19)).isNull());
+}
+
+void tst_thumbnailcache::encode_data()
+{
+    QTest::addColumn<int>("encoder");
+    QTest::addColumn<int>("resolution");
+
+    QTest::newRow("jpeg low") << (int)ThumbnailCache::JpegEncoder << (int)ThumbnailCache::LowResolution;
+    QTest::newRow("jpeg medium") << (int)ThumbnailCache::JpegEncoder << (int)ThumbnailCache::MediumResolution;
+    QTest::newRow("jpeg high") << (int)ThumbnailCache::JpegEncoder << (int)ThumbnailCache::HighResolution;
+    QTest::newRow("png low") << (int)ThumbnailCache::PngEncoder << (int)ThumbnailCache::LowResolution;
+    QTest::newRow("png medium") << (int)ThumbnailCache::PngEncoder << (int)ThumbnailCache::MediumResolution;
+    QTest::newRow("png high") << (int)ThumbnailCache::PngEncoder << (int)ThumbnailCache::HighResolution;
+}
+
+void tst_thumbnailcache::encode()
+{
+    QFETCH(int, encoder);
+    QFETCH(int, resolution);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    ThumbnailCache cache(dir.path());
+    cache.setEncoder((ThumbnailCache::Encoder)encoder);
+    cache.setResolution((ThumbnailCache::Resolution)resolution);
+    QImage image = thumbnail(cache.thumbnailSize(540));
+
+    QString path;
+    QBENCHMARK {
+        path = cache.store(ThumbnailCache::tabKey(1), image);
+    }
+    QVERIFY(!path.isEmpty());
+    qDebug() << QTest::currentDataTag() << image.width() << "px," << QFileInfo(path).size() << "bytes per thumbnail";
+}
+
+// Something that resembles a web page: flat background, gradient header, and text.
+QImage tst_thumbnailcache::thumbnail(int size) const
+{
+    QImage image(size, size, QImage::Format_RGB32);
+    image.fill(Qt::white);
+    QPainter painter(&image);
+    QLinearGradient gradient(0, 0, size, 0);
+    gradient.setColorAt(0, QColor(0x30, 0x60, 0xa0));
+    gradient.setColorAt(1, QColor(0x80, 0xb0, 0xe0));
+    painter.fillRect(0, 0, size, size / 6, gradient);
+    painter.setPen(Qt::darkGray);
+    for (int y = size / 5; y < size; y += 12) {
+        painter.drawText(4, y, size - 8, 12, Qt::AlignLeft, QString("Lorem ipsum dolor sit amet %1").arg(y));
+    }
+    return image;
+}
+
+QTEST_MAIN(tst_thumbnailcache)
+
+#include "tst_thumbnailcache.moc"
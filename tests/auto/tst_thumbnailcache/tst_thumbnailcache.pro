@@ -0,0 +1,4 @@
+TARGET = tst_thumbnailcache
+include(../test_common.pri)
+
+SOURCES += tst_thumbnailcache.cpp
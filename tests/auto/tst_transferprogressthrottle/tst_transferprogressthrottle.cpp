@@ -0,0 +1,203 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QtTest>
+#include "transferprogressthrottle.h"
+
+// Stands in for TransferEngineInterface and records the calls it receives.
+class MockTransferEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    MockTransferEngine() : progressCalls(0), finishCalls(0) {}
+
+    int progressCalls;
+    int finishCalls;
+    QHash<int, qreal> progress;
+    QStringList calls;
+
+public slots:
+    void updateTransferProgress(int transferId, qreal value)
+    {
+        ++progressCalls;
+        progress.insert(transferId, value);
+        calls << QString("progress %1 %2").arg(transferId).arg(value);
+    }
+
+    void finishTransfer(int transferId)
+    {
+        ++finishCalls;
+        calls << QString("finish %1").arg(transferId);
+    }
+};
+
+class tst_transferprogressthrottle : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void coalescesRapidUpdates();
+    void skipsUnchangedProgress();
+    void smallChangeSentAfterInterval();
+    void completeProgressNotDelayed();
+    void batchesTransfers();
+    void finishSendsFinalState();
+    void finishWithoutPending();
+    void downloadProgressCalls();
+
+private:
+    TransferProgressThrottle *throttle;
+    MockTransferEngine *engine;
+};
+
+void tst_transferprogressthrottle::init()
+{
+    throttle = new TransferProgressThrottle;
+    engine = new MockTransferEngine;
+    connect(throttle, SIGNAL(progressChanged(int,qreal)),
+            engine, SLOT(updateTransferProgress(int,qreal)));
+}
+
+void tst_transferprogressthrottle::cleanup()
+{
+    delete throttle;
+    delete engine;
+}
+
+void tst_transferprogressthrottle::coalescesRapidUpdates()
+{
+    for (int i = 0; i < 1000; ++i) {
+        throttle->update(1, i / 10000.0);
+    }
+    // Nothing is sent synchronously.
+    QCOMPARE(engine->progressCalls, 0);
+    QTRY_COMPARE(engine->progressCalls, 1);
+    QCOMPARE(engine->progress.value(1), 999 / 10000.0);
+    QVERIFY(!throttle->hasPending());
+}
+
+void tst_transferprogressthrottle::skipsUnchangedProgress()
+{
+    throttle->update(1, 0.3);
+    QTRY_COMPARE(engine->progressCalls, 1);
+    for (int i = 0; i < 100; ++i) {
+        throttle->update(1, 0.3);
+    }
+    QVERIFY(!throttle->hasPending());
+    QTest::qWait(700);
+    QCOMPARE(engine->progressCalls, 1);
+}
+
+void tst_transferprogressthrottle::smallChangeSentAfterInterval()
+{
+    throttle->update(1, 0.5);
+    QTRY_COMPARE(engine->progressCalls, 1);
+
+    QElapsedTimer timer;
+    timer.start();
+    throttle->update(1, 0.505);
+    QTest::qWait(250);
+    QCOMPARE(engine->progressCalls, 1);
+    QVERIFY(throttle->hasPending());
+
+    QTRY_COMPARE(engine->progressCalls, 2);
+    QVERIFY(timer.elapsed() >= 400);
+    QCOMPARE(engine->progress.value(1), 0.505);
+}
+
+void tst_transferprogressthrottle::completeProgressNotDelayed()
+{
+    throttle->update(1, 0.995);
+    QTRY_COMPARE(engine->progressCalls, 1);
+    throttle->update(1, 1.0);
+    QTest::qWait(250);
+    QCOMPARE(engine->progressCalls, 2);
+    QCOMPARE(engine->progress.value(1), 1.0);
+}
+
+void tst_transferprogressthrottle::batchesTransfers()
+{
+    for (int step = 1; step <= 50; ++step) {
+        for (int transferId = 1; transferId <= 10; ++transferId) {
+            throttle->update(transferId, step / 1000.0);
+        }
+    }
+    QCOMPARE(engine->progressCalls, 0);
+    QTRY_COMPARE(engine->progressCalls, 10);
+    for (int transferId = 1; transferId <= 10; ++transferId) {
+        QCOMPARE(engine->progress.value(transferId), 0.05);
+    }
+}
+
+void tst_transferprogressthrottle::finishSendsFinalState()
+{
+    throttle->update(1, 0.5);
+    QTRY_COMPARE(engine->progressCalls, 1);
+    throttle->update(1, 0.503);
+    QVERIFY(throttle->hasPending());
+
+    // DownloadManager finishes the throttle before the transfer engine.
+    throttle->finish(1);
+    engine->finishTransfer(1);
+
+    QCOMPARE(engine->calls, QStringList() << "progress 1 0.5" << "progress 1 0.503" << "finish 1");
+    QVERIFY(!throttle->hasPending());
+    QTest::qWait(700);
+    QCOMPARE(engine->progressCalls, 2);
+}
+
+void tst_transferprogressthrottle::finishWithoutPending()
+{
+    throttle->update(1, 0.5);
+    QTRY_COMPARE(engine->progressCalls, 1);
+    throttle->finish(1);
+    throttle->finish(2);
+    QCOMPARE(engine->progressCalls, 1);
+
+    // Finished transfer starts from scratch when it is restarted.
+    throttle->update(1, 0.5);
+    QTRY_COMPARE(engine->progressCalls, 2);
+}
+
+void tst_transferprogressthrottle::downloadProgressCalls()
+{
+    // Gecko reports integer percents, several messages per percent, for
+    // three downloads over a bit more than a second.
+    QElapsedTimer timer;
+    timer.start();
+    int messages = 0;
+    for (int percent = 0; percent <= 100; ++percent) {
+        for (int repeat = 0; repeat < 5; ++repeat) {
+            for (int transferId = 1; transferId <= 3; ++transferId) {
+                throttle->update(transferId, percent / 100.0);
+                ++messages;
+            }
+        }
+        QTest::qWait(10);
+    }
+    for (int transferId = 1; transferId <= 3; ++transferId) {
+        throttle->finish(transferId);
+        QCOMPARE(engine->progress.value(transferId), 1.0);
+    }
+
+    // At most one update per transfer per flush interval.
+    int maxCalls = 3 * (timer.elapsed() / 100 + 2);
+    QVERIFY2(engine->progressCalls <= maxCalls,
+             qPrintable(QString("%1 calls for %2 messages").arg(engine->progressCalls).arg(messages)));
+    QVERIFY(engine->progressCalls < messages / 10);
+}
+
+QTEST_GUILESS_MAIN(tst_transferprogressthrottle)
+#include "tst_transferprogressthrottle.moc"
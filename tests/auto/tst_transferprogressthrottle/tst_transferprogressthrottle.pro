@@ -0,0 +1,6 @@
+TARGET = tst_transferprogressthrottle
+include(../test_common.pri)
+
+SOURCES += tst_transferprogressthrottle.cpp \
+    ../../../src/transferprogressthrottle.cpp
+HEADERS += ../../../src/transferprogressthrottle.h
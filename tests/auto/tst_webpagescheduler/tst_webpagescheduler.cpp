@@ -0,0 +1,165 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QtTest>
+#include <QTemporaryDir>
+#include "webpagescheduler.h"
+
+static const int gSuspendTimeout = 800;
+static const int gVirtualizeTimeout = 3200;
+
+class tst_webpagescheduler : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void stages_data();
+    void stages();
+    void activateStopsIdling();
+    void keptAlive();
+    void handBack();
+
+private:
+    void setLoadAverage(const QByteArray &loadAverage);
+
+    QTemporaryDir *dir;
+    WebPageScheduler *scheduler;
+};
+
+void tst_webpagescheduler::init()
+{
+    dir = new QTemporaryDir;
+    QVERIFY(dir->isValid());
+    scheduler = new WebPageScheduler;
+    scheduler->setTimeouts(gSuspendTimeout, gVirtualizeTimeout);
+    scheduler->setLoadAverageFile(dir->path() + "/loadavg");
+    setLoadAverage("0.00 0.00 0.00 1/100 1000");
+}
+
+void tst_webpagescheduler::cleanup()
+{
+    delete scheduler;
+    delete dir;
+}
+
+void tst_webpagescheduler::setLoadAverage(const QByteArray &loadAverage)
+{
+    QFile file(dir->path() + "/loadavg");
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write(loadAverage + "\n");
+}
+
+void tst_webpagescheduler::stages_data()
+{
+    QTest::addColumn<bool>("batteryPowered");
+    QTest::addColumn<bool>("background");
+    QTest::addColumn<bool>("highLoad");
+    QTest::addColumn<int>("divisor");
+
+    QTest::newRow("foreground") << false << false << false << 1;
+    QTest::newRow("battery") << true << false << false << 4;
+    QTest::newRow("background") << false << true << false << 4;
+    QTest::newRow("high load") << false << false << true << 4;
+    QTest::newRow("battery in background") << true << true << false << 16;
+    QTest::newRow("battery under high load") << true << false << true << 16;
+}
+
+void tst_webpagescheduler::stages()
+{
+    QFETCH(bool, batteryPowered);
+    QFETCH(bool, background);
+    QFETCH(bool, highLoad);
+    QFETCH(int, divisor);
+
+    if (highLoad) {
+        setLoadAverage("100000.00 0.00 0.00 1/100 1000");
+    }
+    scheduler->setBatteryPowered(batteryPowered);
+    scheduler->setBackground(background);
+
+    QSignalSpy suspendSpy(scheduler, SIGNAL(suspendRequested(int)));
+    QSignalSpy virtualizeSpy(scheduler, SIGNAL(virtualizeRequested(int)));
+    QElapsedTimer idle;
+    idle.start();
+    scheduler->deactivate(1);
+    QCOMPARE(scheduler->stage(1), WebPageScheduler::Throttled);
+
+    QVERIFY(suspendSpy.wait(2 * gSuspendTimeout));
+    qint64 suspendedAt = idle.elapsed();
+    QVERIFY(suspendedAt >= gSuspendTimeout / divisor);
+    QVERIFY(suspendedAt < 2 * gSuspendTimeout / divisor);
+    QCOMPARE(suspendSpy.first().at(0).toInt(), 1);
+    QCOMPARE(scheduler->stage(1), WebPageScheduler::Suspended);
+    QVERIFY(virtualizeSpy.isEmpty());
+
+    QVERIFY(virtualizeSpy.wait(2 * gVirtualizeTimeout));
+    qint64 virtualizedAt = idle.elapsed();
+    QVERIFY(virtualizedAt >= gVirtualizeTimeout / divisor);
+    QVERIFY(virtualizedAt < 2 * gVirtualizeTimeout / divisor);
+    QCOMPARE(virtualizeSpy.first().at(0).toInt(), 1);
+    QCOMPARE(suspendSpy.count(), 1);
+
+    // Virtualized page is no longer scheduled.
+    QCOMPARE(scheduler->stage(1), WebPageScheduler::Active);
+}
+
+void tst_webpagescheduler::activateStopsIdling()
+{
+    QSignalSpy suspendSpy(scheduler, SIGNAL(suspendRequested(int)));
+    scheduler->deactivate(1);
+    scheduler->activate(1);
+    QCOMPARE(scheduler->stage(1), WebPageScheduler::Active);
+    QTest::qWait(2 * gSuspendTimeout);
+    QVERIFY(suspendSpy.isEmpty());
+}
+
+void tst_webpagescheduler::keptAlive()
+{
+    QSignalSpy suspendSpy(scheduler, SIGNAL(suspendRequested(int)));
+    scheduler->deactivate(1);
+    scheduler->deactivate(2);
+    scheduler->setKeptAlive(1);
+
+    QVERIFY(suspendSpy.wait(2 * gSuspendTimeout));
+    QCOMPARE(suspendSpy.count(), 1);
+    QCOMPARE(suspendSpy.first().at(0).toInt(), 2);
+    QCOMPARE(scheduler->stage(1), WebPageScheduler::Throttled);
+
+    // Page that has idled long enough is suspended once it is no longer kept alive.
+    scheduler->setKeptAlive(0);
+    QVERIFY(suspendSpy.wait(100));
+    QCOMPARE(suspendSpy.last().at(0).toInt(), 1);
+    QCOMPARE(scheduler->stage(1), WebPageScheduler::Suspended);
+}
+
+void tst_webpagescheduler::handBack()
+{
+    QSignalSpy virtualizeSpy(scheduler, SIGNAL(virtualizeRequested(int)));
+    scheduler->deactivate(1);
+    QVERIFY(virtualizeSpy.wait(2 * gVirtualizeTimeout));
+
+    // Refused virtualization is requested again after a suspend timeout.
+    QElapsedTimer idle;
+    idle.start();
+    scheduler->add(1);
+    QCOMPARE(scheduler->stage(1), WebPageScheduler::Suspended);
+    QVERIFY(virtualizeSpy.wait(2 * gSuspendTimeout));
+    QVERIFY(idle.elapsed() >= gSuspendTimeout);
+    QCOMPARE(virtualizeSpy.count(), 2);
+    QCOMPARE(virtualizeSpy.last().at(0).toInt(), 1);
+    QCOMPARE(scheduler->stage(1), WebPageScheduler::Active);
+}
+
+QTEST_GUILESS_MAIN(tst_webpagescheduler)
+#include "tst_webpagescheduler.moc"
@@ -0,0 +1,6 @@
+TARGET = tst_webpagescheduler
+include(../test_common.pri)
+
+SOURCES += tst_webpagescheduler.cpp \
+    ../../../src/webpagescheduler.cpp
+HEADERS += ../../../src/webpagescheduler.h
@@ -38,6 +38,7 @@ private slots:
     void testLiveTabCount_data();
     void testLiveTabCount();
     void forwardBackwardNavigation();
+    void contentHash();
     void cleanupTestCase();
 
 private:
@@ -526,6 +527,27 @@ void tst_webview::forwardBackwardNavigation()
     QVERIFY(webContainer->canGoForward());
 }
 
+void tst_webview::contentHash()
+{
+    QImage page(540, 540, QImage::Format_RGB32);
+    page.fill(Qt::white);
+    QTransform transform = QTransform::fromScale(0.5, 0.5);
+    uint hash = DeclarativeWebContainer::contentHash(page, transform);
+
+    // Single pixel change is not visible in the thumbnail.
+    QImage pixelChanged = page.copy();
+    pixelChanged.setPixel(100, 100, qRgb(0, 0, 0));
+    QCOMPARE(DeclarativeWebContainer::contentHash(pixelChanged, transform), hash);
+
+    QImage contentChanged = page.copy();
+    contentChanged.fill(Qt::black);
+    QVERIFY(DeclarativeWebContainer::contentHash(contentChanged, transform) != hash);
+
+    QTransform rotated = transform;
+    rotated.rotate(90);
+    QVERIFY(DeclarativeWebContainer::contentHash(page, rotated) != hash);
+}
+
 void tst_webview::cleanupTestCase()
 {
     QTest::qWait(1000);
@@ -0,0 +1,78 @@
+#!/bin/bash
+#
+# Measures how long it takes from an openUrl D-Bus call to the first frame of
+# the browser window. Cold starts go through D-Bus activation, warm starts
+# send openUrl to a browser that was launched with -prestart. Cold starts are
+# timed from main() as the process start itself is not traced.
+#
+# Usage: startupBenchmark.sh [url] [runs]
+
+URL=${1:-"about:blank"}
+RUNS=${2:-5}
+SERVICE="org.sailfishos.browser"
+TRACE="/tmp/sailfish-browser-trace.json"
+# Time given to a prestarted browser to finish its initialization.
+PRESTART_SETTLE=10
+
+has_owner() {
+  dbus-send --session --print-reply --dest=org.freedesktop.DBus /org/freedesktop/DBus \
+    org.freedesktop.DBus.NameHasOwner string:$SERVICE | grep -q "boolean true"
+}
+
+stop_browser() {
+  killall sailfish-browser 2> /dev/null
+  while has_owner; do
+    sleep 0.1
+  done
+}
+
+open_url() {
+  dbus-send --session --type=method_call --dest=$SERVICE / $SERVICE.openUrl array:string:"$URL"
+}
+
+# Prints the timestamp of the named event in microseconds.
+event_time() {
+  grep "\"name\":\"$1\"" $TRACE | head -n 1 | sed 's/.*"ts":\([0-9]*\).*/\1/'
+}
+
+wait_for_trace() {
+  for i in `seq 300`; do
+    if [ -s $TRACE ]; then
+      return 0
+    fi
+    sleep 0.1
+  done
+  echo "No trace written to $TRACE" >&2
+  return 1
+}
+
+# The activated browser inherits its environment from the session bus.
+dbus-send --session --print-reply --dest=org.freedesktop.DBus /org/freedesktop/DBus \
+  org.freedesktop.DBus.UpdateActivationEnvironment dict:string:string:"BROWSER_TRACE","$TRACE" > /dev/null
+export BROWSER_TRACE=$TRACE
+
+echo "Opening $URL, $RUNS runs"
+for run in `seq $RUNS`; do
+  stop_browser
+  rm -f $TRACE
+  open_url
+  wait_for_trace || exit 1
+  cold=$(( $(event_time firstFrame) / 1000 ))
+
+  stop_browser
+  rm -f $TRACE
+  /usr/bin/invoker --type=qt5 -G /usr/bin/sailfish-browser -prestart &
+  until has_owner; do
+    sleep 0.1
+  done
+  sleep $PRESTART_SETTLE
+  open_url
+  wait_for_trace || exit 1
+  warm=$(( ($(event_time firstFrame) - $(event_time openUrl)) / 1000 ))
+
+  echo "run $run: cold ${cold} ms, prestarted ${warm} ms"
+done
+
+stop_browser
+dbus-send --session --print-reply --dest=org.freedesktop.DBus /org/freedesktop/DBus \
+  org.freedesktop.DBus.UpdateActivationEnvironment dict:string:string:"BROWSER_TRACE","" > /dev/null